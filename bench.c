@@ -0,0 +1,273 @@
+#include "common.h"
+#include "migawka.h"
+
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <stddef.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+/*
+ * ====================
+ * BENCHMARK UKŁADU SHM
+ * ====================
+ * Mierzy koszt przejścia przez bramkę przy równoległej pracy innych ról,
+ * w dwóch układach tych samych pól:
+ *  - "zwarty": tablice per pole obok siebie (bramki[8][2], wejscia_kontrola[8][2],
+ *    obecni_w_sektorze[9], agresor_sektora[8], zegar i kasy w tych samych liniach) –
+ *    tak wyglądał SharedState przed podziałem na grupy,
+ *  - "SharedState": aktualny układ z common.h (StanSektora per sektor, grupy w osobnych liniach),
+ *  - "z wersjami": to samo, ale zapisy otoczone seqlockiem sektora (Wersja) jak w kibic_zycie.c,
+ *    a obok proces "monitor" co 1 ms pobiera migawkę (migawka.h) – koszt migawek dla piszących
+ *    i ile podejść potrzebuje czytelnik.
+ *
+ * Procesy (fork, pamięć mmap MAP_SHARED – nie rusza IPC symulacji):
+ *  - po jednym "sektorze" na sektor: pętla przejść jak w kibic_zycie.c
+ *    (sprawdź ewakuację i agresora, zajmij bramkę, policz wejście, obecni++/--, zwolnij bramkę),
+ *  - "zegar": ciągle zapisuje czas_pozostaly (kierownik),
+ *  - "kasjer": czyta aktywne_kasy i podbija sprzedane_bilety.
+ * Bez semaforów: każdy sektor ma jednego piszącego, więc mierzymy tylko ruch linii cache.
+ *
+ * Licznik: perf_event_open(PERF_COUNT_HW_CACHE_MISSES) w każdym procesie-sektorze;
+ * gdy sprzętowe liczniki są niedostępne (np. maszyna wirtualna), zostaje sam czas.
+ * Fałszywe współdzielenie widać tylko przy kilku rdzeniach – na 1 CPU oba układy wyjdą podobnie.
+ *
+ * Użycie: ./bench [przejscia_na_sektor [sektory]]
+ */
+
+#define PRZEJSCIA_DOMYSLNIE 2000000
+
+typedef struct {
+    int aktywne_kasy[LICZBA_KAS];
+    int sprzedane_bilety[LICZBA_SEKTOROW + 1];
+    Stanowisko bramki[LICZBA_SEKTOROW][2];
+    int wejscia_kontrola[LICZBA_SEKTOROW][2];
+    int obecni_w_sektorze[LICZBA_SEKTOROW + 1];
+    int blokada_sektora[LICZBA_SEKTOROW];
+    int agresor_sektora[LICZBA_SEKTOROW];
+    int ewakuacja_trwa;
+    int status_meczu;
+    int czas_pozostaly;
+} UkladZwarty;
+
+// Wskaźniki na pola jednego sektora i ról pobocznych – ta sama pętla dla obu układów
+typedef struct {
+    int *ewakuacja_trwa;
+    int *czas_pozostaly;
+    int *aktywne_kasy;
+    int *sprzedane_bilety;
+    Stanowisko *bramki[LICZBA_SEKTOROW];
+    int *wejscia_kontrola[LICZBA_SEKTOROW];
+    int *agresor[LICZBA_SEKTOROW];
+    int *obecni[LICZBA_SEKTOROW];
+    Wersja *wersja[LICZBA_SEKTOROW]; // NULL: zapisy bez seqlocka
+    SharedState *stan;               // dla procesu "monitor" (tylko z wersjami)
+} Pola;
+
+typedef struct {
+    int start;
+    int koniec;
+    int gotowi;
+    long long chybienia[LICZBA_SEKTOROW];
+    long long ns[LICZBA_SEKTOROW];
+    long long migawki;
+    long long podejscia;
+    long long nieudane;
+} Wyniki;
+
+static int otworz_licznik(void) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = PERF_TYPE_HARDWARE;
+    a.config = PERF_COUNT_HW_CACHE_MISSES;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    // pid=0, cpu=-1: ten proces na dowolnym CPU
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+}
+
+static void czekaj_na_start(Wyniki *w) {
+    __atomic_add_fetch(&w->gotowi, 1, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&w->start, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void petla_sektora(const Pola *p, Wyniki *w, int s, long przejscia) {
+    volatile Stanowisko *b = p->bramki[s];
+    volatile int *wejscia = p->wejscia_kontrola[s];
+    volatile int *agresor = p->agresor[s];
+    Wersja *v = p->wersja[s];
+    int fd = otworz_licznik();
+
+    czekaj_na_start(w);
+    if (fd != -1) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    long long t0 = czas_ns();
+    for (long i = 0; i < przejscia; i++) {
+        int druzyna = (int)(i & 1);
+        if (__atomic_load_n(p->ewakuacja_trwa, __ATOMIC_RELAXED)) break;
+        if (*agresor != 0) continue;
+        // Z wersjami: każda zmiana jak w kibic_zycie.c (wejście, obecni++, wyjście, obecni--)
+        if (v) wersja_zapis_start(v);
+        b[druzyna].zajetosc++;
+        b[druzyna].druzyna = druzyna;
+        if (v) wersja_zapis_koniec(v);
+        wejscia[druzyna]++;
+        if (v) wersja_zapis_start(v);
+        __atomic_add_fetch(p->obecni[s], 1, __ATOMIC_RELEASE);
+        if (v) wersja_zapis_koniec(v);
+        if (v) wersja_zapis_start(v);
+        b[druzyna].zajetosc--;
+        if (v) wersja_zapis_koniec(v);
+        if (v) wersja_zapis_start(v);
+        __atomic_sub_fetch(p->obecni[s], 1, __ATOMIC_RELEASE);
+        if (v) wersja_zapis_koniec(v);
+    }
+    w->ns[s] = czas_ns() - t0;
+    w->chybienia[s] = -1;
+    if (fd != -1) {
+        long long v;
+        if (read(fd, &v, sizeof(v)) == (ssize_t)sizeof(v)) w->chybienia[s] = v;
+        close(fd);
+    }
+    _exit(0);
+}
+
+static void petla_zegara(const Pola *p, Wyniki *w) {
+    czekaj_na_start(w);
+    for (int t = 0; !__atomic_load_n(&w->koniec, __ATOMIC_ACQUIRE); t++) {
+        __atomic_store_n(p->czas_pozostaly, t, __ATOMIC_RELAXED);
+    }
+    _exit(0);
+}
+
+static void petla_kasjera(const Pola *p, Wyniki *w) {
+    czekaj_na_start(w);
+    for (int i = 0; !__atomic_load_n(&w->koniec, __ATOMIC_ACQUIRE); i++) {
+        int k = i % LICZBA_KAS;
+        if (__atomic_load_n(&p->aktywne_kasy[k], __ATOMIC_RELAXED)) {
+            __atomic_store_n(&p->sprzedane_bilety[k % (LICZBA_SEKTOROW + 1)], i, __ATOMIC_RELAXED);
+        }
+    }
+    _exit(0);
+}
+
+// Czytelnik jak monitor, tylko częściej: migawka co 1 ms, liczymy podejścia
+static void petla_monitora(const Pola *p, Wyniki *w) {
+    Migawka m;
+    czekaj_na_start(w);
+    while (!__atomic_load_n(&w->koniec, __ATOMIC_ACQUIRE)) {
+        int proba = migawka_pobierz(p->stan, &m, 1000);
+        w->migawki++;
+        w->podejscia += proba ? proba : 1000;
+        if (!proba) w->nieudane++;
+        usleep(1000);
+    }
+    _exit(0);
+}
+
+static pid_t uruchom(void (*f)(const Pola *, Wyniki *), const Pola *p, Wyniki *w) {
+    pid_t pid = fork();
+    if (pid == -1) die_errno("fork");
+    if (pid == 0) f(p, w);
+    return pid;
+}
+
+static void przebieg(const char *nazwa, const Pola *p, Wyniki *w, int sektory, long przejscia) {
+    memset(w, 0, sizeof(*w));
+    pid_t zegar = uruchom(petla_zegara, p, w);
+    pid_t kasjer = uruchom(petla_kasjera, p, w);
+    pid_t monitor = p->stan ? uruchom(petla_monitora, p, w) : -1;
+    int poboczne = p->stan ? 3 : 2;
+    for (int s = 0; s < sektory; s++) {
+        pid_t pid = fork();
+        if (pid == -1) die_errno("fork");
+        if (pid == 0) petla_sektora(p, w, s, przejscia);
+    }
+
+    while (__atomic_load_n(&w->gotowi, __ATOMIC_ACQUIRE) < sektory + poboczne) usleep(1000);
+    __atomic_store_n(&w->start, 1, __ATOMIC_RELEASE);
+
+    // Najpierw sektory (wszystkie poza zegarem, kasjerem i monitorem), potem zatrzymujemy role poboczne
+    for (int n = 0; n < sektory;) {
+        pid_t pid = wait(NULL);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            die_errno("wait");
+        }
+        if (pid != zegar && pid != kasjer && pid != monitor) n++;
+    }
+    __atomic_store_n(&w->koniec, 1, __ATOMIC_RELEASE);
+    while (wait(NULL) > 0) {}
+
+    long long chyb = 0, ns = 0;
+    int licznik = 1;
+    for (int s = 0; s < sektory; s++) {
+        if (w->chybienia[s] < 0) licznik = 0;
+        chyb += w->chybienia[s];
+        ns += w->ns[s];
+    }
+    double n = (double)sektory * (double)przejscia;
+    if (licznik) {
+        printf("%-12s %10.3f chybień cache/przejście | %8.1f ns/przejście\n", nazwa, chyb / n, ns / n);
+    } else {
+        printf("%-12s %10s chybień cache/przejście | %8.1f ns/przejście\n", nazwa, "n/d", ns / n);
+    }
+    if (p->stan && w->migawki > 0) {
+        printf("%-12s migawki: %lld | śr. podejść: %.2f | nieudane: %lld\n", "", w->migawki,
+               (double)w->podejscia / (double)w->migawki, w->nieudane);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    setbuf(stdout, NULL);
+
+    long przejscia = (argc > 1) ? atol(argv[1]) : PRZEJSCIA_DOMYSLNIE;
+    int sektory = (argc > 2) ? atoi(argv[2]) : LICZBA_SEKTOROW;
+    if (argc > 3 || przejscia < 1 || sektory < 1 || sektory > LICZBA_SEKTOROW) {
+        fprintf(stderr, "Użycie: %s [przejscia_na_sektor [sektory 1..%d]]\n", argv[0], LICZBA_SEKTOROW);
+        exit(1);
+    }
+
+    size_t rozmiar = sizeof(UkladZwarty) + sizeof(SharedState) + sizeof(Wyniki) + 2 * LINIA_CACHE;
+    char *pam = mmap(NULL, rozmiar, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pam == MAP_FAILED) die_errno("mmap");
+    // mmap zwraca adres wyrównany do strony, więc SharedState zachowuje swoje wyrównanie
+    SharedState *stan = (SharedState *)pam;
+    UkladZwarty *zw = (UkladZwarty *)(pam + sizeof(SharedState));
+    Wyniki *w = (Wyniki *)(pam + sizeof(SharedState) + sizeof(UkladZwarty) + LINIA_CACHE);
+
+    Pola pz = {&zw->ewakuacja_trwa, &zw->czas_pozostaly, zw->aktywne_kasy, zw->sprzedane_bilety,
+               {0}, {0}, {0}, {0}, {0}, NULL};
+    Pola ps = {&stan->ewakuacja_trwa, &stan->czas_pozostaly, stan->aktywne_kasy, stan->sprzedane_bilety,
+               {0}, {0}, {0}, {0}, {0}, NULL};
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) {
+        pz.bramki[s] = zw->bramki[s];
+        pz.wejscia_kontrola[s] = zw->wejscia_kontrola[s];
+        pz.agresor[s] = &zw->agresor_sektora[s];
+        pz.obecni[s] = &zw->obecni_w_sektorze[s];
+        ps.bramki[s] = stan->sektory[s].bramki;
+        ps.wejscia_kontrola[s] = stan->sektory[s].wejscia_kontrola;
+        ps.agresor[s] = &stan->sektory[s].agresor;
+        ps.obecni[s] = &stan->sektory[s].obecni;
+    }
+    for (int i = 0; i < LICZBA_KAS; i++) zw->aktywne_kasy[i] = stan->aktywne_kasy[i] = 1;
+
+    printf("[BENCH] sektory: %d | przejść na sektor: %ld | CPU: %ld | sizeof(SharedState): %zu B\n",
+           sektory, przejscia, sysconf(_SC_NPROCESSORS_ONLN), sizeof(SharedState));
+    printf("[BENCH] SharedState: sektory[] od %zu B, %zu B na sektor | czas_pozostaly @%zu, aktywne_kasy @%zu\n",
+           offsetof(SharedState, sektory), sizeof(StanSektora), offsetof(SharedState, czas_pozostaly),
+           offsetof(SharedState, aktywne_kasy));
+
+    przebieg("zwarty", &pz, w, sektory, przejscia);
+    przebieg("SharedState", &ps, w, sektory, przejscia);
+
+    Pola pw = ps;
+    pw.stan = stan;
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) pw.wersja[s] = &stan->sektory[s].wersja;
+    przebieg("z wersjami", &pw, w, sektory, przejscia);
+
+    if (munmap(pam, rozmiar) == -1) warn_errno("munmap");
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "common.h"
+#include "transport.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/*
+ * ==========================
+ * BENCHMARK TRANSPORTU KAS
+ * ==========================
+ * Ten sam ruch kibic -> kasa -> kibic na każdym backendzie z transport.h:
+ *  - "kibice": każdy wysyła żądanie (transport_wyslij_zadanie + kasy_zadzwon), czeka na bilet
+ *    (transport_odbierz_bilet) i mierzy pełny obieg; co PROPORCJA_VIP-te żądanie to VIP,
+ *  - "kasjer": pętla jak w kasjer.c – odczyt dzwonka, zdejmowanie żądań, bilet w odpowiedzi,
+ *    a przy pustych kolejkach sen w kasy_czekaj().
+ *
+ * SharedState w mmap MAP_SHARED (kolejki shm, skrzynki, dzwonek) – nie rusza pamięci symulacji.
+ * Kolejki sysv i posix zakładamy na wyłączność (IPC_EXCL / O_EXCL) pod kluczami i nazwami symulacji,
+ * więc przy działającej hali (albo po awarii bez ./clean) dany backend jest pomijany.
+ * Obieg = czas od wysłania żądania do odbioru biletu; "odpowiedz" = LAT_ODPOWIEDZ (sama droga biletu).
+ *
+ * Użycie: ./bench_transport [zadania_na_kibica [kibice]]
+ */
+
+#define ZADANIA_DOMYSLNIE 20000
+#define KIBICE_DOMYSLNIE 4
+#define PROPORCJA_VIP 8
+
+typedef struct {
+    int start;
+    int koniec;
+    int gotowi;
+    long long obsluzone;
+    Histogram obieg;
+} Wyniki;
+
+static void czekaj_na_start(Wyniki *w) {
+    __atomic_add_fetch(&w->gotowi, 1, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&w->start, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void petla_kasjera(SharedState *stan, Wyniki *w) {
+    Transport t;
+    if (transport_podlacz(&t, stan) == -1) die_errno("transport_podlacz(kasjer)");
+    czekaj_na_start(w);
+
+    long long obsluzone = 0;
+    while (1) {
+        // Dzwonek przed kolejkami – żądanie wstawione później nie da nam zasnąć (jak w kasjer.c)
+        unsigned int dzwonek = __atomic_load_n(&stan->dzwonek_kas, __ATOMIC_SEQ_CST);
+        int kibic_id, grupa, vip;
+        if (transport_odbierz_zadanie(&t, 0, &kibic_id, &grupa, &vip, NULL)) {
+            transport_odpowiedz(&t, kibic_id, vip);
+            obsluzone++;
+            continue;
+        }
+        if (__atomic_load_n(&w->koniec, __ATOMIC_ACQUIRE)) break;
+        kasy_czekaj(stan, dzwonek);
+    }
+    __atomic_add_fetch(&w->obsluzone, obsluzone, __ATOMIC_RELAXED);
+    transport_odlacz(&t);
+    _exit(0);
+}
+
+static void petla_kibica(SharedState *stan, Wyniki *w, int id, long zadania) {
+    Transport t;
+    if (transport_podlacz(&t, stan) == -1) die_errno("transport_podlacz(kibic)");
+    czekaj_na_start(w);
+
+    for (long i = 0; i < zadania; i++) {
+        int vip = (i % PROPORCJA_VIP) == 0;
+        // Skrzynka należy tylko do nas – zerujemy ją przed kolejnym żądaniem
+        __atomic_store_n(&stan->skrzynki[id].stan, SKRZYNKA_PUSTA, __ATOMIC_RELEASE);
+        long long t0 = czas_ns();
+        int r;
+        while ((r = transport_wyslij_zadanie(&t, id, 1, vip)) == 0) usleep(100);
+        if (r == -1) die_errno("transport_wyslij_zadanie");
+        kasy_zadzwon(stan);
+        if (transport_odbierz_bilet(&t, id) != vip) {
+            fprintf(stderr, "[BENCH] kibic %d: zły bilet\n", id);
+            _exit(1);
+        }
+        hist_dodaj(&w->obieg, czas_ns() - t0); // __atomic – wspólny histogram bez blokady
+    }
+
+    transport_odlacz(&t);
+    _exit(0);
+}
+
+static void przebieg(int rodzaj, SharedState *stan, Wyniki *w, int kibice, long zadania) {
+    if (rodzaj == TRANSPORT_SYSV && transport_utworz_sysv(1) == -1) {
+        warn_errno("transport_utworz_sysv");
+        printf("%-6s pominięty (kolejki już istnieją? najpierw ./clean)\n", transport_nazwa(rodzaj));
+        return;
+    }
+    if (rodzaj == TRANSPORT_POSIX) {
+        long pojemnosc = transport_utworz_posix(1);
+        if (pojemnosc == -1) {
+            warn_errno("transport_utworz_posix");
+            printf("%-6s pominięty (kolejki już istnieją? najpierw ./clean)\n", transport_nazwa(rodzaj));
+            return;
+        }
+        printf("%-6s kolejka żądań: %ld komunikatów\n", transport_nazwa(rodzaj), pojemnosc);
+    }
+
+    memset(w, 0, sizeof(*w));
+    memset(stan, 0, sizeof(*stan));
+    ring_init(&stan->kolejka_vip);
+    ring_init(&stan->kolejka_zwykla);
+    for (int c = 0; c < CELE_STEROWANIA; c++) kanal_init(&stan->kanaly[c]);
+    stan->transport = rodzaj;
+
+    pid_t kasjer = fork();
+    if (kasjer == -1) die_errno("fork");
+    if (kasjer == 0) petla_kasjera(stan, w);
+    for (int k = 0; k < kibice; k++) {
+        pid_t pid = fork();
+        if (pid == -1) die_errno("fork");
+        if (pid == 0) petla_kibica(stan, w, k, zadania);
+    }
+
+    while (__atomic_load_n(&w->gotowi, __ATOMIC_ACQUIRE) < kibice + 1) usleep(1000);
+    long long t0 = czas_ns();
+    __atomic_store_n(&w->start, 1, __ATOMIC_RELEASE);
+
+    int bledy = 0;
+    for (int n = 0; n < kibice;) {
+        int status;
+        pid_t pid = wait(&status);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            die_errno("wait");
+        }
+        if (pid == kasjer) continue;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) bledy++;
+        n++;
+    }
+    long long ns = czas_ns() - t0;
+    __atomic_store_n(&w->koniec, 1, __ATOMIC_RELEASE);
+    kasy_obudz(stan);
+    while (wait(NULL) > 0) {}
+
+    printf("%-6s %lld żądań w %.3f s | %.0f żądań/s%s\n", transport_nazwa(rodzaj), w->obsluzone, ns / 1e9,
+           w->obsluzone / (ns / 1e9), bledy ? " | BŁĘDY kibiców" : "");
+    hist_wypisz(stdout, "obieg", &w->obieg);
+    hist_wypisz(stdout, "odpowiedz", &stan->lat[LAT_ODPOWIEDZ]);
+
+    if (rodzaj != TRANSPORT_SHM) transport_usun();
+}
+
+int main(int argc, char *argv[]) {
+    setbuf(stdout, NULL);
+
+    long zadania = (argc > 1) ? atol(argv[1]) : ZADANIA_DOMYSLNIE;
+    int kibice = (argc > 2) ? atoi(argv[2]) : KIBICE_DOMYSLNIE;
+    if (argc > 3 || zadania < 1 || kibice < 1 || kibice > SKRZYNKI) {
+        fprintf(stderr, "Użycie: %s [zadania_na_kibica [kibice 1..%d]]\n", argv[0], SKRZYNKI);
+        exit(1);
+    }
+
+    size_t rozmiar = sizeof(SharedState) + sizeof(Wyniki);
+    char *pam = mmap(NULL, rozmiar, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pam == MAP_FAILED) die_errno("mmap");
+    SharedState *stan = (SharedState *)pam;
+    Wyniki *w = (Wyniki *)(pam + sizeof(SharedState));
+
+    printf("[BENCH] kibice: %d | żądań na kibica: %ld | CPU: %ld\n", kibice, zadania,
+           sysconf(_SC_NPROCESSORS_ONLN));
+
+    for (int rodzaj = 0; rodzaj < TRANSPORT_N; rodzaj++) przebieg(rodzaj, stan, w, kibice, zadania);
+
+    if (munmap(pam, rozmiar) == -1) warn_errno("munmap");
+    return 0;
+}
@@ -1,19 +1,18 @@
 #include "common.h"
+#include "pamiec.h"
+#include "transport.h"
 
 /*
  * ==================
  * CLEAN: sprzątanie
  * ==================
- * ./clean usuwa zasoby po kluczach KEY_* i jest wołany przez main na końcu.
+ * ./clean usuwa zasoby po kluczach KEY_* (i kolejki POSIX transportu) i jest wołany przez main na końcu.
+ * SharedState z pliku (./setup pamiec=plik) zostaje jako zrzut PLIK_ZRZUTU do obejrzenia ./zrzut.
  */
 
 int main() {
-    /* shmget(): próba znalezienia istniejącego segmentu shm*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    if (shmid != -1) {
-        /* shmctl(IPC_RMID): usuwa segment pamięci współdzielonej*/
-        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
-    } else if (errno != ENOENT) warn_errno("shmget");
+    /* SharedState: segment shm albo plik stanu (ten najpierw do zrzutu) – pamiec.h */
+    stan_usun(1);
 
     /* semget(): próba znalezienia istniejącego zestawu semaforów*/
     int semid = semget(KEY_SEM, N_SEM, 0600);
@@ -22,18 +21,14 @@ int main() {
         if (semctl(semid, 0, IPC_RMID) == -1) warn_errno("semctl(IPC_RMID)");
     } else if (errno != ENOENT) warn_errno("semget");
 
-    /* msgget(): próba znalezienia istniejącej kolejki komunikatów*/
-    int msgid = msgget(KEY_MSG, 0600);
-    if (msgid != -1) {
-        /* msgctl(IPC_RMID): usuwa kolejkę komunikatów*/
-        if (msgctl(msgid, IPC_RMID, NULL) == -1) warn_errno("msgctl(IPC_RMID)");
-    } else if (errno != ENOENT) warn_errno("msgget");
+    /* Kolejki transportu: msg backendu sysv i kolejki POSIX (transport.h) */
+    transport_usun();
 
-    /* Druga kolejka: bilety (kasjer -> kibic) */
-    int msgid_ticket = msgget(KEY_MSG_TICKET, 0600);
-    if (msgid_ticket != -1) {
-        if (msgctl(msgid_ticket, IPC_RMID, NULL) == -1) warn_errno("msgctl(IPC_RMID ticket)");
-    } else if (errno != ENOENT) warn_errno("msgget(ticket)");
+    /* Druga kolejka: zlecenia zygoty */
+    int msgid_zygota = msgget(KEY_MSG_ZYGOTA, 0600);
+    if (msgid_zygota != -1) {
+        if (msgctl(msgid_zygota, IPC_RMID, NULL) == -1) warn_errno("msgctl(IPC_RMID zygota)");
+    } else if (errno != ENOENT) warn_errno("msgget(zygota)");
 
     printf("[OK] Zasoby usunięte.\n");
     return 0;
@@ -7,7 +7,7 @@
  *  - klucze IPC (System V: shm/sem/msg),
  *  - struktury pamięci współdzielonej (SharedState),
  *  - formaty komunikatów (kolejka wiadomości),
- *  - indeksy semaforów oraz sekwencje ANSI do kolorowania logów.
+ *  - indeksy semaforów (mutexy przez synchro.h) oraz sekwencje ANSI do kolorowania logów.
  */
 
 #include <stdio.h>
@@ -23,6 +23,13 @@
 #include <errno.h>
 #include <time.h>
 #include <signal.h>
+#ifdef SYNC_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "metryki.h"
+#include "ring.h"
+#include "futex.h"
 
 /*
  * Helpery do diagnostyki błędów systemowych.
@@ -44,25 +51,27 @@ static inline void die_errno(const char *ctx) {
 }
 
 /*
- * KOLEJKA WIADOMOŚCI (msg) - najważniejsze typy:
- *  - MSGTYPE_VIP_REQ (1):   kibic VIP -> kasjer (prośba o bilet VIP),
- *  - MSGTYPE_STD_REQ (2):   kibic STD -> kasjer (prośba o bilet standard),
- *  - MSGTYPE_TICKET_BASE+id: kasjer -> konkretny kibic (odpowiedź: sektor lub -1),
- *  - mtype = 10 + sektor:   kierownik -> pracownik(sektor) (sygnał 1/2/3),
- *  - mtype = 99:            pracownik -> kierownik (raport: sektor pusty),
- *  - mtype = 5000:          kontroler-kierownik -> master-kierownik (przekaz komend).
+ * KOMUNIKATY STERUJĄCE (transport.h, adresat = CEL_*) - najważniejsze typy:
+ *  - CEL_PRACOWNIK(sektor): kierownik -> pracownik(sektor) (sygnał 1/2/3), w sysv mtype = 10 + sektor,
+ *  - CEL_RAPORT:            pracownik -> kierownik (raport: sektor pusty), w sysv mtype = 99,
+ *  - CEL_MASTER:            kontroler-kierownik -> master-kierownik (przekaz komend), w sysv mtype = 5000.
  */
 
 /* =========================
  * Parametry symulacji
  * ========================= */
 
-/* K – liczba kibicow. */
+/* K – liczba kibicow (można nadpisać przy kompilacji: make K=100000). */
+#ifndef K
 #define K 8000
+#endif
 
 // Globalny limit liczby procesów, które wolno UTWORZYĆ w całej symulacji.
 #define MAX_PROC 12000
 
+// Co ilu kibiców w kolejce do kas zapisujemy czas od startu generatora (pomiar startu w main).
+#define START_PROG 1000
+
 /* Sektory standardowe*/
 #define LICZBA_SEKTOROW 8
 
@@ -75,14 +84,32 @@ static inline void die_errno(const char *ctx) {
 /* Maksymalna liczba osób jednocześnie w jednej bramce*/
 #define MAX_NA_STANOWISKU 3
 
+/* Czas obsługi jednego klienta przy kasie w us (0 = sam narzut kasjera, do pomiaru paczek) */
+#ifndef CZAS_OBSLUGI_US
+#define CZAS_OBSLUGI_US 10000
+#endif
+
+/* Takt kontrolera kas w master-kierowniku: co tyle ms jedna decyzja otwórz/zamknij (autoskaluj_kasy) */
+#define TAKT_KAS_MS 50
+
+/* Największa paczka żądań zdejmowana naraz przez kasjera (./main paczka=N, domyślnie 1) */
+#define PACZKA_KASY_MAX 64
+
+/* Budziki kolejki pod bramkami na sektor i drużynę (numery dzielą budzik modulo – wtedy tylko zbędna pobudka) */
+#define BUDZIKI_BRAMKI 256
+
 /* Licznik cierpliwości kibica*/
 #define LIMIT_CIERPLIWOSCI 5
 
 /* Czas do rozpoczęcia meczu w sekundach*/
+#ifndef CZAS_PRZED_MECZEM
 #define CZAS_PRZED_MECZEM 5
+#endif
 
 /* Czas trwania meczu w sekundach*/
+#ifndef CZAS_MECZU
 #define CZAS_MECZU 35
+#endif
 
 /* =========================
  * Klucze IPC
@@ -92,15 +119,156 @@ static inline void die_errno(const char *ctx) {
 #define KEY_SEM 5678
 #define KEY_MSG 9012
 
-/* Druga kolejka: wyłącznie odpowiedzi (bilety) kasjer -> kibic.
- * Rozdzielenie request/response zapobiega zakleszczeniu, gdy kolejka
- * żądań zapcha się przy bardzo dużej liczbie procesów.
+/* Druga kolejka: zlecenia dla zygoty (main/pośrednik -> zygota).
+ * Osobno, żeby kasjer nie zablokował się na msgsnd() do kolejki
+ * zapchanej żądaniami kibiców, które sam musi obsłużyć.
+ */
+#define KEY_MSG_ZYGOTA 9014
+
+/* Backend transportu sysv (transport.h): żądania kibic -> kasjer i bilety kasjer -> kibic.
+ * W backendach shm i posix kolejki istnieją, ale są puste (bilety idą skrzynkami w shm, Skrzynka). */
+#define KEY_MSG_ZADANIA 9016
+#define KEY_MSG_BILETY 9018
+
+/* =========================
+ * Metryki opóźnień (Histogram w SharedState)
+ * ========================= */
+enum {
+    /* zlecenie utworzenia kibica -> kibic gotowy do działania (po exec/fork/wątku) */
+    LAT_START_KIBICA,
+    /* czas wywołania spawn_program() w rodzicu (posix_spawn albo fork+exec) */
+    LAT_SPAWN,
+    /* zamierzony czas przybycia (main, przybycia.h) -> bilet z kasy */
+    LAT_BILET,
+    /* zamierzony czas przybycia -> kibic w sektorze (po bramce albo wejściem VIP) */
+    LAT_WEJSCIE,
+    /* zamierzony czas przybycia -> faktyczne zlecenie utworzenia kibica przez generator */
+    LAT_SPOZNIENIE_GENERATORA,
+    /* kasjer wstawił kolegę do kolejki pośrednika -> pośrednik go utworzył i wysłał bilet */
+    LAT_START_KOLEGI,
+    /* obsługa jednego klienta przez kasjera: od zdjęcia żądania do wysłania biletu(ów) */
+    LAT_OBSLUGA_KASY,
+    /* kibic wstawił żądanie -> kasjer je zdjął, gdy przed tym spał na dzwonku przy pustych kolejkach */
+    LAT_PIERWSZE_ZADANIE,
+    /* ewakuacja: ostatni kibic opuścił sektor (bramki + obecni) -> pracownik/kierownik to zauważył */
+    LAT_SEKTOR_PUSTY,
+    /* pierwsza próba wejścia do bramki -> miejsce w bramce (czekanie pod bramkami) */
+    LAT_CZEKANIE_NA_BRAMKE,
+    /* bilet w ręku -> w sektorze: kibic bez dziecka / para opiekun+dziecko (grupa=2) */
+    LAT_BRAMKA,
+    LAT_BRAMKA_DZIECKA,
+    /* kasjer/pośrednik/kierownik wpisał bilet do skrzynki -> kibic go odebrał */
+    LAT_ODPOWIEDZ,
+    LAT_N
+};
+
+static const char *const NAZWY_LAT[LAT_N] = {
+    "start_kibica",
+    "spawn",
+    "bilet_od_zamiaru",
+    "wejscie_od_zamiaru",
+    "spoznienie_generatora",
+    "start_kolegi",
+    "obsluga_kasy",
+    "pierwsze_zadanie",
+    "wykrycie_pustego_sektora",
+    "czekanie_na_bramke",
+    "bramka",
+    "bramka_dziecka",
+    "odpowiedz",
+};
+
+/* =========================
+ * Semafory (System V)
+ * =========================
+ * MUTEXY (po jednym na dziedzinę danych, zamiast jednego semafora na cały SharedState):
+ *  - SEM_SPRZEDAZ: księga sprzedaży – sprzedane_bilety, standard_sold_out, sprzedaz_zakonczona
+ *  - SEM_KASY:     aktywność kas (otwieranie/zamykanie); kolejki to pierścienie bez blokad
+ *  - SEM_SLOTY:    licznik procesów active_proc (reserve/rollback_process_slots)
+ *  - SEM_KOLEGI:   kolejka kolegów kasjer -> pośrednik + posrednik_koniec
+ *  - SEM_SEKTOR_START: mutex per sektor (bramki + agresor)
+ *  - SEM_KIEROWNIK: wybór master-kierownika
+ * Obecni w sektorach i statystyki cnt_* nie mają blokady – to liczniki atomowe.
+ * Pierwsze LICZBA_MUTEXOW (SEM_SPRZEDAZ .. ostatni sektor) idą przez zablokuj()/odblokuj()
+ * z synchro.h – przy make SYNC=pthread to pthread_mutex_t w SharedState zamiast semaforów.
+ *
+ * KOLEJNOŚĆ BLOKAD: jedyne zagnieżdżenie to SEM_SPRZEDAZ -> SEM_KOLEGI (kasjer sprzedaje
+ * 2 bilety i wstawia kolegę w jednym kroku). Pozostałe mutexy są liśćmi: trzymając je, nie bierzemy
+ * żadnej innej blokady (reserve_process_slot() kasjer woła PRZED wejściem pod SEM_SPRZEDAZ).
+ *
+ * ZDARZENIA:
+ *  - SEM_EWAKUACJA: start=1, przy ewakuacji ustawiane na 0.
+ *      Kibice czekają semop(op=0) aż semval==0.
+ *  - SEM_SEKTOR_BLOCK_START..: start=0 (sektor otwarty).
+ *      Pracownik ustawia 1 (blokada) / 0 (odblokowanie),
+ *      a kibice czekają semop(op=0) aż będzie 0.
+ *  - SEM_POSREDNIK: start=0, semafor zliczający zlecenia kolegów dla pośrednika.
  */
-#define KEY_MSG_TICKET 9013
+#define SEM_SPRZEDAZ 0
+#define SEM_KASY 1
+#define SEM_SLOTY 2
+#define SEM_KOLEGI 3
+#define SEM_SEKTOR_START 4
+#define SEM_KIEROWNIK (SEM_SEKTOR_START + LICZBA_SEKTOROW)
+
+/* Mutexy obsługiwane przez backend z synchro.h: SEM_SPRZEDAZ .. ostatni sektor */
+#define LICZBA_MUTEXOW (SEM_SEKTOR_START + LICZBA_SEKTOROW)
+
+/* Zdarzenie: ewakuacja (semval==0 => ewakuacja trwa / wszyscy wychodzą)*/
+#define SEM_EWAKUACJA (SEM_KIEROWNIK + 1)
+
+/* Zdarzenia: blokady sektorów (semval==0 => sektor otwarty)*/
+#define SEM_SEKTOR_BLOCK_START (SEM_EWAKUACJA + 1)
+
+/* Zdarzenie: liczba zleceń w kolejce kolegów (kasjer +1, pośrednik -1), start=0 */
+#define SEM_POSREDNIK (SEM_SEKTOR_BLOCK_START + LICZBA_SEKTOROW)
+
+/* Łączna liczba semaforów w zestawie*/
+#define N_SEM (SEM_POSREDNIK + 1)
 
 /* =========================
  * Struktury danych
  * =========================
+ * ZlecenieKolegi = kolega z drugiego biletu czekający na utworzenie przez pośrednika.
+ */
+#define KOLEJKA_KOLEGOW 256 // potęga dwójki: indeks = licznik % KOLEJKA_KOLEGOW
+
+/* Adresaci komunikatów sterujących (transport.h): pracownik sektora, raporty dla mastera, komendy do mastera */
+#define CEL_PRACOWNIK(s) (s)
+#define CEL_RAPORT LICZBA_SEKTOROW
+#define CEL_MASTER (LICZBA_SEKTOROW + 1)
+#define CELE_STEROWANIA (LICZBA_SEKTOROW + 2)
+
+typedef struct {
+    int kibic_id;
+    int sektor;
+    long long t_zlecenia_ns; // chwila sprzedaży (do LAT_START_KOLEGI)
+} ZlecenieKolegi;
+
+/* ID dla kolegow ktorzy nie pojawili sie w kasie.
+ * Przy dużym K (tryb wątkowy) ID z main sięgają K, więc pula kolegów startuje wyżej.
+ */
+#define DYN_ID_START (K > 50000 ? K : 50000)
+
+/*
+ * Skrzynka = odpowiedź kasy (bilet) dla jednego kibica, indeks = id kibica.
+ * Id z generatora: 0..K, koledzy: od DYN_ID_START (kolegów jest najwyżej tyle, co biletów).
+ * Słowo stan jest futexem: kibic śpi w futex_czekaj tylko wtedy, gdy ustawił SKRZYNKA_CZEKA,
+ * a wysyłający woła futex_obudz tylko, gdy zastał SKRZYNKA_CZEKA (bilet_wyslij/bilet_odbierz).
+ */
+#define SKRZYNKI (DYN_ID_START + K)
+
+#define SKRZYNKA_PUSTA 0
+#define SKRZYNKA_CZEKA 1
+#define SKRZYNKA_BILET 2
+
+typedef struct {
+    unsigned int stan;
+    int sektor;               // sektor albo -1 (odmowa)
+    long long t_wyslania_ns;  // do LAT_ODPOWIEDZ
+} Skrzynka;
+
+/*
  * Stanowisko = jedna bramka wejściowa.
  *
  * zajetosc – ilu kibiców aktualnie jest w bramce
@@ -111,172 +279,522 @@ typedef struct {
     int druzyna;
 } Stanowisko;
 
+/*
+ * Wersja = seqlock jednej domeny SharedState pokazywanej w migawce (migawka.h) – dla wielu piszących:
+ *  - piszący otacza zmianę pól domeny wersja_zapis_start() / wersja_zapis_koniec()
+ *    (zwykle i tak pod blokadą domeny; obecni zmieniają się bez blokady – liczniki to znoszą),
+ *  - start == koniec: nikt nie jest w trakcie zapisu; czytelnik sprawdza to przed kopią
+ *    i po kopii porównuje start – zmieniony = ktoś pisał w międzyczasie, próbujemy jeszcze raz.
+ * Koszt dla piszącego: dwa __atomic_add_fetch na linii, którą i tak właśnie zapisuje.
+ */
 typedef struct {
-    /* Aktualne długości kolejek*/
-    int kolejka_zwykla;
-    int kolejka_vip;
+    unsigned int start;
+    unsigned int koniec;
+} Wersja;
+
+static inline void wersja_zapis_start(Wersja *w) {
+    // seq_cst (pełna bariera): zapisy pól nie wyprzedzą podbicia start
+    __atomic_add_fetch(&w->start, 1, __ATOMIC_SEQ_CST);
+}
 
-    /* Czy dana kasa jest aktywna*/
-    int aktywne_kasy[LICZBA_KAS];
+static inline void wersja_zapis_koniec(Wersja *w) {
+    __atomic_add_fetch(&w->koniec, 1, __ATOMIC_RELEASE);
+}
 
-    /* Ile biletów sprzedano na każdy sektor*/
-    int sprzedane_bilety[LICZBA_SEKTOROW + 1];
+// Piszący zginął w trakcie zapisu (np. zegar zabity SIGTERM) – tylko gdy innych piszących domeny już nie ma
+static inline void wersja_napraw(Wersja *w) {
+    __atomic_store_n(&w->koniec, __atomic_load_n(&w->start, __ATOMIC_SEQ_CST), __ATOMIC_RELEASE);
+}
 
-    /* 2 bramki dla kazdego sektora*/
-    Stanowisko bramki[LICZBA_SEKTOROW][2];
+/*
+ * Układ SharedState: pola pogrupowane według tego, kto je zapisuje, a każda grupa zaczyna się
+ * w nowej linii cache (LINIA_CACHE). Zapis jednej roli (np. zegar kierownika, kibic w bramce
+ * sektora 3) nie unieważnia wtedy linii, na których pracują inne role (kasjerzy, bramki sektora 4).
+ */
+#define LINIA_CACHE 64
 
-    /*Licznik wejść na kontrolę*/
-    int wejscia_kontrola[LICZBA_SEKTOROW][2];
+/*
+ * StanSektora = stan jednego sektora, każdy sektor we własnych liniach cache.
+ *  - linia bramek: kibice przy bramkach (pod SEM_SEKTOR_START + s) i pracownik sektora,
+ *    razem z kolejką FIFO pod bramkami (numery per drużyna) i statystyką bramek,
+ *  - linia obecnych: licznik atomowy zmieniany przy wejściu do sektora i wyjściu z niego,
+ *    osobno, żeby wychodzący przy ewakuacji nie przeszkadzali przechodzącym przez bramki.
+ * Sektor VIP (SEKTOR_VIP) nie ma bramek – używa tylko licznika obecnych.
+ */
+typedef struct {
+    /* 2 bramki sektora*/
+    Stanowisko bramki[2];
+
+    /*Licznik wejść na kontrolę (per drużyna)*/
+    int wejscia_kontrola[2];
+
+    /*Priorytet „agresora” pod sektorem (id kibica albo 0).*/
+    int agresor;
+
+    /* Flaga blokady sektora (pracownik)*/
+    int blokada;
+
+    /* Seqlock migawki sektora: bramki, agresor, blokada i obecni (także linia obecnych) */
+    Wersja wersja;
+
+    /* Kolejka FIFO pod bramkami per drużyna (kibic_zycie.c), numerki jak w ticket lock:
+     * kolejka_nastepny[d] dostaje kolejny przybyły, kolejka_czolo[d] = numer czoła (ilu wpuszczono);
+     * czekajacy[d] = ilu śpi na budzikach (__atomic); czolo_konflikt[d] = czoło nie zmieściło się
+     * do bramek i śpi (konflikt drużyn albo pełne bramki), a czolo_przeciwnicy_przed[d] to jego
+     * "przeciwnicy przed nami" – wpuszczający przeciwnik liczy z tego cierpliwość czoła. */
+    unsigned int kolejka_nastepny[2];
+    unsigned int kolejka_czolo[2];
+    int czekajacy[2];
+    int czolo_konflikt[2];
+    unsigned int czolo_przeciwnicy_przed[2];
+
+    /* Statystyka bramek (pod mutexem sektora): nieudane próby wejścia, czas zajętości
+     * miejsc w bramkach (osoba * ns) i okno od pierwszego wejścia do ostatniego wyjścia. */
+    int proby_nieudane;
+    long long zajete_ns;
+    long long t_pierwsze_wejscie_ns;
+    long long t_ostatnie_wyjscie_ns;
+
+    /* Zdarzenie "sektor może być pusty" przy ewakuacji (sektor_zmiana / sektor_czekaj_na_pusty):
+     * licznik = słowo futexa, czas ostatniej zmiany i flaga, że pracownik/kierownik czeka (__atomic). */
+    unsigned int pusto_zdarzenie;
+    int pusto_czeka;
+    long long t_pusto_ns;
+
+    /* Ile osób aktualnie przebywa w sektorze (__atomic, bez blokady)*/
+    int obecni __attribute__((aligned(LINIA_CACHE)));
+} StanSektora;
+
+/* Statystyka jednego mutexu (synchro.h): wejścia i te z nich, które musiały czekać */
+typedef struct {
+    unsigned long long wejscia;
+    unsigned long long czekania;
+} __attribute__((aligned(LINIA_CACHE))) StatBlokady;
 
-    /* Ile osób aktualnie przebywa w sektorze*/
-    int obecni_w_sektorze[LICZBA_SEKTOROW + 1];
+#ifdef SYNC_PTHREAD
+/* Mutex backendu pthread (synchro.h) w osobnej linii cache */
+typedef struct {
+    pthread_mutex_t m;
+} __attribute__((aligned(LINIA_CACHE))) MutexLinii;
+#endif
 
-    /* Flagi blokad sektorów standardowych*/
-    int blokada_sektora[LICZBA_SEKTOROW];
+typedef struct {
+    /* --- Nośnik stanu (pamiec.h): zapisuje ./setup, odczytuje stan_odlacz() i ./zrzut --- */
+    unsigned int rozmiar_stanu; // sizeof(SharedState) w setup – zrzut z innej kompilacji (K) nie pasuje
+    int pamiec;                 // PAMIEC_SYSV / PAMIEC_PLIK
+    int strony;                 // STRONY_* faktycznie przydzielone
+    size_t rozmiar_mapy;        // długość segmentu/mapowania (przy dużych stronach zaokrąglona)
 
-    /*Priorytet „agresora” pod sektorem.*/
-    int agresor_sektora[LICZBA_SEKTOROW];
+    /* --- Sterowanie: kierownik, main i pracownicy zapisują rzadko, czytają wszyscy --- */
 
     /* Flaga globalna: trwa ewakuacja (1) / nie trwa (0). */
-    int ewakuacja_trwa;
+    int ewakuacja_trwa __attribute__((aligned(LINIA_CACHE)));
 
     /* Status meczu*/
     int status_meczu;
 
+    /* PID zygoty (./main zygota) albo 0, gdy kibiców tworzy się fork+exec. */
+    pid_t zygota_pid;
+
+    /* Ziarno losowania przebiegu (./main ziarno=N albo z czasu), zapisuje main przed startem ról – ziarno_dla() */
+    unsigned int ziarno;
+
+    /* Rozmiar paczki żądań kasjera (./main paczka=N), zapisuje main przed startem kasjerów */
+    int paczka_kasy;
+
+    /* Backend transportu komunikatów (./main transport=shm|sysv|posix, transport.h), zapisuje main przed startem ról */
+    int transport;
+
+    /* --- Zegar: kierownik zapisuje co sekundę --- */
+
     /* Licznik czasu w sekundach. */
-    int czas_pozostaly;
+    int czas_pozostaly __attribute__((aligned(LINIA_CACHE)));
+
+    /* Seqlock migawki: status_meczu + czas_pozostaly (zapisuje tylko kierownik) */
+    Wersja wersja_meczu;
+
+    /* --- Kasy: aktywność kas, zmienia kontroler kas w kierowniku (i kasjer przy końcu sprzedaży), pod SEM_KASY --- */
+
+    /* Czy dana kasa jest aktywna (słowo jest też futexem: zamknięty kasjer śpi, dopóki jest 0) */
+    int aktywne_kasy[LICZBA_KAS] __attribute__((aligned(LINIA_CACHE)));
+    Wersja wersja_kas; // seqlock migawki aktywne_kasy
+    int kasy_otwarcia;   // decyzje kontrolera kas (raport main)
+    int kasy_zamkniecia;
+
+    /* --- Dzwonek kas: kibice i sterowanie, __atomic bez blokady (kasy_zadzwon/kasy_obudz) --- */
+    unsigned int dzwonek_kas __attribute__((aligned(LINIA_CACHE)));
+    int kasjerzy_spiacy; // ilu otwartych kasjerów śpi na dzwonku – bez śpiących kibic nie woła futex_obudz
+    /* Raport main: dopisywane po każdym uśpieniu kasjera (jak kasjerzy_spiacy – ta sama linia) */
+    int kasjerzy_uspienia;
+    int kasjerzy_pobudki; // uśpienia zakończone dzwonkiem/otwarciem, a nie limitem czasu
+    /* Raport main: dopisywane po każdej paczce – osobna linia, żeby nie dzielić jej z dzwonkiem kibiców */
+    int kasjerzy_paczki __attribute__((aligned(LINIA_CACHE))); // paczki żądań zdjęte z kolejek
+    int kasjerzy_zadania;      // żądania w tych paczkach
+    int kasjerzy_bilety;       // sprzedane bilety (z kolegami i dziećmi)
+    long long kasjerzy_praca_ns; // czas od zdjęcia paczki do ostatniego biletu, suma po paczkach
+    long long kasjerzy_cpu_ns;   // przyrosty getrusage() po paczce, przed uśpieniem i przy wyjściu
+
+    /* --- Księga sprzedaży: kasjerzy (i cofanie biletów-duchów), pod SEM_SPRZEDAZ --- */
 
-    /* Generator unikalnych ID dla kibicow*/
-    int next_kibic_id;
+    /* Ile biletów sprzedano na każdy sektor*/
+    int sprzedane_bilety[LICZBA_SEKTOROW + 1] __attribute__((aligned(LINIA_CACHE)));
+    Wersja wersja_sprzedazy; // seqlock migawki sprzedane_bilety
 
-    /* Flagi wyprzedania biletow i zakończenia sprzedaży. */
+    /* Flagi wyprzedania biletów na sektory standardowe i zakończenia sprzedaży. */
     int standard_sold_out;
     int sprzedaz_zakonczona;
 
-    /* Statystyki do raportu końcowego. */
-    int cnt_weszlo;
+    /* Generator unikalnych ID dla kibicow (__atomic_fetch_add)*/
+    int next_kibic_id;
+
+    /* --- Sloty procesów: generator, kasjerzy, pośrednik, zygota, pod SEM_SLOTY --- */
+
+    // Licznik wszystkich UTWORZONYCH procesów (globalnie dla całej symulacji).
+    // Służy do zatrzymania dalszego forka gdy dobijemy do MAX_PROC.
+    int active_proc __attribute__((aligned(LINIA_CACHE)));
+
+    /* --- Kolejka kasjer -> pośrednik (posrednik.c), pod SEM_KOLEGI; SEM_POSREDNIK liczy zlecenia --- */
+    unsigned int kolegi_glowa __attribute__((aligned(LINIA_CACHE))); // następne do zdjęcia przez pośrednika
+    unsigned int kolegi_ogon;  // następne wolne miejsce dla kasjera
+    int posrednik_koniec;      // main: po opróżnieniu kolejki pośrednik ma się zakończyć
+    ZlecenieKolegi kolegi[KOLEJKA_KOLEGOW];
+
+    /* --- Statystyki do raportu końcowego: kibice, __atomic bez blokady --- */
+    int cnt_weszlo __attribute__((aligned(LINIA_CACHE)));
     int cnt_opiekun;
     int cnt_kolega;
     int cnt_agresja;
 
-    // Licznik wszystkich UTWORZONYCH procesów (globalnie dla całej symulacji).
-    // Służy do zatrzymania dalszego forka gdy dobijemy do MAX_PROC.
-    int active_proc;
+    /* --- Start generatora (main.c), wszystko __atomic bez blokady ---
+     *  - gotowe_role: role po podłączeniu stanu (zamiast stałego sleep(1) przed generatorem),
+     *  - w_kolejce / t_w_kolejce_ns[]: ilu kibiców dołączyło do kolejek kas i kiedy
+     *    dołączył każdy kolejny START_PROG-ty (pomiar "czas do N w kolejce"),
+     *  - podgeneratory_*: wyniki podgeneratorów trybu ./main drzewo,
+     *  - dzieci_main: żyjące dzieci main (licznik reapera z main.c) – podgląd w monitorze. */
+    int w_kolejce __attribute__((aligned(LINIA_CACHE)));
+    long long t_ostatni_w_kolejce_ns;
+    long long t_w_kolejce_ns[K / START_PROG + 1];
+    int gotowe_role __attribute__((aligned(LINIA_CACHE)));
+    long long start_generatora_ns;
+    int podgeneratory_pracuja;
+    int podgeneratory_wygenerowani;
+    long long podgeneratory_czas_tworzenia_ns;
+    int dzieci_main;
+
+    /* --- Sektory: bramki i obecni, każdy sektor osobno --- */
+    StanSektora sektory[LICZBA_SEKTOROW + 1];
+
+    /* Budziki kolejek pod bramkami: czekający z numerem nr śpi na [sektor][drużyna][nr % BUDZIKI_BRAMKI] */
+    unsigned int budziki_bramek[LICZBA_SEKTOROW][2][BUDZIKI_BRAMKI] __attribute__((aligned(LINIA_CACHE)));
+
+    /* Rozkłady opóźnień (LAT_*), eksportowane przez main do metryki.txt (Histogram wyrównany do linii). */
+    Histogram lat[LAT_N];
+
+    /* Kolejki do kas: żądania kibic -> kasjer w pierścieniach bez blokad (ring.h),
+     * długość kolejki = ring_dlugosc(). */
+    Ring kolejka_vip;
+    Ring kolejka_zwykla;
+
+    /* Długość kolejek do kas w backendach sysv/posix (transport_dlugosc): [0] standard, [1] VIP, __atomic */
+    int kolejka_msg[2] __attribute__((aligned(LINIA_CACHE)));
+
+    /* Kanały sterujące backendu shm (transport.h), indeks = adresat CEL_* */
+    KanalSterujacy kanaly[CELE_STEROWANIA];
+
+    /* Odpowiedzi kas (bilety) dla kibiców, indeks = id kibica. */
+    Skrzynka skrzynki[SKRZYNKI] __attribute__((aligned(LINIA_CACHE)));
+
+    /* Wejścia/czekania na każdym mutexie (zablokuj()), raport w main – pomiar rywalizacji. */
+    StatBlokady blokady[LICZBA_MUTEXOW];
+
+#ifdef SYNC_PTHREAD
+    /* Mutexy SEM_SPRZEDAZ .. SEM_SEKTOR_START + s w backendzie pthread (synchro.h). */
+    MutexLinii mutexy[LICZBA_MUTEXOW];
+#endif
 } SharedState;
 
+#include "synchro.h"
 
-// Rezerwuje "slot" na nowy proces (atomowo): jeśli licznik dobił do MAX_PROC,
-// zwraca 0 i NIE zwiększa licznika. W przeciwnym razie zwiększa i zwraca 1.
-static inline int reserve_process_slot(SharedState *stan, int semid) {
-    struct sembuf lock = {0, -1, 0};
-    struct sembuf unlock = {0, +1, 0};
-
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &lock, 1) == -1) {
-        if (errno == EINTR) continue;
-        return 0;
-    }
+// Rezerwuje do n slotów na nowe procesy jednym wejściem pod SEM_SLOTY (hurtem, np. dla
+// podgeneratora). Przyznaje tyle, ile zostało do MAX_PROC, i zwraca tę liczbę (0..n).
+static inline int reserve_process_slots(SharedState *stan, int semid, int n) {
+    zablokuj(stan, semid, SEM_SLOTY);
 
     int ok = 0;
     // Odczytujemy licznik procesów (żeby wiedzieć czy można tworzyć kolejne role)
     if (stan->active_proc < MAX_PROC) {
+        ok = MAX_PROC - stan->active_proc;
+        if (ok > n) ok = n;
         // Zmieniamy globalny licznik utworzonych procesów
-        stan->active_proc++;
-        ok = 1;
+        stan->active_proc += ok;
     }
 
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &unlock, 1) == -1) {
-        if (errno == EINTR) continue;
-        break;
-    }
+    odblokuj(stan, semid, SEM_SLOTY);
     return ok;
 }
 
+// Oddaje n niewykorzystanych slotów (nieudany fork/exec albo reszta rezerwacji hurtowej)
+static inline void rollback_process_slots(SharedState *stan, int semid, int n) {
+    if (n <= 0) return;
+    zablokuj(stan, semid, SEM_SLOTY);
+
+    // Zmieniamy globalny licznik utworzonych procesów
+    stan->active_proc -= (stan->active_proc < n) ? stan->active_proc : n;
+
+    odblokuj(stan, semid, SEM_SLOTY);
+}
+
+// Rezerwuje "slot" na nowy proces (atomowo): jeśli licznik dobił do MAX_PROC,
+// zwraca 0 i NIE zwiększa licznika. W przeciwnym razie zwiększa i zwraca 1.
+static inline int reserve_process_slot(SharedState *stan, int semid) {
+    return reserve_process_slots(stan, semid, 1);
+}
+
 // Cofamy rezerwację miejsca na proces (poprzedni fork/exec się nie udał)
 static inline void rollback_process_slot(SharedState *stan, int semid) {
-    struct sembuf lock = {0, -1, 0};
-    struct sembuf unlock = {0, +1, 0};
+    rollback_process_slots(stan, semid, 1);
+}
 
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &lock, 1) == -1) {
-        if (errno == EINTR) continue;
+// Rola (kierownik, pracownik, pośrednik, kasjer) jest podpięta do IPC – main może ruszać z generatorem
+static inline void rola_gotowa(SharedState *stan) {
+    __atomic_add_fetch(&stan->gotowe_role, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Kolejka kolegów (kasjer -> pośrednik). Wywołujący trzyma SEM_KOLEGI.
+ * Pełna kolejka = kasjer sprzedaje 1 bilet zamiast 2 (jak przy braku slotu na proces).
+ */
+static inline int kolegi_wolne(const SharedState *stan) {
+    return stan->kolegi_ogon - stan->kolegi_glowa < KOLEJKA_KOLEGOW;
+}
+
+static inline void kolegi_wstaw(SharedState *stan, int kibic_id, int sektor, long long t_zlecenia_ns) {
+    ZlecenieKolegi *z = &stan->kolegi[stan->kolegi_ogon % KOLEJKA_KOLEGOW];
+    z->kibic_id = kibic_id;
+    z->sektor = sektor;
+    z->t_zlecenia_ns = t_zlecenia_ns;
+    stan->kolegi_ogon++;
+}
+
+// Zwraca 0, gdy kolejka pusta.
+static inline int kolegi_zdejmij(SharedState *stan, ZlecenieKolegi *z) {
+    if (stan->kolegi_glowa == stan->kolegi_ogon) return 0;
+    *z = stan->kolegi[stan->kolegi_glowa % KOLEJKA_KOLEGOW];
+    stan->kolegi_glowa++;
+    return 1;
+}
+
+/*
+ * Wysyła bilet (sektor albo -1 = odmowa) do skrzynki kibica: O(1), bez semaforów.
+ * futex_obudz() tylko wtedy, gdy kibic już śpi w bilet_odbierz().
+ */
+static inline void bilet_wyslij(SharedState *stan, int kibic_id, int sektor) {
+    if (kibic_id < 0 || kibic_id >= SKRZYNKI) {
+        fprintf(stderr, "[BŁĄD] bilet_wyslij: id kibica %d poza skrzynkami\n", kibic_id);
         return;
     }
+    Skrzynka *s = &stan->skrzynki[kibic_id];
+    s->sektor = sektor;
+    s->t_wyslania_ns = czas_ns();
+    // release: sektor i czas są widoczne, zanim kibic zobaczy SKRZYNKA_BILET
+    if (__atomic_exchange_n(&s->stan, SKRZYNKA_BILET, __ATOMIC_RELEASE) == SKRZYNKA_CZEKA) {
+        if (futex_obudz(&s->stan, 1) == -1) warn_errno("futex_obudz(skrzynka)");
+    }
+}
 
-    // Zmieniamy globalny licznik utworzonych procesów
-    if (stan->active_proc > 0) stan->active_proc--;
+/*
+ * Czeka na bilet w swojej skrzynce. Zwraca sektor albo -1 (odmowa).
+ * Przy ewakuacji zwraca -1 bez biletu (kierownik budzi śpiących skrzynki_obudz());
+ * co sekundę i tak sprawdzamy ewakuację – np. gdy ogłosił ją main, a nie kierownik.
+ */
+static inline int bilet_odbierz(SharedState *stan, int kibic_id) {
+    if (kibic_id < 0 || kibic_id >= SKRZYNKI) return -1;
+    Skrzynka *s = &stan->skrzynki[kibic_id];
+    while (1) {
+        unsigned int v = SKRZYNKA_PUSTA;
+        // Zgłaszamy, że śpimy (PUSTA -> CZEKA); gdy bilet już jest, CAS zawiedzie i v = BILET
+        if (__atomic_compare_exchange_n(&s->stan, &v, SKRZYNKA_CZEKA, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) ||
+            v == SKRZYNKA_CZEKA) {
+            if (futex_czekaj(&s->stan, SKRZYNKA_CZEKA, 1000000000LL) == -1 &&
+                errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+                warn_errno("futex_czekaj(skrzynka)");
+            }
+            v = __atomic_load_n(&s->stan, __ATOMIC_ACQUIRE);
+        }
+        if (v == SKRZYNKA_BILET) {
+            hist_dodaj(&stan->lat[LAT_ODPOWIEDZ], czas_ns() - s->t_wyslania_ns);
+            return s->sektor;
+        }
+        if (stan->ewakuacja_trwa) return -1;
+    }
+}
+
+// Ewakuacja: budzi wszystkich śpiących w bilet_odbierz() – sprawdzą ewakuacja_trwa
+static inline void skrzynki_obudz(SharedState *stan) {
+    for (int i = 0; i < SKRZYNKI; i++) {
+        if (__atomic_load_n(&stan->skrzynki[i].stan, __ATOMIC_RELAXED) == SKRZYNKA_CZEKA) {
+            (void)futex_obudz(&stan->skrzynki[i].stan, INT_MAX);
+        }
+    }
+}
 
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &unlock, 1) == -1) {
-        if (errno == EINTR) continue;
-        break;
+/*
+ * Dzwonek kas zamiast odpytywania pierścieni co 5 ms:
+ *  - kibic po ring_wstaw() podbija dzwonek_kas i budzi jednego kasjera – tylko gdy ktoś śpi,
+ *  - kasjer czyta dzwonek PRZED sprawdzeniem kolejek i śpi w kasy_czekaj() z tą wartością:
+ *    żądanie wstawione po odczycie zmieniło dzwonek, więc futex_czekaj od razu wraca (EAGAIN),
+ *  - zamknięty kasjer śpi na swoim aktywne_kasy[id] (== 0); kasa_otworz() go budzi,
+ *  - zmiany stanu (koniec sprzedaży, ewakuacja) ogłaszamy kasy_obudz() – budzi wszystkich.
+ * seq_cst na dzwonku i kasjerzy_spiacy: kibic albo widzi śpiącego, albo kasjer widzi nowy dzwonek.
+ * Limit 1 s w kasy_czekaj() to tylko siatka bezpieczeństwa (np. flaga ustawiona bez pobudki).
+ */
+static inline void kasy_zadzwon(SharedState *stan) {
+    __atomic_add_fetch(&stan->dzwonek_kas, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&stan->kasjerzy_spiacy, __ATOMIC_SEQ_CST) > 0) {
+        if (futex_obudz(&stan->dzwonek_kas, 1) == -1) warn_errno("futex_obudz(dzwonek)");
     }
 }
 
+// Zwraca 1, gdy obudził nas dzwonek (albo zmienił się przed uśpieniem), 0 po limicie czasu
+static inline int kasy_czekaj(SharedState *stan, unsigned int dzwonek) {
+    __atomic_add_fetch(&stan->kasjerzy_spiacy, 1, __ATOMIC_SEQ_CST);
+    int r = futex_czekaj(&stan->dzwonek_kas, dzwonek, 1000000000LL);
+    if (r == -1 && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) warn_errno("futex_czekaj(dzwonek)");
+    __atomic_sub_fetch(&stan->kasjerzy_spiacy, 1, __ATOMIC_SEQ_CST);
+    return !(r == -1 && errno == ETIMEDOUT);
+}
+
+// Zamknięta kasa: śpimy, dopóki aktywne_kasy[id] == 0. Wynik jak w kasy_czekaj()
+static inline int kasa_czekaj_na_otwarcie(SharedState *stan, int id) {
+    int r = futex_czekaj((unsigned int *)&stan->aktywne_kasy[id], 0, 1000000000LL);
+    if (r == -1 && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) warn_errno("futex_czekaj(kasa)");
+    return !(r == -1 && errno == ETIMEDOUT);
+}
+
+// Wywołujący trzyma SEM_KASY
+static inline void kasa_otworz(SharedState *stan, int id) {
+    wersja_zapis_start(&stan->wersja_kas);
+    __atomic_store_n(&stan->aktywne_kasy[id], 1, __ATOMIC_SEQ_CST);
+    wersja_zapis_koniec(&stan->wersja_kas);
+    if (futex_obudz((unsigned int *)&stan->aktywne_kasy[id], 1) == -1) warn_errno("futex_obudz(kasa)");
+}
+
+// Koniec sprzedaży / ewakuacja: budzi śpiących na dzwonku i zamknięte kasy – sprawdzą flagi
+static inline void kasy_obudz(SharedState *stan) {
+    __atomic_add_fetch(&stan->dzwonek_kas, 1, __ATOMIC_SEQ_CST);
+    (void)futex_obudz(&stan->dzwonek_kas, INT_MAX);
+    for (int i = 0; i < LICZBA_KAS; i++) (void)futex_obudz((unsigned int *)&stan->aktywne_kasy[i], INT_MAX);
+}
+
+/*
+ * Czekanie na bramkę: domyślnie kolejka na futexie per sektor i drużyna (kibic_zycie.c),
+ * make BRAMKI=polling (-DBRAMKI_POLLING) -> dawne ponawianie co 5-10 ms (do porównania).
+ */
+#ifdef BRAMKI_POLLING
+#define BRAMKI_BACKEND "polling"
+#else
+#define BRAMKI_BACKEND "futex"
+#endif
+
+// Ewakuacja: budzi wszystkich czekających pod bramkami – sprawdzą ewakuacja_trwa
+static inline void bramki_obudz(SharedState *stan) {
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) {
+        for (int d = 0; d < 2; d++) {
+            int spiacy = __atomic_load_n(&stan->sektory[s].czekajacy[d], __ATOMIC_SEQ_CST);
+            for (int i = 0; i < BUDZIKI_BRAMKI; i++) {
+                __atomic_add_fetch(&stan->budziki_bramek[s][d][i], 1, __ATOMIC_SEQ_CST);
+                if (spiacy) (void)futex_obudz(&stan->budziki_bramek[s][d][i], INT_MAX);
+            }
+        }
+    }
+}
+
+/*
+ * Koniec ewakuacji sektora bez odpytywania co 10 ms:
+ *  - kibic, po którym sektor może być pusty (obie bramki puste albo obecni spadło do 0),
+ *    woła sektor_zmiana() – tylko w trakcie ewakuacji, w zwykłym ruchu to nic nie kosztuje,
+ *  - pracownik (SEKTOR_VIP: kierownik) w sektor_czekaj_na_pusty() sprawdza warunek bez blokady
+ *    i śpi na pusto_zdarzenie; futex_obudz tylko, gdy ustawił pusto_czeka.
+ * seq_cst: albo sygnalizujący widzi pusto_czeka, albo czekający widzi nową wartość licznika.
+ */
+static inline void sektor_zmiana(SharedState *stan, int sektor) {
+    if (!__atomic_load_n(&stan->ewakuacja_trwa, __ATOMIC_SEQ_CST)) return;
+    StanSektora *sek = &stan->sektory[sektor];
+    __atomic_store_n(&sek->t_pusto_ns, czas_ns(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&sek->pusto_zdarzenie, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sek->pusto_czeka, __ATOMIC_SEQ_CST)) {
+        if (futex_obudz(&sek->pusto_zdarzenie, INT_MAX) == -1) warn_errno("futex_obudz(sektor)");
+    }
+}
+
+// Sektor pusty: nikt w bramkach (sektory standardowe) i nikt nie siedzi – odczyt bez blokady
+static inline int sektor_pusty(SharedState *stan, int sektor) {
+    StanSektora *sek = &stan->sektory[sektor];
+    if (sektor != SEKTOR_VIP && (__atomic_load_n(&sek->bramki[0].zajetosc, __ATOMIC_SEQ_CST) != 0 ||
+                                 __atomic_load_n(&sek->bramki[1].zajetosc, __ATOMIC_SEQ_CST) != 0)) {
+        return 0;
+    }
+    return __atomic_load_n(&sek->obecni, __ATOMIC_SEQ_CST) == 0;
+}
+
+// Ewakuacja: wraca, gdy sektor opustoszał; czas od ostatniego wyjścia do wykrycia -> LAT_SEKTOR_PUSTY
+static inline void sektor_czekaj_na_pusty(SharedState *stan, int sektor) {
+    StanSektora *sek = &stan->sektory[sektor];
+    int czekal = 0;
+    __atomic_store_n(&sek->pusto_czeka, 1, __ATOMIC_SEQ_CST);
+    while (1) {
+        unsigned int v = __atomic_load_n(&sek->pusto_zdarzenie, __ATOMIC_SEQ_CST);
+        if (sektor_pusty(stan, sektor)) break;
+        czekal = 1;
+        // Limit 1 s tylko na wszelki wypadek – zwykle budzi nas sektor_zmiana()
+        if (futex_czekaj(&sek->pusto_zdarzenie, v, 1000000000LL) == -1 &&
+            errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+            warn_errno("futex_czekaj(sektor)");
+        }
+    }
+    __atomic_store_n(&sek->pusto_czeka, 0, __ATOMIC_SEQ_CST);
+    if (czekal) hist_dodaj(&stan->lat[LAT_SEKTOR_PUSTY], czas_ns() - __atomic_load_n(&sek->t_pusto_ns, __ATOMIC_RELAXED));
+}
+
+/*
+ * Ziarno rand_r()/srand() dla kibica albo roli. Z ziarnem przebiegu (stan->ziarno) zależy tylko
+ * od (rola, id), więc ten sam przebieg z ./main ziarno=N losuje tym samym kibicom te same cechy.
+ */
+enum { ZIARNO_KIBIC, ZIARNO_GENERATOR, ZIARNO_KASJER, ZIARNO_POSREDNIK, ZIARNO_PRZYBYCIA };
+static inline unsigned int ziarno_dla(const SharedState *stan, int rola, unsigned int id) {
+    unsigned int z = stan->ziarno ? stan->ziarno : (unsigned int)(time(NULL) ^ (getpid() << 16));
+    return z ^ ((unsigned int)rola * 0x9E3779B9u) ^ (id * 2654435761u);
+}
+
 /* =========================
  * Komunikaty kolejki
  * =========================
  */
-typedef struct {
-    long mtype;
-    int sektor_id;
-} MsgBilet;
-
 typedef struct {
     long mtype;
     int typ_sygnalu;
     int sektor_id;
 } MsgSterujacy;
 
+/* Zlecenie dla zygoty: utwórz kibica forkiem (bez exec).
+ * kibic_id == -1 oznacza "zakończ zygotę".
+ */
 typedef struct {
     long mtype;
     int kibic_id;
-    /* Ile osób reprezentuje to żądanie przy kasie.
-     *  - zwykły kibic: 1
-     *  - dziecko z opiekunem: 2
-     * (ważne dla długości kolejki, sprzedaży biletów i limitów miejsc)
-     */
-    int grupa;
-} MsgKolejka;
-
-/* Typy wiadomości (vip lub zwykly kibic)*/
-#define MSGTYPE_VIP_REQ 1
-#define MSGTYPE_STD_REQ 2
-#define MSGTYPE_TICKET_BASE 10000
-
-/* ID dla kolegow ktorzy nie pojawili sie w kasie*/
-#define DYN_ID_START 50000
+    int is_vip;
+    int ma_race;
+    int ma_juz_bilet;
+    /* Sektor biletu kolegi (żeby cofnąć sprzedaż gdy fork padnie) albo -1 */
+    int sektor;
+    /* czas_ns() w chwili zlecenia – do pomiaru LAT_START_KIBICA */
+    long long t_zlecenia_ns;
+    /* zamierzony czas przybycia (0 = kolega, nie mierzymy) – do LAT_BILET/LAT_WEJSCIE */
+    long long t_zamiaru_ns;
+} MsgZygota;
+
+#define MSGTYPE_ZYGOTA 1
 
-/* =========================
- * Semafory (System V)
- * =========================
- * MUTEXY:
- *  - SEM_SHM:  ochrona dostępu do SharedState
- *  - SEM_KASY: operacje na kolejkach i aktywności kas
- *  - SEM_SEKTOR_START: mutex per sektor (bramki + agresor)
- *  - SEM_KIEROWNIK: wybór master-kierownika
- *
- * ZDARZENIA:
- *  - SEM_EWAKUACJA: start=1, przy ewakuacji ustawiane na 0.
- *      Kibice czekają semop(op=0) aż semval==0.
- *  - SEM_SEKTOR_BLOCK_START..: start=0 (sektor otwarty).
- *      Pracownik ustawia 1 (blokada) / 0 (odblokowanie),
- *      a kibice czekają semop(op=0) aż będzie 0.
- */
-#define SEM_SHM 0
-#define SEM_KASY 1
-#define SEM_SEKTOR_START 2
-#define SEM_KIEROWNIK (SEM_SEKTOR_START + LICZBA_SEKTOROW)
-
-/* Zdarzenie: ewakuacja (semval==0 => ewakuacja trwa / wszyscy wychodzą)*/
-#define SEM_EWAKUACJA (SEM_KIEROWNIK + 1)
-
-/* Zdarzenia: blokady sektorów (semval==0 => sektor otwarty)*/
-#define SEM_SEKTOR_BLOCK_START (SEM_EWAKUACJA + 1)
-
-/* Łączna liczba semaforów w zestawie*/
-#define N_SEM (SEM_SEKTOR_BLOCK_START + LICZBA_SEKTOROW)
 
 /* =========================
  * Kolory ANSI do logów
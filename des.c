@@ -0,0 +1,586 @@
+#include "reguly.h"
+
+#include <stdint.h>
+
+/*
+ * ==================================
+ * DES: SYMULACJA Z ZEGAREM WIRTUALNYM
+ * ==================================
+ * Ten sam przebieg co wersja procesowa (main + kierownik + kasjer + kibic),
+ * tylko każde usleep()/sleep() jest zdarzeniem w kolejce priorytetowej
+ * (kopiec po czasie wirtualnym w mikrosekundach). Zegar przeskakuje od
+ * zdarzenia do zdarzenia, więc cały mecz liczy się w milisekundach.
+ *
+ * Czasy przepisane z procesów:
+ *  - main.c:     sleep(1) przed generowaniem, kibic co 1000 + rand()%1000 us,
+ *  - kibic:      dziecko usleep(1000) na starcie, bramka 30 ms, ponowienie 10 ms,
+ *                agresor czeka na puste bramki co 5 ms,
+ *  - kasjer.c:   obsługa 10 ms, pusta kolejka 5 ms, kasa wyłączona 10 ms,
+ *  - kierownik:  zegar CZAS_PRZED_MECZEM + CZAS_MECZU sekund, potem ewakuacja;
+ *                co TAKT_KAS_MS jedna decyzja kontrolera kas (autoskaluj_kasy).
+ *
+ * W odróżnieniu od silnika (silnik.c) i procesów (kolejka FIFO w kibic_zycie.c) kibic pod bramką
+ * nie stoi w kolejce, tylko – jak dawniej proces – ponawia próbę co 10 ms i sam liczy "przepuszczonych".
+ * Zasady tłumu i sprzedaży pochodzą z reguly.h.
+ *
+ * Model pomija koszty systemowe (fork/exec, semop, msgsnd) – zdarzenia
+ * o tym samym czasie wykonują się w kolejności zaplanowania.
+ * Opiekun dziecka nie jest osobnym rekordem (jak w kibic_zycie.c): tylko grupa=2.
+ *
+ * Wynik w tym samym formacie co "[MAIN] Statystyki" z ./main, żeby porównać przebiegi.
+ *
+ * Użycie: ./des [K [ziarno]]
+ */
+
+#define US_MS 1000LL
+
+#define T_START_GENERATORA (1000 * US_MS)
+#define T_START_DZIECKA    (1 * US_MS)
+#define T_OBSLUGA          (10 * US_MS)
+#define T_KASA_PUSTA       (5 * US_MS)
+#define T_KASA_WYLACZONA   (10 * US_MS)
+#define T_BRAMKA           (30 * US_MS)
+#define T_PONOWIENIE       (10 * US_MS)
+#define T_AGRESOR_CZEKA    (5 * US_MS)
+
+// main, kierownik, zegar, pośrednik, pracownicy i kasjerzy – też zajmują sloty procesów
+#define PROCESY_STALE (4 + LICZBA_SEKTOROW + LICZBA_KAS)
+
+#define BRAK UINT32_MAX
+#define BEZ_SEKTORA 0xFF
+
+enum {
+    EV_PRZYBYCIE,     // generator w main.c tworzy kolejnego kibica
+    EV_KIBIC_START,   // kibic staje w kolejce do kas
+    EV_KASJER,        // kolejny obrót pętli kasjera
+    EV_SPRZEDAZ,      // koniec obsługi w kasie
+    EV_BILET,         // kibic dostał odpowiedź z kasy
+    EV_BRAMKA_PROBA,  // próba wejścia do bramki
+    EV_BRAMKA_KONIEC, // koniec przejścia przez kontrolę
+    EV_KONIEC_MECZU,  // zegar kierownika doliczył do końca -> ewakuacja
+    EV_KONTROLER_KAS  // takt kontrolera kas w kierowniku (otwórz/zamknij jedną kasę)
+};
+
+#define F_VIP      0x01
+#define F_RACA     0x02
+#define F_DRUZYNA  0x04
+#define F_KOLEGA   0x08
+#define F_KONFLIKT 0x10
+#define F_AGRESOR  0x20 // tryb agresora po przekroczeniu cierpliwości
+#define F_OGLOSZONA 0x40
+
+typedef struct {
+    uint8_t flagi;
+    uint8_t wiek;
+    uint8_t sektor;  // z biletu (BEZ_SEKTORA = odmowa)
+    uint8_t bramka;
+    uint32_t nast;   // następny w kolejce do kas
+    int start_opp;
+} Fan;
+
+typedef struct {
+    long long czas;
+    unsigned long long seq; // kolejność zaplanowania przy równym czasie
+    int typ;
+    uint32_t kto;
+} Zdarzenie;
+
+typedef struct {
+    uint32_t glowa, ogon, n;
+} Lista;
+
+static struct {
+    int k, total, limit_sektor, limit_vip, max_vip, k_10;
+    unsigned int ziarno, ziarno_start;
+
+    Zdarzenie *kopiec;
+    size_t n_zd, poj_zd;
+    unsigned long long seq, obsluzone;
+    long long teraz;
+
+    Fan *fany;
+    uint32_t n_fanow, pojemnosc;
+
+    // Odpowiednik SharedState
+    int procesy;
+    int wygenerowani, vip_cnt, generator_stop;
+    Lista kolejka[2]; // 0 = VIP, 1 = standard (typy msg)
+    int kolejka_vip, kolejka_zwykla;
+    int aktywne_kasy[LICZBA_KAS];
+    uint32_t w_kasie[LICZBA_KAS];
+    int sprzedane_bilety[LICZBA_SEKTOROW + 1];
+    int standard_sold_out, sprzedaz_zakonczona, ewakuacja_trwa;
+    Stanowisko bramki[LICZBA_SEKTOROW][2];
+    int wejscia_kontrola[LICZBA_SEKTOROW][2];
+    uint32_t agresor_sektora[LICZBA_SEKTOROW]; // indeks kibica + 1, 0 = brak
+    int obecni_w_sektorze[LICZBA_SEKTOROW + 1];
+    int cnt_weszlo, cnt_opiekun, cnt_kolega, cnt_agresja;
+    int wyrzuceni, ewakuowani;
+} sim;
+
+/* ===== Kopiec zdarzeń (min po czasie, potem po seq) ===== */
+
+static int wczesniej(const Zdarzenie *a, const Zdarzenie *b) {
+    return a->czas < b->czas || (a->czas == b->czas && a->seq < b->seq);
+}
+
+static void zaplanuj(long long za_us, int typ, uint32_t kto) {
+    if (sim.n_zd == sim.poj_zd) {
+        sim.poj_zd = sim.poj_zd ? sim.poj_zd * 2 : 1024;
+        sim.kopiec = realloc(sim.kopiec, sim.poj_zd * sizeof(Zdarzenie));
+        if (!sim.kopiec) die_errno("realloc(kopiec)");
+    }
+    Zdarzenie z = {sim.teraz + za_us, sim.seq++, typ, kto};
+    size_t i = sim.n_zd++;
+    while (i > 0) {
+        size_t r = (i - 1) / 2;
+        if (!wczesniej(&z, &sim.kopiec[r])) break;
+        sim.kopiec[i] = sim.kopiec[r];
+        i = r;
+    }
+    sim.kopiec[i] = z;
+}
+
+static Zdarzenie zdejmij(void) {
+    Zdarzenie wynik = sim.kopiec[0];
+    Zdarzenie ost = sim.kopiec[--sim.n_zd];
+    size_t i = 0;
+    while (1) {
+        size_t l = 2 * i + 1;
+        if (l >= sim.n_zd) break;
+        if (l + 1 < sim.n_zd && wczesniej(&sim.kopiec[l + 1], &sim.kopiec[l])) l++;
+        if (!wczesniej(&sim.kopiec[l], &ost)) break;
+        sim.kopiec[i] = sim.kopiec[l];
+        i = l;
+    }
+    sim.kopiec[i] = ost;
+    return wynik;
+}
+
+/* ===== Kibice ===== */
+
+static void lista_dodaj(Lista *l, uint32_t f) {
+    sim.fany[f].nast = BRAK;
+    if (l->n == 0) l->glowa = f;
+    else sim.fany[l->ogon].nast = f;
+    l->ogon = f;
+    l->n++;
+}
+
+static uint32_t lista_zdejmij(Lista *l) {
+    if (l->n == 0) return BRAK;
+    uint32_t f = l->glowa;
+    l->glowa = sim.fany[f].nast;
+    l->n--;
+    return f;
+}
+
+static int fan_grupa(const Fan *f) {
+    return reguly_grupa(f->wiek, f->flagi & F_VIP);
+}
+
+static int reserve_slots(int n) {
+    if (sim.procesy + n > MAX_PROC) return 0;
+    sim.procesy += n;
+    return 1;
+}
+
+static void fan_koniec(uint32_t f) {
+    (void)f; // kibic (także para opiekun+dziecko) to jeden proces
+    sim.procesy--;
+}
+
+static uint32_t fan_nowy(int is_vip, int ma_race, int kolega) {
+    uint32_t i = sim.n_fanow++;
+    Fan *f = &sim.fany[i];
+    int wiek, druzyna;
+    reguly_losuj_cechy(kolega, &sim.ziarno, &wiek, &druzyna);
+    f->wiek = (uint8_t)wiek;
+    f->flagi = (is_vip ? F_VIP : 0) | (ma_race ? F_RACA : 0) | (druzyna ? F_DRUZYNA : 0) | (kolega ? F_KOLEGA : 0);
+    f->sektor = BEZ_SEKTORA;
+    f->nast = BRAK;
+    return i;
+}
+
+static void bump_entered(const Fan *f, int grupa) {
+    sim.cnt_weszlo += grupa;
+    if (f->wiek < 15) sim.cnt_opiekun++;
+    if (f->flagi & F_KOLEGA) sim.cnt_kolega++;
+}
+
+/* ===== Generator (main.c) ===== */
+
+static void przybycie(void) {
+    if (sim.ewakuacja_trwa || sim.generator_stop || sim.wygenerowani >= sim.total) return;
+    int i = sim.wygenerowani;
+
+    int is_vip = 0;
+    if (sim.standard_sold_out) {
+        if (sim.vip_cnt >= sim.max_vip) { sim.generator_stop = 1; return; }
+        is_vip = 1;
+        sim.vip_cnt++;
+    } else if (sim.vip_cnt < sim.max_vip) {
+        if ((rand_r(&sim.ziarno) % 1000 < 3) || (sim.total - i <= sim.max_vip - sim.vip_cnt)) {
+            is_vip = 1;
+            sim.vip_cnt++;
+        }
+    }
+    int has_raca = (rand_r(&sim.ziarno) % 1000 < 5) ? 1 : 0;
+
+    if (!reserve_slots(1)) { sim.generator_stop = 1; return; }
+    uint32_t f = fan_nowy(is_vip, has_raca, 0);
+    sim.wygenerowani++;
+
+    // Dziecko czeka 1 ms na starcie (usleep w kibicu)
+    zaplanuj(reguly_dziecko(sim.fany[f].wiek, is_vip) ? T_START_DZIECKA : 0, EV_KIBIC_START, f);
+    zaplanuj(1000 + rand_r(&sim.ziarno) % 1000, EV_PRZYBYCIE, 0);
+}
+
+/* ===== Kibic: start i kolejka do kas ===== */
+
+static void kibic_start(uint32_t f) {
+    Fan *fan = &sim.fany[f];
+    int is_vip = fan->flagi & F_VIP;
+
+    if (sim.ewakuacja_trwa || (!is_vip && sim.standard_sold_out) || sim.sprzedaz_zakonczona) {
+        fan_koniec(f);
+        return;
+    }
+
+    int grupa = fan_grupa(fan);
+    if (is_vip) sim.kolejka_vip += grupa;
+    else sim.kolejka_zwykla += grupa;
+    lista_dodaj(&sim.kolejka[is_vip ? 0 : 1], f);
+}
+
+// cancel_queue(): każde oczekujące żądanie dostaje bilet -1
+static void anuluj_kolejke(int typ) {
+    uint32_t f;
+    while ((f = lista_zdejmij(&sim.kolejka[typ])) != BRAK) {
+        sim.fany[f].sektor = BEZ_SEKTORA;
+        zaplanuj(0, EV_BILET, f);
+    }
+    if (typ == 0) sim.kolejka_vip = 0;
+    else sim.kolejka_zwykla = 0;
+}
+
+static void wyslij_bilet(uint32_t f, int sektor) {
+    sim.fany[f].sektor = (sektor < 0) ? BEZ_SEKTORA : (uint8_t)sektor;
+    zaplanuj(0, EV_BILET, f);
+}
+
+/* ===== Kasjer (kasjer.c) ===== */
+
+static int standard_wyprzedany(void) {
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) if (sim.sprzedane_bilety[s] < sim.limit_sektor) return 0;
+    return 1;
+}
+
+static int wszystko_wyprzedane(void) {
+    return standard_wyprzedany() && sim.sprzedane_bilety[SEKTOR_VIP] >= sim.limit_vip;
+}
+
+static void zakoncz_sprzedaz(void) {
+    for (int i = 0; i < LICZBA_KAS; i++) sim.aktywne_kasy[i] = 0;
+    anuluj_kolejke(0);
+    anuluj_kolejke(1);
+}
+
+static void kasjer_petla(int id) {
+    if (sim.ewakuacja_trwa || sim.sprzedaz_zakonczona) return;
+
+    if (!sim.aktywne_kasy[id]) { zaplanuj(T_KASA_WYLACZONA, EV_KASJER, (uint32_t)id); return; }
+
+    int q_vip = sim.kolejka_vip;
+    int q_std = sim.standard_sold_out ? 0 : sim.kolejka_zwykla;
+
+    /* Priorytet: VIP zawsze pierwszy */
+    uint32_t f = BRAK;
+    if (q_vip > 0) f = lista_zdejmij(&sim.kolejka[0]);
+    if (f != BRAK) {
+        sim.kolejka_vip -= fan_grupa(&sim.fany[f]);
+        if (sim.kolejka_vip < 0) sim.kolejka_vip = 0;
+    } else if (!sim.standard_sold_out && q_std > 0) {
+        f = lista_zdejmij(&sim.kolejka[1]);
+        if (f != BRAK) {
+            sim.kolejka_zwykla -= fan_grupa(&sim.fany[f]);
+            if (sim.kolejka_zwykla < 0) sim.kolejka_zwykla = 0;
+        }
+    }
+
+    if (f == BRAK) { zaplanuj(T_KASA_PUSTA, EV_KASJER, (uint32_t)id); return; }
+
+    sim.w_kasie[id] = f;
+    zaplanuj(T_OBSLUGA, EV_SPRZEDAZ, (uint32_t)id);
+}
+
+/* Kontroler kas (kierownik.c, autoskaluj_kasy): jedna decyzja na takt, zamyka najwyższą kasę o id > 1 */
+static void kontroler_kas(void) {
+    if (sim.ewakuacja_trwa || sim.sprzedaz_zakonczona) return;
+
+    int total_queue = sim.kolejka_vip + (sim.standard_sold_out ? 0 : sim.kolejka_zwykla);
+    int N = 0;
+    for (int i = 0; i < LICZBA_KAS; i++) if (sim.aktywne_kasy[i]) N++;
+
+    if (reguly_otworzyc_kase(N, total_queue, sim.k_10)) {
+        for (int i = 0; i < LICZBA_KAS; i++) {
+            if (!sim.aktywne_kasy[i]) { sim.aktywne_kasy[i] = 1; break; }
+        }
+    } else if (reguly_zamknac_kase(N, total_queue, sim.k_10)) {
+        for (int i = LICZBA_KAS - 1; i > 1; i--) {
+            if (sim.aktywne_kasy[i]) { sim.aktywne_kasy[i] = 0; break; }
+        }
+    }
+    zaplanuj(TAKT_KAS_MS * US_MS, EV_KONTROLER_KAS, 0);
+}
+
+static void sprzedaz(int id) {
+    uint32_t f = sim.w_kasie[id];
+    sim.w_kasie[id] = BRAK;
+    Fan *fan = &sim.fany[f];
+    int grupa = fan_grupa(fan);
+
+    if (fan->flagi & F_VIP) {
+        int sektor = -1;
+        if (sim.sprzedane_bilety[SEKTOR_VIP] + grupa <= sim.limit_vip) {
+            sim.sprzedane_bilety[SEKTOR_VIP] += grupa;
+            sektor = SEKTOR_VIP;
+        }
+        if (wszystko_wyprzedane()) sim.sprzedaz_zakonczona = 1;
+        wyslij_bilet(f, sektor);
+        if (sim.sprzedaz_zakonczona) { zakoncz_sprzedaz(); return; }
+        zaplanuj(0, EV_KASJER, (uint32_t)id);
+        return;
+    }
+
+    int para = (grupa == 2);
+    int ile = 0;
+    // Slot na proces kolegi sprawdzamy bez rezerwacji – rezerwujemy dopiero przy sprzedaży 2 biletów
+    int sektor = reguly_wybierz_sektor(sim.sprzedane_bilety, sim.limit_sektor, para,
+                                       sim.procesy < MAX_PROC, &sim.ziarno, &ile);
+    if (sektor != -1) {
+        sim.sprzedane_bilety[sektor] += ile;
+        if (!sim.standard_sold_out && standard_wyprzedany()) {
+            sim.standard_sold_out = 1;
+            anuluj_kolejke(1);
+        }
+
+        uint32_t kolega = BRAK;
+        if (!para && ile == 2 && reserve_slots(1)) {
+            kolega = fan_nowy(0, 0, 1);
+        } else if (!para && ile == 2) {
+            sim.sprzedane_bilety[sektor]--;
+        }
+
+        wyslij_bilet(f, sektor);
+        if (kolega != BRAK) wyslij_bilet(kolega, sektor);
+        zaplanuj(0, EV_KASJER, (uint32_t)id);
+        return;
+    }
+
+    /* Brak miejsca w żadnym sektorze -> sold out */
+    if (standard_wyprzedany()) sim.standard_sold_out = 1;
+    int koniec = wszystko_wyprzedane();
+    if (koniec) sim.sprzedaz_zakonczona = 1;
+
+    wyslij_bilet(f, -1);
+    if (sim.standard_sold_out) anuluj_kolejke(1);
+    if (koniec) { zakoncz_sprzedaz(); return; }
+
+    sim.aktywne_kasy[id] = 0;
+    zaplanuj(0, EV_KASJER, (uint32_t)id);
+}
+
+/* ===== Kibic: bilet i bramki (kibic_zycie.c) ===== */
+
+static void bilet(uint32_t f) {
+    Fan *fan = &sim.fany[f];
+    if (fan->sektor == BEZ_SEKTORA) { fan_koniec(f); return; }
+
+    if (fan->sektor == SEKTOR_VIP) {
+        // VIP omija bramki i czeka w sektorze na ewakuację
+        bump_entered(fan, 1);
+        sim.obecni_w_sektorze[SEKTOR_VIP]++;
+        return;
+    }
+    zaplanuj(0, EV_BRAMKA_PROBA, f);
+}
+
+static void opusc_kolejke_pod_bramka(uint32_t f) {
+    Fan *fan = &sim.fany[f];
+    if ((fan->flagi & F_AGRESOR) && sim.agresor_sektora[fan->sektor] == f + 1) sim.agresor_sektora[fan->sektor] = 0;
+    fan_koniec(f);
+}
+
+static void wejdz(uint32_t f, int b) {
+    Fan *fan = &sim.fany[f];
+    int s = fan->sektor;
+    int grupa = fan_grupa(fan);
+    int druzyna = (fan->flagi & F_DRUZYNA) ? 1 : 0;
+
+    bump_entered(fan, grupa);
+    sim.bramki[s][b].zajetosc += grupa;
+    sim.bramki[s][b].druzyna = druzyna;
+    sim.wejscia_kontrola[s][druzyna] += grupa;
+    fan->bramka = (uint8_t)b;
+    zaplanuj(T_BRAMKA, EV_BRAMKA_KONIEC, f);
+}
+
+static void bramka_proba(uint32_t f) {
+    Fan *fan = &sim.fany[f];
+    int s = fan->sektor;
+    int druzyna = (fan->flagi & F_DRUZYNA) ? 1 : 0;
+
+    if (sim.ewakuacja_trwa) { opusc_kolejke_pod_bramka(f); return; }
+
+    /* Kontrola na bramkach: kibic z racą wylatuje */
+    if (fan->flagi & F_RACA) {
+        sim.wyrzuceni++;
+        opusc_kolejke_pod_bramka(f);
+        return;
+    }
+
+    if (sim.agresor_sektora[s] != 0 && sim.agresor_sektora[s] != f + 1) {
+        zaplanuj(T_PONOWIENIE, EV_BRAMKA_PROBA, f);
+        return;
+    }
+
+    if (fan->flagi & F_AGRESOR) {
+        if (sim.agresor_sektora[s] == 0) sim.agresor_sektora[s] = f + 1;
+        if (!reguly_bramki_puste(sim.bramki[s])) {
+            zaplanuj(T_AGRESOR_CZEKA, EV_BRAMKA_PROBA, f);
+            return;
+        }
+        wejdz(f, 0);
+        sim.agresor_sektora[s] = 0;
+        return;
+    }
+
+    int powod = 0;
+    int b = reguly_wybierz_bramke(sim.bramki[s], druzyna, fan_grupa(fan), &powod);
+    if (b != -1) {
+        wejdz(f, b);
+        return;
+    }
+
+    if (powod == POWOD_KONFLIKT) {
+        int opp = 1 - druzyna;
+        if (!(fan->flagi & F_KONFLIKT)) {
+            fan->flagi |= F_KONFLIKT;
+            fan->start_opp = sim.wejscia_kontrola[s][opp];
+        }
+        if (reguly_cierpliwosc_wyczerpana(sim.wejscia_kontrola[s][opp] - fan->start_opp)) {
+            if (!(fan->flagi & F_OGLOSZONA)) {
+                sim.cnt_agresja++;
+                fan->flagi |= F_OGLOSZONA;
+            }
+            fan->flagi |= F_AGRESOR;
+        }
+    } else {
+        fan->flagi &= ~F_KONFLIKT;
+    }
+    zaplanuj(T_PONOWIENIE, EV_BRAMKA_PROBA, f);
+}
+
+static void bramka_koniec(uint32_t f) {
+    Fan *fan = &sim.fany[f];
+    Stanowisko *st = &sim.bramki[fan->sektor][fan->bramka];
+    int grupa = fan_grupa(fan);
+    st->zajetosc = (st->zajetosc >= grupa) ? st->zajetosc - grupa : 0;
+
+    if (sim.ewakuacja_trwa) { fan_koniec(f); return; }
+    // W sektorze czekamy na ewakuację (wtedy wszyscy obecni wychodzą naraz)
+    sim.obecni_w_sektorze[fan->sektor] += grupa;
+}
+
+/* ===== Kierownik: koniec meczu ===== */
+
+static void koniec_meczu(void) {
+    sim.ewakuacja_trwa = 1;
+    sim.generator_stop = 1;
+    anuluj_kolejke(0);
+    anuluj_kolejke(1);
+
+    // Pracownicy opróżniają sektory; kibice pod bramkami odpadają przy najbliższej próbie
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) {
+        sim.ewakuowani += sim.obecni_w_sektorze[s];
+        sim.obecni_w_sektorze[s] = 0;
+    }
+}
+
+static void wypisz_wyniki(double sekundy) {
+    printf("[DES] K=%d ziarno=%u | zdarzenia: %llu | czas wirtualny: %.3f s | czas rzeczywisty: %.3f s\n",
+           sim.k, sim.ziarno_start, sim.obsluzone, sim.teraz / 1e6, sekundy);
+    printf("[DES] Statystyki: weszlo=%d opiekun=%d kolega=%d agresja=%d | sprzedane:",
+           sim.cnt_weszlo, sim.cnt_opiekun, sim.cnt_kolega, sim.cnt_agresja);
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) printf(" %d", sim.sprzedane_bilety[s]);
+    printf(" VIP %d\n", sim.sprzedane_bilety[SEKTOR_VIP]);
+    printf("[DES] Kibiców: %d + kolegów %u | wyproszeni (raca): %d | ewakuowani: %d\n",
+           sim.wygenerowani, sim.n_fanow - (uint32_t)sim.wygenerowani, sim.wyrzuceni, sim.ewakuowani);
+}
+
+int main(int argc, char *argv[]) {
+    setbuf(stdout, NULL);
+
+    if (argc > 3) {
+        fprintf(stderr, "Użycie: %s [K [ziarno]]\n", argv[0]);
+        exit(1);
+    }
+    sim.k = (argc > 1) ? atoi(argv[1]) : K;
+    unsigned int ziarno = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : (unsigned int)time(NULL);
+    if (sim.k < 10) {
+        fprintf(stderr, "Błędne K (>= 10)\n");
+        exit(1);
+    }
+
+    // Limity jak w kasjer.c / main.c
+    sim.limit_sektor = sim.k / 8;
+    sim.limit_vip = (int)(sim.k * 0.003);
+    if (sim.limit_vip < 1) sim.limit_vip = 1;
+    sim.max_vip = sim.limit_vip;
+    sim.k_10 = sim.k / 10;
+    sim.total = (int)(sim.k * 0.85);
+    sim.ziarno = sim.ziarno_start = ziarno;
+
+    // Przybyli + co najwyżej jeden kolega na każdy sprzedany bilet
+    sim.pojemnosc = (uint32_t)sim.total + (uint32_t)sim.k;
+    sim.fany = calloc(sim.pojemnosc, sizeof(Fan));
+    if (!sim.fany) die_errno("calloc(fany)");
+
+    sim.procesy = PROCESY_STALE;
+    sim.aktywne_kasy[0] = 1;
+    sim.aktywne_kasy[1] = 1;
+    for (int i = 0; i < LICZBA_KAS; i++) {
+        sim.w_kasie[i] = BRAK;
+        zaplanuj(0, EV_KASJER, (uint32_t)i);
+    }
+    zaplanuj(0, EV_KONTROLER_KAS, 0);
+    zaplanuj(T_START_GENERATORA, EV_PRZYBYCIE, 0);
+    zaplanuj((CZAS_PRZED_MECZEM + CZAS_MECZU) * 1000 * US_MS, EV_KONIEC_MECZU, 0);
+
+    long long t0 = czas_ns();
+    while (sim.n_zd > 0) {
+        Zdarzenie z = zdejmij();
+        sim.teraz = z.czas;
+        sim.obsluzone++;
+
+        switch (z.typ) {
+            case EV_PRZYBYCIE:     przybycie(); break;
+            case EV_KIBIC_START:   kibic_start(z.kto); break;
+            case EV_KASJER:        kasjer_petla((int)z.kto); break;
+            case EV_SPRZEDAZ:      sprzedaz((int)z.kto); break;
+            case EV_BILET:         bilet(z.kto); break;
+            case EV_BRAMKA_PROBA:  bramka_proba(z.kto); break;
+            case EV_BRAMKA_KONIEC: bramka_koniec(z.kto); break;
+            case EV_KONIEC_MECZU:  koniec_meczu(); break;
+            case EV_KONTROLER_KAS: kontroler_kas(); break;
+        }
+    }
+    double sekundy = (czas_ns() - t0) / 1e9;
+
+    wypisz_wyniki(sekundy);
+
+    free(sim.kopiec);
+    free(sim.fany);
+    return 0;
+}
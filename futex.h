@@ -0,0 +1,40 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+/*
+ * Cienkie opakowanie na futex(2) dla słów w pamięci współdzielonej (SharedState).
+ * Bez FUTEX_PRIVATE_FLAG: czekający i budzący to zwykle różne procesy
+ * (kernel rozpoznaje futex po stronie fizycznej, a nie po adresie w procesie).
+ *
+ * Wzorzec użycia: stan zmieniamy __atomic w przestrzeni użytkownika,
+ * a futex_czekaj/futex_obudz wołamy tylko wtedy, gdy ktoś naprawdę śpi.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Śpi, dopóki *adres == oczekiwana (sprawdzane atomowo przez kernel).
+ * timeout_ns <= 0: bez limitu. Zwraca 0 po pobudce, -1 z errno:
+ * EAGAIN (wartość już inna), EINTR (sygnał), ETIMEDOUT.
+ */
+static inline int futex_czekaj(unsigned int *adres, unsigned int oczekiwana, long long timeout_ns) {
+    struct timespec ts, *pts = NULL;
+    if (timeout_ns > 0) {
+        ts.tv_sec = (time_t)(timeout_ns / 1000000000LL);
+        ts.tv_nsec = (long)(timeout_ns % 1000000000LL);
+        pts = &ts;
+    }
+    return (int)syscall(SYS_futex, adres, FUTEX_WAIT, oczekiwana, pts, NULL, 0);
+}
+
+// Budzi do ile czekających na adres (INT_MAX = wszystkich). Zwraca liczbę obudzonych albo -1.
+static inline int futex_obudz(unsigned int *adres, int ile) {
+    return (int)syscall(SYS_futex, adres, FUTEX_WAKE, ile, NULL, NULL, 0);
+}
+
+#endif
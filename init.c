@@ -1,20 +1,23 @@
 #include "common.h"
+#include "pamiec.h"
+#include "transport.h"
 
 /*
  * ======================
  * SETUP: start symulacji
  * ======================
  * ./setup tworzy wszystkie zasoby IPC (System V):
- *  - pamięć współdzieloną (shm): SharedState,
+ *  - SharedState: segment shm albo plik w /dev/shm (pamiec=, duże strony: strony=duze – pamiec.h),
  *  - semafory (sem): mutexy do shm, kas i sektorów,
- *  - kolejkę komunikatów (msg): bilety i komendy.
+ *  - kolejki komunikatów (msg): sterowanie, żądania i bilety backendu sysv, zlecenia zygoty,
+ *  - kolejki POSIX (mq) backendu transportu posix (transport.h) – gdy system na nie pozwala.
  *
  * Dodatkowo resetuje raport.txt i inicjalizuje stan:
  *  - startujemy z 2 aktywnymi kasami (0 i 1),
  *  - next_kibic_id ustawiamy na DYN_ID_START (ID dla „kolegów” z 2 biletów).
  *
  * Ten plik jest odpalany przed main:
- *   ./setup
+ *   ./setup [pamiec=sysv|plik] [strony=duze]
  *   ./main
  */
 
@@ -24,7 +27,20 @@ union semun {
     unsigned short *array;
 };
 
-int main() {
+int main(int argc, char *argv[]) {
+    int pamiec = PAMIEC_SYSV;
+    int duze = 0;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "pamiec=sysv") == 0) pamiec = PAMIEC_SYSV;
+        else if (strcmp(argv[a], "pamiec=plik") == 0) pamiec = PAMIEC_PLIK;
+        else if (strcmp(argv[a], "strony=duze") == 0) duze = 1;
+        else if (strcmp(argv[a], "strony=zwykle") == 0) duze = 0;
+        else {
+            fprintf(stderr, "Użycie: %s [pamiec=sysv|plik] [strony=zwykle|duze]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
     printf("--- SETUP ---\n");
 
 /*
@@ -43,23 +59,17 @@ int main() {
         fclose(rf);
     }
 
-    /* shmget(): tworzy/pobiera segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), IPC_CREAT | 0600);
+    /* Stan poprzedniego przebiegu (na dowolnym nośniku) – usuwamy, żeby role nie trafiły na stary */
+    stan_usun(0);
+
+    /* stan_utworz(): nowy, wyzerowany SharedState na wybranym nośniku (pamiec.h) */
+    SharedState *stan = stan_utworz(pamiec, duze);
     // Kończymy z komunikatem o błędzie
-    if (shmid == -1) die_errno("shmget");
-
-    /* shmat(): podłącza shm do przestrzeni adresowej procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
-    if (stan == (void*)-1) {
-        warn_errno("shmat");
-        /* shmctl(IPC_RMID): usuwa segment shm: sprzątanie po błędzie*/
-        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
-        /* exit(): kończy proces kodem błędu. */
-        exit(EXIT_FAILURE);
-    }
+    if (!stan) die_errno("stan_utworz");
+    printf("[SETUP] Stan: %s, %.1f MB, strony: %s.\n", pamiec_nazwa(stan->pamiec),
+           stan->rozmiar_mapy / 1048576.0, strony_nazwa(stan->strony));
 
-    /* Inicjalizacja stanu symulacji w pamięci współdzielonej*/
-    memset(stan, 0, sizeof(SharedState));
+    /* Inicjalizacja stanu symulacji w pamięci współdzielonej (stan_utworz już go wyzerował) */
     // Zmieniamy globalny licznik utworzonych procesów
     stan->active_proc = 0;
     // Włączamy/wyłączamy konkretne kasy
@@ -74,18 +84,25 @@ int main() {
     stan->cnt_opiekun = 0;
     stan->cnt_kolega = 0;
     stan->cnt_agresja = 0;
+    // Pierścienie żądań do kas: numery sekwencyjne komórek (ring.h)
+    ring_init(&stan->kolejka_vip);
+    ring_init(&stan->kolejka_zwykla);
+    // Kanały sterujące backendu shm (transport.h)
+    for (int c = 0; c < CELE_STEROWANIA; c++) kanal_init(&stan->kanaly[c]);
+    // Mutexy backendu pthread (synchro.h); przy semaforach System V nic nie robi
+    synchro_init(stan);
 
-    /* shmdt(): odłącza shm od procesu*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    /* stan_odlacz(): shmdt() albo munmap() wg nośnika */
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
 
 /*
  * Semafory:
- *  - SEM_SHM (0): wspólne liczniki/flag w SharedState,
- *  - SEM_KASY (1): operacje na kolejkach i aktywności kas,
+ *  - SEM_SPRZEDAZ, SEM_KASY, SEM_SLOTY, SEM_KOLEGI: mutexy dziedzin SharedState (common.h),
  *  - SEM_SEKTOR_START: po jednym na sektor (bramki + agresor),
  *  - SEM_KIEROWNIK: wybór master-kierownika,
  *  - SEM_EWAKUACJA: zdarzenie ewakuacji,
- *  - SEM_SEKTOR_BLOCK_START: semafory blokad sektorow.
+ *  - SEM_SEKTOR_BLOCK_START: semafory blokad sektorow,
+ *  - SEM_POSREDNIK: liczba zleceń kolegów czekających na pośrednika.
  */
 
     /* semget(): tworzy zestaw semaforów*/
@@ -93,8 +110,8 @@ int main() {
     int semid = semget(KEY_SEM, n_sem, IPC_CREAT | 0600);
     if (semid == -1) {
         warn_errno("semget");
-        /* shmctl(IPC_RMID): usuwa segment shm: sprzątanie po błędzie*/
-        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+        /* stan_usun(): usuwa SharedState: sprzątanie po błędzie*/
+        stan_usun(0);
         exit(EXIT_FAILURE);
     }
 
@@ -102,6 +119,7 @@ int main() {
      *  - mutexy startują od 1
      *  - SEM_EWAKUACJA startuje od 1 (czekamy aż spadnie do 0)
      *  - SEM_SEKTOR_BLOCK_START startują od 0 (sektory otwarte)
+     *  - SEM_POSREDNIK startuje od 0 (brak zleceń)
      */
     union semun arg;
     for (int i = 0; i < n_sem; i++) {
@@ -109,41 +127,48 @@ int main() {
         if (i >= SEM_SEKTOR_BLOCK_START && i < SEM_SEKTOR_BLOCK_START + LICZBA_SEKTOROW) {
             v = 0; /* sektory otwarte */
         }
+        if (i == SEM_POSREDNIK) v = 0; /* kolejka kolegów pusta */
         /* SEM_EWAKUACJA = 1 (domyślnie) */
         arg.val = v;
         // Ustawiamy wartość semafora
         if (semctl(semid, i, SETVAL, arg) == -1) {
             warn_errno("semctl(SETVAL)");
-            /* shmctl(IPC_RMID): usuwa segment shm: sprzątanie po błędzie*/
-            if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+            /* stan_usun(): usuwa SharedState: sprzątanie po błędzie*/
+            stan_usun(0);
             /* semctl(IPC_RMID): usunięcie całego zestawu semaforów*/
             if (semctl(semid, 0, IPC_RMID) == -1) warn_errno("semctl(IPC_RMID)");
             exit(EXIT_FAILURE);
         }
     }
 
-    /* msgget(): tworzy/pobiera kolejkę komunikatów*/
-    int msgid = msgget(KEY_MSG, IPC_CREAT | 0600);
-    if (msgid == -1) {
-        warn_errno("msgget(req)");
-        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+    /* Kolejki msg backendu sysv (sterowanie, żądania, bilety) – transport.h */
+    if (transport_utworz_sysv(0) == -1) {
+        warn_errno("msgget(transport)");
+        transport_usun();
+        stan_usun(0);
         if (semctl(semid, 0, IPC_RMID) == -1) warn_errno("semctl(IPC_RMID)");
         exit(EXIT_FAILURE);
     }
 
-    /* Druga kolejka: bilety (odpowiedzi kasjer -> kibic).
-     * Dzięki temu kasjer nie zablokuje się na msgsnd(), gdy kolejka żądań
-     * jest zapchana.
-     */
-    int msgid_ticket = msgget(KEY_MSG_TICKET, IPC_CREAT | 0600);
-    if (msgid_ticket == -1) {
-        warn_errno("msgget(ticket)");
-        if (msgctl(msgid, IPC_RMID, NULL) == -1) warn_errno("msgctl(IPC_RMID)");
-        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+    /* Druga kolejka: zlecenia dla zygoty (tryb ./main zygota). */
+    int msgid_zygota = msgget(KEY_MSG_ZYGOTA, IPC_CREAT | 0600);
+    if (msgid_zygota == -1) {
+        warn_errno("msgget(zygota)");
+        transport_usun();
+        stan_usun(0);
         if (semctl(semid, 0, IPC_RMID) == -1) warn_errno("semctl(IPC_RMID)");
         exit(EXIT_FAILURE);
     }
 
+    /* Kolejki POSIX są opcjonalne: bez nich działa backend shm i sysv, ./main transport=posix odmówi startu */
+    long pojemnosc_mq = transport_utworz_posix(0);
+    if (pojemnosc_mq == -1) {
+        warn_errno("mq_open(transport posix)");
+        printf("[SETUP] Kolejki POSIX niedostępne – transport=posix nie zadziała.\n");
+    } else {
+        printf("[SETUP] Kolejka POSIX żądań do kas: %ld komunikatów.\n", pojemnosc_mq);
+    }
+
     printf("[OK] Zasoby utworzone.\n");
     return 0;
 }
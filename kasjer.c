@@ -1,57 +1,39 @@
 #include "common.h"
-#include <sys/wait.h>
+#include "pamiec.h"
+#include "reguly.h"
+#include "transport.h"
+
+#include <sys/resource.h>
 /*
  * ==========================
  * KASJER: SPRZEDAŻ BILETÓW
  * ==========================
  * Kasjer to proces, który:
- *  - odbiera żądania z kolejki komunikatów (msg): VIP i STANDARD,
- *  - trzyma priorytet VIP (najpierw MSGTYPE_VIP_REQ, potem MSGTYPE_STD_REQ),
- *  - przydziela sektor i aktualizuje liczniki w pamięci współdzielonej (shm),
- *  - dynamicznie otwiera/zamyka kasy w zależności od długości kolejki,
- *  - przy sprzedaży 2 biletów uruchamia dodatkowego kolegę jako osobny proces,
+ *  - zdejmuje żądania z kolejek VIP i STANDARD wybranego transportu (transport.h),
+ *  - trzyma priorytet VIP (transport_odbierz_zadanie oddaje VIP przed standardem),
+ *  - zdejmuje żądania paczkami (./main paczka=N, domyślnie po jednym) i przydziela sektory całej
+ *    paczce w jednej sekcji krytycznej, aktualizując liczniki w pamięci współdzielonej (shm),
+ *  - pracuje tylko, gdy jej kasa jest aktywna – o otwarciu i zamknięciu kas decyduje
+ *    kontroler w master-kierowniku (kierownik.c, autoskaluj_kasy), kasjer tylko czyta aktywne_kasy[id],
+ *  - przy sprzedaży 2 biletów zleca kolegę pośrednikowi (posrednik.c) przez kolejkę
+ *    kolegi[] w shm – sam nie forkuje, od razu wraca do obsługi kolejki,
  *  - obsługuje SOLD OUT: standard_sold_out / sprzedaz_zakonczona oraz czyści kolejki.
  *
  * Synchronizacja:
- *  - SEM_KASY: chroni pola związane z kasami (kolejki, aktywne_kasy),
- *  - SEM_SHM: chroni liczniki sprzedaży i flagi sold out w SharedState.
+ *  - SEM_KASY: chroni zmiany aktywne_kasy (kontroler kas); kasjer bierze go tylko przy końcu
+ *    sprzedaży, żeby zamknąć wszystkie kasy – w zwykłej pętli nie ma go wcale,
+ *  - dzwonek kas (common.h): bez klientów kasjer śpi na futexie zamiast odpytywać kolejki,
+ *    zamknięta kasa śpi na swoim aktywne_kasy[id],
+ *  - SEM_SPRZEDAZ: chroni liczniki sprzedaży i flagi sold out – jedno wejście na paczkę,
+ *  - SEM_KOLEGI: kolejka kolegów do pośrednika (brana wewnątrz SEM_SPRZEDAZ – kolejność z common.h),
+ *  - SEM_POSREDNIK: +1 po każdym zleceniu kolegi (budzi pośrednika).
  *
  * Komunikacja:
- *  - kibic -> kasjer: MsgKolejka o mtype=MSGTYPE_VIP_REQ lub MSGTYPE_STD_REQ,
- *  - kasjer -> kibic: MsgBilet o mtype=MSGTYPE_TICKET_BASE + kibic_id.
+ *  - kibic -> kasjer: (kibic_id, grupa) w kolejce VIP albo standard (shm: pierścienie ring.h),
+ *  - kasjer -> kibic: transport_odpowiedz() (shm i posix: skrzynka stan->skrzynki[kibic_id] z futexem).
  */
 
 
-/*semop(): zmienia wartość semafora*/
-static void sem_op(int semid, int idx, int op) {
-    struct sembuf sb = {(unsigned short)idx, (short)op, 0};
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &sb, 1) == -1) {
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) _exit(0);
-        // Kończymy z komunikatem o błędzie
-        die_errno("semop");
-    }
-}
-
-/*
- * Wysyła bilet do konkretnego kibica.
- * msgsnd(): wysyła wiadomość do kolejki komunikatów.
- */
-static void send_ticket(int msgid_ticket, int kibic_id, int sektor) {
-    MsgBilet msg;
-    msg.mtype = MSGTYPE_TICKET_BASE + kibic_id;
-    msg.sektor_id = sektor;
-
-    // Wysyłamy odpowiedź z biletem (albo odmowę) do konkretnego kibica na kolejkę 'ticket'
-    while (msgsnd(msgid_ticket, &msg, sizeof(int), 0) == -1) {
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) return; // kolejka skasowana
-        warn_errno("msgsnd(send_ticket)");
-        return;
-    }
-}
-
 /* Sprawdza czy standardowe sektory są wyprzedane*/
 static int standard_sold_out(SharedState *stan, int limit_sektor) {
     // Iterujemy po wszystkich sektorach (0..7)
@@ -70,52 +52,152 @@ static int all_sold_out(SharedState *stan, int limit_sektor, int limit_vip) {
     return 1;
 }
 
+/* Jedno żądanie z paczki kasjera i wynik jego sprzedaży */
+typedef struct {
+    int kibic_id;
+    int grupa;        // ile "osób" reprezentuje request (dziecko+opiekun=2)
+    int vip;
+    long long t_wstawienia_ns;
+    int slot;         // zarezerwowany slot procesu na kolegę (zwykły klient standardowy)
+    int sektor;       // wynik: sektor albo -1 (brak miejsc)
+    int ile;          // sprzedane bilety
+    int kolega_id;    // -1 gdy bez kolegi
+} Zadanie;
+
+/* Zdejmuje do max żądań: najpierw VIP, potem standard (o ile nie wyprzedany). Zwraca liczbę żądań. */
+static int zdejmij_paczke(Transport *t, Zadanie *z, int max) {
+    int n = 0;
+    // Sprawdzamy czy standard jest już wyprzedany
+    while (n < max && transport_odbierz_zadanie(t, t->stan->standard_sold_out, &z[n].kibic_id, &z[n].grupa,
+                                                &z[n].vip, &z[n].t_wstawienia_ns)) {
+        n++;
+    }
+    for (int i = 0; i < n; i++) {
+        if (z[i].grupa < 1) z[i].grupa = 1;
+        z[i].slot = 0;
+        z[i].sektor = -1;
+        z[i].ile = 0;
+        z[i].kolega_id = -1;
+    }
+    return n;
+}
+
 /*
- * Uruchamia dodatkowego kibica kolege gdy sprzedano 2 bilety
- * fork(): tworzy nowy proces
+ * Sprzedaż całej paczki w jednej sekcji krytycznej SEM_SPRZEDAZ (+ SEM_KOLEGI, gdy ktoś może
+ * dostać kolegę). Sloty procesów na kolegów rezerwujemy hurtem przed blokadą i oddajemy
+ * niewykorzystane po niej; pośrednika budzimy jednym sem_op na wszystkie zlecenia.
+ * Ustawia flagi sold out (*set_standard, *set_all – to my je zmieniliśmy). Zwraca liczbę biletów.
  */
-// UWAGA: slot na proces kolegi MUSI być już zarezerwowany (reserve_process_slot).
-static int spawn_friend_kibic_reserved(SharedState *stan, int semid, int friend_id) {
-    // Tworzymy proces potomny
-    pid_t pid = fork();
-    if (pid == -1) {
-        // Cofamy rezerwację miejsca na proces
-        rollback_process_slot(stan, semid);
-        warn_errno("fork(spawn_friend_kibic)");
-        return 0;
+static int sprzedaj_paczke(SharedState *stan, int semid, Zadanie *z, int n, int limit_sektor, int limit_vip,
+                           unsigned int *ziarno, int *set_standard, int *set_all) {
+    // Kolegę może dostać tylko zwykły klient standardowy (para opiekun+dziecko ma już drugi proces)
+    int chetni = 0;
+    for (int i = 0; i < n; i++) if (!z[i].vip && z[i].grupa != 2) chetni++;
+    int sloty = chetni ? reserve_process_slots(stan, semid, chetni) : 0; // SEM_SLOTY przed SEM_SPRZEDAZ
+    for (int i = 0, s = sloty; i < n && s > 0; i++) {
+        if (!z[i].vip && z[i].grupa != 2) { z[i].slot = 1; s--; }
     }
-    if (pid == 0) {
-        char idbuf[32], racabuf[8];
-        sprintf(idbuf, "%d", friend_id);
-        /* ~0.5% kibiców ma race (także koledzy) */
-        int has_raca = (rand() % 1000 < 5) ? 1 : 0;
-        sprintf(racabuf, "%d", has_raca);
-        /* args: id, vip=0, has_raca, ma_juz_bilet=1 */
-        execl("./kibic", "kibic", idbuf, "0", racabuf, "1", NULL);
-        die_errno("execl(spawn_friend_kibic)");
+
+    int bilety = 0, koledzy = 0;
+    // Wchodzimy do sekcji krytycznej księgi sprzedaży, żeby nikt nie zmieniał tego samego licznika naraz
+    zablokuj(stan, semid, SEM_SPRZEDAZ);
+    // Kolegów wstawiamy tylko przy zarezerwowanych slotach: wtedy trzymamy też kolejkę (SEM_SPRZEDAZ -> SEM_KOLEGI)
+    if (sloty) zablokuj(stan, semid, SEM_KOLEGI);
+    for (int i = 0; i < n; i++) {
+        if (z[i].vip) {
+            // Odczytujemy liczbę sprzedanych biletów
+            if (stan->sprzedane_bilety[SEKTOR_VIP] + z[i].grupa <= limit_vip) {
+                z[i].sektor = SEKTOR_VIP;
+                z[i].ile = z[i].grupa;
+            }
+        } else {
+            // Dziecko nie może wejść samo (2 albo nic); zwykły klient dostaje 2 tylko ze slotem na kolegę
+            // i z miejscem w kolejce pośrednika.
+            z[i].sektor = reguly_wybierz_sektor(stan->sprzedane_bilety, limit_sektor, z[i].grupa == 2,
+                                                z[i].slot && kolegi_wolne(stan), ziarno, &z[i].ile);
+        }
+        if (z[i].sektor < 0) continue;
+
+        // Zwiększamy licznik sprzedanych biletów dla sektora
+        wersja_zapis_start(&stan->wersja_sprzedazy);
+        stan->sprzedane_bilety[z[i].sektor] += z[i].ile;
+        wersja_zapis_koniec(&stan->wersja_sprzedazy);
+        bilety += z[i].ile;
+
+        /* Przy 2 biletach generujemy ID kolegi tylko dla zwykłego zakupu */
+        if (z[i].slot && z[i].ile == 2) {
+            z[i].kolega_id = __atomic_fetch_add(&stan->next_kibic_id, 1, __ATOMIC_RELAXED);
+            // Zarezerwowany slot przechodzi na pośrednika razem ze zleceniem
+            kolegi_wstaw(stan, z[i].kolega_id, z[i].sektor, czas_ns());
+            koledzy++;
+        }
     }
-    return 1;
+
+    /* Ostatnia możliwa sprzedaż standardu -> sold out; do tego VIP -> koniec sprzedaży */
+    if (!stan->standard_sold_out && standard_sold_out(stan, limit_sektor)) {
+        // Ustawiamy flagę 'standard wyprzedany'
+        stan->standard_sold_out = 1;
+        *set_standard = 1;
+    }
+    if (!stan->sprzedaz_zakonczona && all_sold_out(stan, limit_sektor, limit_vip)) {
+        // Ustawiamy globalny koniec sprzedaży – kasjerzy kończą, a generator kibiców przestaje tworzyć nowe procesy
+        stan->sprzedaz_zakonczona = 1;
+        *set_all = 1;
+    }
+
+    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+    if (sloty) odblokuj(stan, semid, SEM_KOLEGI);
+    odblokuj(stan, semid, SEM_SPRZEDAZ);
+
+    // Nie udało się sprzedać 2 biletów z kolegą -> zwracamy sloty
+    rollback_process_slots(stan, semid, sloty - koledzy);
+    // Budzimy pośrednika: kolegów utworzy i wyśle im bilety już bez nas
+    if (koledzy) sem_op(semid, SEM_POSREDNIK, koledzy);
+    return bilety;
 }
 
 /*
- * Czyści kolejkę danego typu
- * msgrcv(): odbiera wiadomość z kolejki
+ * Raport main: CPU kasjera (także bezczynnego) dopisujemy przyrostami – po paczce i przed uśpieniem,
+ * bo przy końcu meczu przed końcem generowania main pisze metryki zaraz po SIGTERM.
+ * *opublikowane = CPU procesu wliczone już do kasjerzy_cpu_ns.
  */
-static void cancel_queue_type(int msgid_req, int msgid_ticket, long req_type) {
-    MsgKolejka req;
-    while (1) {
-        // Odbieramy wiadomość z kolejki
-        ssize_t r = msgrcv(msgid_req, &req, sizeof(MsgKolejka) - sizeof(long), req_type, IPC_NOWAIT);
-        if (r >= 0) {
-            send_ticket(msgid_ticket, req.kibic_id, -1);
-            continue;
+static void opublikuj_cpu(SharedState *stan, long long *opublikowane) {
+    struct rusage ru;
+    /* getrusage(): CPU użytkownika + systemu całego procesu kasjera */
+    if (getrusage(RUSAGE_SELF, &ru) == -1) {
+        warn_errno("getrusage");
+        return;
+    }
+    long long cpu_ns = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+                       (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+    __atomic_add_fetch(&stan->kasjerzy_cpu_ns, cpu_ns - *opublikowane, __ATOMIC_RELAXED);
+    *opublikowane = cpu_ns;
+}
+
+// Raport main: drzemka kasjera (na dzwonku albo zamkniętej kasie) i czy przerwała ją pobudka
+static void uspienie_do_raportu(SharedState *stan, int pobudka) {
+    __atomic_add_fetch(&stan->kasjerzy_uspienia, 1, __ATOMIC_RELAXED);
+    if (pobudka) __atomic_add_fetch(&stan->kasjerzy_pobudki, 1, __ATOMIC_RELAXED);
+}
+
+/* Bilety paczki dla kibiców (sektor -1 = brak miejsc), każdy po czasie obsługi swojego klienta */
+static void wyslij_bilety(Transport *t, int id, const Zadanie *z, int n, long long t_obslugi) {
+    for (int i = 0; i < n; i++) {
+        if (CZAS_OBSLUGI_US > 0) usleep(CZAS_OBSLUGI_US);
+        if (z[i].sektor < 0) {
+            // Odmowa: bilet -1, kibic rezygnuje
+        } else if (z[i].ile == 2 && z[i].kolega_id != -1) {
+            printf("[KASA %d] Sprzedano 2 bilety do sektora %d (drugi dla kolegi %d).\n", id, z[i].sektor,
+                   z[i].kolega_id);
+        } else if (z[i].ile == 2 && !z[i].vip) {
+            printf("[KASA %d] Sprzedano 2 bilety do sektora %d (opiekun + dziecko).\n", id, z[i].sektor);
+        } else if (!z[i].vip) {
+            printf("[KASA %d] Sprzedano 1 bilet do sektora %d.\n", id, z[i].sektor);
         }
-        if (errno == ENOMSG) break;                 // kolejka pusta
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) break; // kolejka usunięta
-        warn_errno("msgrcv(cancel_queue_type)");
-        break;
+        transport_odpowiedz(t, z[i].kibic_id, z[i].sektor);
+        hist_dodaj(&t->stan->lat[LAT_OBSLUGA_KASY], czas_ns() - t_obslugi);
     }
+    fflush(stdout);
 }
 
 int main(int argc, char *argv[]) {
@@ -132,47 +214,39 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Błąd: id kasy poza zakresem 0..%d\n", LICZBA_KAS - 1);
         exit(EXIT_FAILURE);
     }
-    srand(time(NULL) + id);
-
-    /* signal(): ustawia prostą obsługę sygnału*/
-    if (signal(SIGCHLD, SIG_IGN) == SIG_ERR) warn_errno("signal(SIGCHLD)");
-
-    /* Podpinamy IPC: shm + sem + msg*/
-    /* shmget(): pobiera istniejący segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    // Kończymy z komunikatem o błędzie
-    if (shmid == -1) die_errno("shmget");
 
+    /* Podpinamy IPC: shm + sem + transport*/
     /* semget(): pobiera istniejący zestaw semaforów*/
     int semid = semget(KEY_SEM, 0, 0600);
     // Kończymynz komunikatem o błędzie
     if (semid == -1) die_errno("semget");
 
-    /* msgget(): pobiera kolejkę żądań (kibic -> kasjer) */
-    int msgid_req = msgget(KEY_MSG, 0600);
-    // Kończymy z komunikatem o błędzie
-    if (msgid_req == -1) die_errno("msgget(req)");
-
-    /* msgget(): pobiera kolejkę biletów (kasjer -> kibic) */
-    int msgid_ticket = msgget(KEY_MSG_TICKET, 0600);
-    // Kończymy z komunikatem o błędzie
-    if (msgid_ticket == -1) die_errno("msgget(ticket)");
-
-    /* shmat(): mapuje shm do pamięci procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
     // Kończymy z komunikatem o błędzie
-    if (stan == (void*)-1) die_errno("shmat");
+    if (!stan) die_errno("stan_podlacz");
+    /* Kolejki żądań i bilety wybranego transportu (transport.h) */
+    Transport transport;
+    if (transport_podlacz(&transport, stan) == -1) die_errno("transport_podlacz");
+    rola_gotowa(stan);
+    unsigned int ziarno = ziarno_dla(stan, ZIARNO_KASJER, (unsigned int)id);
 
     /* Limity sprzedaży*/
     int limit_sektor = K / 8;
     int limit_vip = (int)(K * 0.003);
     if (limit_vip < 1) limit_vip = 1;
-    int k_10 = K / 10; // skala do auto-otwierania/zamykania kas
+
+    // Do raportu main: CPU kasjera już dopisane do kasjerzy_cpu_ns (opublikuj_cpu)
+    long long cpu_ns = 0;
+    int po_czuwaniu = 0; // kasjer spał na dzwonku – następne zdjęte żądanie to "pierwsze zadanie"
+    // Rozmiar paczki żądań (./main paczka=N)
+    int rozmiar_paczki = __atomic_load_n(&stan->paczka_kasy, __ATOMIC_RELAXED);
+    if (rozmiar_paczki < 1 || rozmiar_paczki > PACZKA_KASY_MAX) rozmiar_paczki = 1;
 
     /*
      * Pętla pracy kasjera:
      *  - reaguje na kolejkę VIP i standard,
-     *  - dynamicznie otwiera/zamyka kasy zależnie od długości kolejki,
+     *  - śpi, gdy kontroler kas (kierownik) zamknął jej kasę,
      *  - przydziela sektor, ewentualnie tworzy kolegę jeśli kupiono 2 bilety
      */
     while (1) {
@@ -181,173 +255,77 @@ int main(int argc, char *argv[]) {
         // Sprawdzamy czy sprzedaż została już zakończona
         if (stan->sprzedaz_zakonczona) break;
 
-        /* Jeśli ta kasa jest wyłączona, kasjer “śpi" i tylko sprawdza stan*/
-        if (stan->aktywne_kasy[id] == 0) {
-            usleep(10000);
-            continue;
-        }
+        // Dzwonek czytamy przed sprawdzeniem kolejek – kibic, który wstawi żądanie później, zmieni go
+        unsigned int dzwonek = __atomic_load_n(&stan->dzwonek_kas, __ATOMIC_SEQ_CST);
 
-        int klient_typ = 0; // 1=VIP, 2=STD
-        int kibic_id = -1;
-        int grupa_klienta = 1; // ile "osób" reprezentuje request (dziecko+opiekun=2)
-
-/*
- * ==========================================
- * AUTO-OTWIERANIE / AUTO-ZAMYKANIE KAS (SEM_KASY)
- * ==========================================
- * Idea:
- *  - im dłuższa kolejka, tym więcej kas powinno być aktywnych,
- *  - gdy kolejka maleje, nadmiarowe kasy mogą się wyłączać,
- *    ale zostawiamy minimum 2 kasy jako „bazę”.
- *
- * k_10 = K/10 jest skalą ile osób „na jedną kasę”
- */
-
-        /* Sekcja do zarządzania aktywnymi kasami*/
-        // Blokujemy dane kas/kolejek, żeby kasjerzy i kibice nie popsuli liczników kolejki
-        sem_op(semid, SEM_KASY, -1);
-
-        // Sprawdzamy jak długa jest kolejka VIP
-        int q_vip = stan->kolejka_vip;
-        // Sprawdzamy długość kolejki standard
-        int q_std = stan->standard_sold_out ? 0 : stan->kolejka_zwykla;
-        int total_queue = q_vip + q_std;
-
-        int N = 0;
-        // Włączamy/wyłączamy konkretną kasę
-        for (int i = 0; i < LICZBA_KAS; i++) if (stan->aktywne_kasy[i]) N++;
-
-        /* Auto-zamykanie kas: gdy mało ludzi, nadmiarowe kasy się wyłączają*/
-        int prog_zamykania = k_10 * (N - 1);
-        if (N > 2 && total_queue < prog_zamykania) {
-            if (id > 1) {
-                // Wyłączamy konkretną kasę
-                stan->aktywne_kasy[id] = 0;
-                printf(CLR_RED "[KASA %d] ZAMYKAM SIĘ (kolejka=%d, próg=%d)" CLR_RESET "\n",
-                       id, total_queue, prog_zamykania);
-                fflush(stdout);
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, SEM_KASY, 1);
-                continue;
-            }
-        }
-
-        /* Auto-otwieranie kas: gdy kolejka rośnie, włączamy dodatkową kasę*/
-        int wymagane_kasy = (total_queue / k_10) + 1;
-        if (wymagane_kasy > N && N < LICZBA_KAS) {
-            // Przeliczamy ile kas jest aktywnych / szukamy wolnej kasy do otwarcia
-            for (int i = 0; i < LICZBA_KAS; i++) {
-                // Sprawdzamy czy dana kasa jest aktywna
-                if (stan->aktywne_kasy[i] == 0) {
-                    // Włączamy konkretną kasę
-                    stan->aktywne_kasy[i] = 1;
-                    printf(CLR_GREEN "[SYSTEM] OTWIERAM KASĘ %d (kolejka=%d, aktywne=%d->%d)" CLR_RESET "\n",
-                           i, total_queue, N, N + 1);
-                    fflush(stdout);
-                    break;
-                }
-            }
+        /* Jeśli ta kasa jest wyłączona, kasjer śpi do otwarcia (kasa_otworz) albo zmiany stanu*/
+        if (__atomic_load_n(&stan->aktywne_kasy[id], __ATOMIC_SEQ_CST) == 0) {
+            opublikuj_cpu(stan, &cpu_ns);
+            int pobudka = kasa_czekaj_na_otwarcie(stan, id);
+            uspienie_do_raportu(stan, pobudka);
+            // Kasę otwiera długa kolejka – czas w niej to nie opóźnienie pobudki, nie mierzymy
+            po_czuwaniu = 0;
+            continue;
         }
 
-        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-        sem_op(semid, SEM_KASY, 1);
-
-        MsgKolejka req;
-
 /*
  * ==================================
- * PRIORYTET VIP W OBSŁUDZE KOLEJKI MSG
+ * PRIORYTET VIP W OBSŁUDZE KOLEJEK
  * ==================================
- * Najpierw próbujemy zdjąć żądanie VIP (MSGTYPE_VIP_REQ),
- * dopiero jeśli nic nie ma, obsługujemy standard (MSGTYPE_STD_REQ).
+ * Zdejmujemy paczkę do rozmiar_paczki żądań (./main paczka=N): najpierw z kolejki VIP,
+ * resztę ze standardu. Sprzedaż całej paczki to jedna sekcja krytyczna (sprzedaj_paczke),
+ * bilety wysyłamy po niej – każdy po czasie obsługi swojego klienta (CZAS_OBSLUGI_US).
  *
- * Odbieramy IPC_NOWAIT, żeby kasjer:
- *  - nie blokował się na pustej kolejce,
- *  - mógł reagować na zmiany stanu (sprzedaz_zakonczona/ewakuacja),
- *  - mógł wykonywać auto-otwieranie/zamykanie kas.
+ * transport_odbierz_zadanie() nie blokuje. Gdy obie kolejki są puste, kasjer śpi na dzwonku
+ * (kasy_czekaj) z wartością odczytaną na początku iteracji: budzi go nowe żądanie
+ * albo kasy_obudz() przy zmianie stanu (sprzedaz_zakonczona/ewakuacja).
  */
 
-        /* Priorytet: VIP zawsze pierwszy*/
-        if (q_vip > 0) {
-            /* msgrcv(): pobiera żądanie VIP bez blokowania*/
-            ssize_t r = msgrcv(msgid_req, &req, sizeof(MsgKolejka) - sizeof(long), MSGTYPE_VIP_REQ, IPC_NOWAIT);
-            if (r != -1) {
-                klient_typ = 1;
-                kibic_id = req.kibic_id;
-                grupa_klienta = (req.grupa < 1) ? 1 : req.grupa;
-
-                /* Aktualizacja licznika kolejki*/
-                sem_op(semid, SEM_KASY, -1);
-                // Zmniejszamy licznik kolejki VIP
-                if (stan->kolejka_vip >= grupa_klienta) stan->kolejka_vip -= grupa_klienta;
-                else stan->kolejka_vip = 0;
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, SEM_KASY, 1);
-            } else {
-                if (errno != ENOMSG && errno != EINTR && errno != EIDRM && errno != EINVAL)
-                    warn_errno("msgrcv(VIP_REQ)");
-            }
-        }
-
-        // Sprawdzamy czy standard jest już wyprzedany
-        if (!klient_typ && !stan->standard_sold_out && q_std > 0) {
-            /* msgrcv(): pobiera żądanie standard bez blokowania*/
-            ssize_t r = msgrcv(msgid_req, &req, sizeof(MsgKolejka) - sizeof(long), MSGTYPE_STD_REQ, IPC_NOWAIT);
-            if (r != -1) {
-                klient_typ = 2;
-                kibic_id = req.kibic_id;
-                grupa_klienta = (req.grupa < 1) ? 1 : req.grupa;
-
-                // Blokujemy dane kas/kolejek, żeby kasjerzy i kibice nie popsuli liczników kolejki
-                sem_op(semid, SEM_KASY, -1);
-                // Zmniejszamy licznik kolejki standard
-                if (stan->kolejka_zwykla >= grupa_klienta) stan->kolejka_zwykla -= grupa_klienta;
-                else stan->kolejka_zwykla = 0;
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, SEM_KASY, 1);
-            } else {
-                if (errno != ENOMSG && errno != EINTR && errno != EIDRM && errno != EINVAL)
-                    warn_errno("msgrcv(STD_REQ)");
-            }
-        }
+        Zadanie paczka[PACZKA_KASY_MAX];
+        int n = zdejmij_paczke(&transport, paczka, rozmiar_paczki);
 
-        if (!klient_typ) {
-            usleep(5000);
+        if (n == 0) {
+            opublikuj_cpu(stan, &cpu_ns);
+            int pobudka = kasy_czekaj(stan, dzwonek);
+            uspienie_do_raportu(stan, pobudka);
+            po_czuwaniu = 1;
             continue;
         }
 
-        // Sprawdzamy czy trwa ewakuacja
-        if (stan->ewakuacja_trwa) break;
-        // Sprawdzamy czy sprzedaż została już zakończona
-        if (stan->sprzedaz_zakonczona) break;
+        // Pierwsze żądanie po drzemce: ile czekało w kolejce, zanim kasjer się obudził i je zdjął
+        if (po_czuwaniu) hist_dodaj(&stan->lat[LAT_PIERWSZE_ZADANIE], czas_ns() - paczka[0].t_wstawienia_ns);
+        po_czuwaniu = 0;
 
-        usleep(10000);
+        // Zdjęte żądania dostają odmowę – bez tego ich kibice czekaliby do ewakuacji
+        if (stan->ewakuacja_trwa || stan->sprzedaz_zakonczona) {
+            for (int i = 0; i < n; i++) transport_odpowiedz(&transport, paczka[i].kibic_id, -1);
+            break;
+        }
 
-        if (klient_typ == 1) {
-            int sektor = -1;
-            int set_all = 0;
+        // Od zdjęcia paczki do wysłania biletu(ów) – LAT_OBSLUGA_KASY
+        long long t_obslugi = czas_ns();
+        int set_standard = 0, set_all = 0;
+        int bilety = sprzedaj_paczke(stan, semid, paczka, n, limit_sektor, limit_vip, &ziarno,
+                                     &set_standard, &set_all);
 
-            /* Sprzedaż VIP + sprawdzenie sold out. */
-            sem_op(semid, SEM_SHM, -1);
-            // Odczytujemy liczbę sprzedanych biletów
-            int g = (grupa_klienta < 1) ? 1 : grupa_klienta;
-            if (stan->sprzedane_bilety[SEKTOR_VIP] + g <= limit_vip) {
-                // Zwiększamy licznik sprzedanych biletów dla sektora
-                stan->sprzedane_bilety[SEKTOR_VIP] += g;
-                sektor = SEKTOR_VIP;
-            }
-            if (all_sold_out(stan, limit_sektor, limit_vip)) {
-                // Ustawiamy globalny koniec sprzedaży – kasjerzy kończą, a generator kibiców przestaje tworzyć nowe procesy
-                if (!stan->sprzedaz_zakonczona) set_all = 1;
-                stan->sprzedaz_zakonczona = 1;
-            }
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, SEM_SHM, 1);
+        if (set_standard) {
+            printf(CLR_YELLOW "[SYSTEM] STANDARD SOLD OUT - kończymy obsługę zwykłych kas." CLR_RESET "\n");
+            fflush(stdout);
+        }
+        if (set_all) {
+            printf(CLR_YELLOW "[SYSTEM] WSZYSTKIE BILETY WYPRZEDANE - koniec sprzedaży." CLR_RESET "\n");
+            fflush(stdout);
+        }
+
+        wyslij_bilety(&transport, id, paczka, n, t_obslugi);
+        // Raport main: paczki, żądania, bilety, czas pracy nad paczkami – od razu po paczce, bo przy
+        // końcu meczu przed końcem generowania main pisze metryki zaraz po SIGTERM (kasjer nie dojdzie do końca)
+        __atomic_add_fetch(&stan->kasjerzy_paczki, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stan->kasjerzy_zadania, n, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stan->kasjerzy_bilety, bilety, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stan->kasjerzy_praca_ns, czas_ns() - t_obslugi, __ATOMIC_RELAXED);
+        opublikuj_cpu(stan, &cpu_ns);
 
-            if (set_all) {
-                printf(CLR_YELLOW "[SYSTEM] WSZYSTKIE BILETY WYPRZEDANE - koniec sprzedaży." CLR_RESET "\n");
-                fflush(stdout);
-            }
 /*
  * ===========================
  * SOLD OUT i czyszczenie kolejek
@@ -358,211 +336,36 @@ int main(int argc, char *argv[]) {
  *
  * Po zakończeniu sprzedaży:
  *  - wyłączamy wszystkie kasy (aktywne_kasy[]=0),
- *  - zerujemy liczniki kolejek,
- *  - czyścimy kolejkę msg przez cancel_queue_type():
- *    odbieramy każde oczekujące żądanie i odsyłamy bilet -1.
+ *  - czyścimy kolejki przez transport_anuluj():
+ *    zdejmujemy każde oczekujące żądanie i odsyłamy bilet -1.
  *    Dzięki temu kibice nie wiszą w nieskończoność.
  */
-            send_ticket(msgid_ticket, kibic_id, sektor);
-
-            /* Jeśli koniec sprzedaży: wyłączamy kasy i czyścimy kolejki*/
-            if (stan->sprzedaz_zakonczona) {
-                sem_op(semid, SEM_KASY, -1);
-                stan->kolejka_vip = 0;
-                stan->kolejka_zwykla = 0;
-                for (int i = 0; i < LICZBA_KAS; i++) stan->aktywne_kasy[i] = 0;
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, SEM_KASY, 1);
-
-                cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_VIP_REQ);
-                cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_STD_REQ);
-                break;
-            }
-            continue;
-        }
-
-        int sektor = -1;
-        int ile_sprzedane = 1;
-        int friend_id = -1;
-        int friend_slot_reserved = 0;
-        int set_standard_now = 0;
-        int para_opiekun_dziecko = (grupa_klienta == 2);
-
-        /* Wybór sektora: start od losowego indeksu*/
-        int start = rand() % LICZBA_SEKTOROW;
-        // Iterujemy po wszystkich sektorach
-        for (int i = 0; i < LICZBA_SEKTOROW; i++) {
-            int s = (start + i) % LICZBA_SEKTOROW;
-
-            int chciane = para_opiekun_dziecko ? 2 : ((rand() % 2) + 1); // 1 albo 2
-            int reserved = 0;
-
-            // Rezerwujemy slot na proces "kolegi" tylko wtedy, gdy to normalna sprzedaż 2 biletów.
-            // Para opiekun+dziecko już ma drugi proces (opiekuna), więc niczego tu nie tworzymy.
-            if (!para_opiekun_dziecko && chciane == 2) {
-                reserved = reserve_process_slot(stan, semid); // lock SEM_SHM wewnątrz
-            }
-
-            // Wchodzimy do sekcji krytycznej dla SharedState, żeby nikt nie zmieniał tego samego licznika naraz
-            sem_op(semid, SEM_SHM, -1);
-            int free = limit_sektor - stan->sprzedane_bilety[s];
-            int ile = 0;
-
-            if (para_opiekun_dziecko) {
-                // Dziecko nie może wejść samo: sprzedajemy albo 2 bilety, albo nic.
-                if (free >= 2) ile = 2;
-            } else {
-                // Normalny klient: 1 bilet zawsze jeśli jest miejsce, a 2 tylko gdy mamy slot na kolegę i 2 miejsca.
-                if (free >= 1) {
-                    ile = 1;
-                    if (reserved && free >= 2) ile = 2;
-                }
-            }
-
-            if (ile > 0) {
-                // Zwiększamy licznik sprzedanych biletów dla sektora
-                stan->sprzedane_bilety[s] += ile;
-                sektor = s;
-                ile_sprzedane = ile;
-
-                /* Przy 2 biletach generujemy ID kolegi tylko dla zwykłego zakupu */
-                if (!para_opiekun_dziecko && ile == 2) {
-                    friend_id = stan->next_kibic_id++;
-                    friend_slot_reserved = 1; // trzymamy zarezerwowany slot do forka
-                }
-
-                /* Jeśli to była ostatnia możliwa sprzedaż standardu -> sold out*/
-                if (!stan->standard_sold_out && standard_sold_out(stan, limit_sektor)) {
-                    stan->standard_sold_out = 1;
-                    set_standard_now = 1;
-                }
-            }
-
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, SEM_SHM, 1);
-
-            if (!para_opiekun_dziecko && reserved && (ile != 2)) {
-                // Nie udało się sprzedać 2 biletów z kolegą -> zwracamy slot.
-                rollback_process_slot(stan, semid);
-            }
-
-            if (ile > 0) break;
-        }
-
-        if (set_standard_now) {
-            printf(CLR_YELLOW "[SYSTEM] STANDARD SOLD OUT - kończymy obsługę zwykłych kas." CLR_RESET "\n");
-            fflush(stdout);
-
-            sem_op(semid, SEM_KASY, -1);
-            stan->kolejka_zwykla = 0;
-            sem_op(semid, SEM_KASY, 1);
-
-            cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_STD_REQ);
+        if (set_standard) {
+            transport_anuluj(&transport, 0);
         }
 
-        /* Jeśli nie udało się znaleźć miejsca w żadnym sektorze -> sold out*/
-        if (sektor == -1) {
-            int set_standard = 0;
-            int set_all = 0;
-
-            sem_op(semid, SEM_SHM, -1);
-            if (standard_sold_out(stan, limit_sektor)) {
-                if (!stan->standard_sold_out) set_standard = 1;
-                // Ustawiamy flagę 'standard wyprzedany'
-                stan->standard_sold_out = 1;
-            }
-            if (all_sold_out(stan, limit_sektor, limit_vip)) {
-                // Ustawiamy globalny koniec sprzedaży
-                stan->sprzedaz_zakonczona = 1;
-                set_all = 1;
-            }
+        /* Jeśli koniec sprzedaży: wyłączamy kasy i czyścimy kolejki*/
+        if (stan->sprzedaz_zakonczona) {
+            zablokuj(stan, semid, SEM_KASY);
+            wersja_zapis_start(&stan->wersja_kas);
+            for (int i = 0; i < LICZBA_KAS; i++) stan->aktywne_kasy[i] = 0;
+            wersja_zapis_koniec(&stan->wersja_kas);
             // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, SEM_SHM, 1);
+            odblokuj(stan, semid, SEM_KASY);
+            // Pozostali kasjerzy śpią – budzimy ich, żeby zobaczyli koniec sprzedaży
+            kasy_obudz(stan);
 
-            if (set_standard) {
-                printf(CLR_YELLOW "[SYSTEM] STANDARD SOLD OUT - kończymy obsługę zwykłych kas." CLR_RESET "\n");
-                fflush(stdout);
-            }
-            if (set_all) {
-                printf(CLR_YELLOW "[SYSTEM] WSZYSTKIE BILETY WYPRZEDANE - koniec sprzedaży." CLR_RESET "\n");
-                fflush(stdout);
-            }
-
-            send_ticket(msgid_ticket, kibic_id, -1);
-
-            if (set_standard) {
-                sem_op(semid, SEM_KASY, -1);
-                stan->kolejka_zwykla = 0;
-                sem_op(semid, SEM_KASY, 1);
-                cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_STD_REQ);
-            }
-
-            if (set_all) {
-                sem_op(semid, SEM_KASY, -1);
-                stan->kolejka_vip = 0;
-                stan->kolejka_zwykla = 0;
-                for (int i = 0; i < LICZBA_KAS; i++) stan->aktywne_kasy[i] = 0;
-                sem_op(semid, SEM_KASY, 1);
-
-                cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_VIP_REQ);
-                cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_STD_REQ);
-                break;
-            }
-
-            stan->aktywne_kasy[id] = 0;
-            printf(CLR_RED "[KASA %d] SOLD OUT - ZAMYKAM" CLR_RESET "\n", id);
-            fflush(stdout);
-            continue;
-        }
-/*
- * =========================
- * 2 BILETY -> KOLEGA
- * =========================
- * Gdy klient kupuje 2 bilety
- * Tworzymy osobny proces kibica (spawn_friend_kibic), żeby:
- *  - realnie zwiększyć tłok przy bramkach,
- *  - zasilić statystyki i raport,
- *  - mieć spójny model (każdy kibic = proces).
- *
- * friend_id pochodzi ze wspólnego licznika next_kibic_id w shm,
- * żeby nie kolidował z ID kibiców generowanych w main().
- */
-        // Tu dopiero tworzymy kolegę
-        int friend_spawned = 0;
-        if (friend_id != -1 && ile_sprzedane == 2 && friend_slot_reserved) {
-            friend_spawned = spawn_friend_kibic_reserved(stan, semid, friend_id);
-
-            // Jeśli fork padł, cofamy drugi bilet, żeby nie było "biletu-ducha"
-            if (!friend_spawned) {
-                sem_op(semid, SEM_SHM, -1);
-                // Zmniejszamy licznik sprzedanych biletów dla sektora
-                if (stan->sprzedane_bilety[sektor] > 0) stan->sprzedane_bilety[sektor]--;
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, SEM_SHM, 1);
-
-                ile_sprzedane = 1;
-                friend_id = -1;
-            }
-        }
-
-        if (ile_sprzedane == 2) {
-            if (friend_spawned && friend_id != -1) {
-                printf("[KASA %d] Sprzedano 2 bilety do sektora %d (drugi dla kolegi %d).\n", id, sektor, friend_id);
-            } else {
-                printf("[KASA %d] Sprzedano 2 bilety do sektora %d (opiekun + dziecko).\n", id, sektor);
-            }
-        } else {
-            printf("[KASA %d] Sprzedano 1 bilet do sektora %d.\n", id, sektor);
-        }
-        fflush(stdout);
-
-        send_ticket(msgid_ticket, kibic_id, sektor);
-        if (friend_spawned && friend_id != -1) {
-            send_ticket(msgid_ticket, friend_id, sektor);
+            transport_anuluj(&transport, 1);
+            transport_anuluj(&transport, 0);
+            break;
         }
     }
 
-    /* shmdt(): odłącza shm od procesu kasjera*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    // Raport main: reszta CPU od ostatniej paczki/drzemki
+    opublikuj_cpu(stan, &cpu_ns);
+
+    /* stan_odlacz(): odłącza shm od procesu kasjera*/
+    transport_odlacz(&transport);
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
     return 0;
 }
\ No newline at end of file
@@ -1,717 +1,63 @@
-#include "common.h"
-
-#include <fcntl.h>
-#include <sys/file.h>
-#include <sys/wait.h>
-#ifdef __linux__
-#include <sys/prctl.h>
-#endif
+#include "kibic.h"
 
 /*
  * ===================
  * KIBIC
  * ===================
- * Kibic jest osobnym procesem, który przechodzi etapy:
- *  1) (opcjonalnie) ustawienie się w kolejce do kas i wysłanie żądania (msg),
- *  2) odebranie biletu (msg) i zapis do raportu (plik + flock),
- *  3) wejście na stadion:
- *      - VIP: bez bramek,
- *      - standard: przez 2 bramki w sektorze + limit osób + brak mieszania drużyn,
- *  4) siedzenie w sektorze (licznik obecnych w shm),
- *  5) wyjście przy ewakuacji (stan->ewakuacja_trwa).
+ * Kibic jest osobnym procesem (fork+exec z main albo z kasjera dla „kolegi”).
+ * Ten plik tylko:
+ *  - czyta argumenty i losuje wiek/drużynę,
+ *  - podpina IPC (shm/sem i transport komunikatów),
+ *  - wywołuje kibic_zycie() z kibic_zycie.c (cały cykl: kasa, bilet, bramki, sektor, ewakuacja).
  *
- * Kluczowe mechanizmy:
- *  - msg: komunikacja z kasjerami (żądanie i bilet),
- *  - shm: wspólny stan (blokady sektorów, bramki, ewakuacja, statystyki),
- *  - semafory: SEM_KASY dla kolejek, SEM_SEKTOR_* dla bramek, SEM_SHM dla liczników,
- *  - raport.txt: dopisywanie atomowe przez open()+flock()+dprintf().
+ * Ten sam cykl życia działa też bez exec:
+ *  - "./main zygota": proces forkowany przez zygotę (już podpiętą do IPC),
+ *  - "./main watki": wątek w procesie main.
  */
 
-
-// Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami.
-static void sem_op(int semid, int idx, int op) {
-    struct sembuf sb = {(unsigned short)idx, (short)op, 0};
-    while (semop(semid, &sb, 1) == -1) {
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) _exit(0);
-        // Kończymy z komunikatem o błędzie
-        die_errno("semop");
-    }
-}
-
-/*=====================
-* DZIECKO + OPIEKUN
-* =====================
-* Opiekun to osobny proces powiązany z dzieckiem
-*/
-
-typedef struct {
-    int code;
-    int a;
-    int b;
-} PairMsg;
-
-enum {
-    PAIR_KASA   = 1,
-    PAIR_TICKET = 2,
-    PAIR_BRAMKA = 3,
-    PAIR_SEKTOR = 4,
-    PAIR_VIP    = 5,
-    PAIR_END    = 99
-};
-
-static int   pair_on = 0;
-static pid_t pair_pid = -1;
-static int   pair_wfd = -1;
-static int   pair_rfd = -1;
-
-static int write_full(int fd, const void *buf, size_t n) {
-    const char *p = (const char*)buf;
-    while (n) {
-        ssize_t w = write(fd, p, n);
-        if (w > 0) { p += w; n -= (size_t)w; continue; }
-        if (w == -1 && errno == EINTR) continue;
-        return -1;
-    }
-    return 0;
-}
-
-static int read_full(int fd, void *buf, size_t n) {
-    char *p = (char*)buf;
-    size_t got = 0;
-    while (got < n) {
-        ssize_t r = read(fd, p + got, n - got);
-        if (r > 0) { got += (size_t)r; continue; }
-        if (r == 0) return 0; // EOF
-        if (errno == EINTR) continue;
-        return -1;
-    }
-    return 1;
-}
-
-static void guardian_loop(int rfd, int wfd) {
-#ifdef __linux__
-    // Jeśli proces-dziecko zginie (nawet SIGKILL), opiekun ma zniknąć razem z nim.
-    (void)prctl(PR_SET_PDEATHSIG, SIGKILL);
-#endif
-    while (1) {
-        PairMsg m;
-        int rr = read_full(rfd, &m, sizeof(m));
-        if (rr != 1) break;
-
-        // Ack zawsze, żeby dziecko nie utknęło.
-        PairMsg ack = {m.code, 0, 0};
-        if (write_full(wfd, &ack, sizeof(ack)) == -1) break;
-
-        if (m.code == PAIR_BRAMKA) {
-            // Symboliczny "pobyt" w bramce razem z dzieckiem.
-            usleep(3000);
-        }
-        if (m.code == PAIR_END) break;
-    }
-    _exit(0);
-}
-
-static void pair_spawn_if_needed(int is_dziecko, int my_id, SharedState *stan, int semid) {
-    if (!is_dziecko) return;
-
-    int to_guard[2];
-    int from_guard[2];
-    // Kończymy z komunikatem o błędzie
-    if (pipe(to_guard) == -1) die_errno("pipe(to_guard)");
-    // Kończymy z komunikatem o błędzie
-    if (pipe(from_guard) == -1) die_errno("pipe(from_guard)");
-
-    // Sprawdzamy czy wolno jeszcze tworzyć procesy; jeśli nie – zaczynamy wygaszanie symulacji.
-    if (!reserve_process_slot(stan, semid)) {
-        close(to_guard[0]); close(to_guard[1]);
-        close(from_guard[0]); close(from_guard[1]);
-        // Dziecko nie moze wejsc samo: jesli nie da sie utworzyc procesu-opiekuna,
-        // konczymy proces dziecka zanim wejdzie do kasy/bramek.
-        fprintf(stderr, CLR_RED
-                "[DZIECKO %d] Brak miejsca na opiekuna — rezygnuje z wejscia."
-                CLR_RESET "\n", my_id);
-        if (shmdt(stan) == -1) warn_errno("shmdt");
-        _exit(0);
-    }
-
-    // Tworzymy nowy proces potomny
-    pid_t p = fork();
-    if (p == -1) {
-        // Cofamy rezerwację miejsca na proces
-        rollback_process_slot(stan, semid);
-        // Kończymy z komunikatem o błędzie
-        die_errno("fork(opiekun)");
-    }
-
-    if (p == 0) {
-        // opiekun
-        close(to_guard[1]);
-        close(from_guard[0]);
-        guardian_loop(to_guard[0], from_guard[1]);
-        _exit(0);
-    }
-
-    // dziecko
-    close(to_guard[0]);
-    close(from_guard[1]);
-
-    pair_on = 1;
-    pair_pid = p;
-    pair_wfd = to_guard[1];
-    pair_rfd = from_guard[0];
-
-    // Jak opiekun zniknie, dziecko po prostu kończy.
-    if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
-        // nie jest krytyczne
-    }
-}
-
-static void pair_sync_or_die(int code, int a, int b) {
-    if (!pair_on) return;
-    PairMsg m = {code, a, b};
-    if (write_full(pair_wfd, &m, sizeof(m)) == -1) _exit(0);
-    PairMsg ack;
-    int rr = read_full(pair_rfd, &ack, sizeof(ack));
-    if (rr != 1) _exit(0);
-}
-
-static void pair_shutdown(void) {
-    if (!pair_on) return;
-    PairMsg m = {PAIR_END, 0, 0};
-    (void)write_full(pair_wfd, &m, sizeof(m));
-    if (pair_wfd != -1) close(pair_wfd);
-    if (pair_rfd != -1) close(pair_rfd);
-
-    // Sprzątamy po opiekunie, żeby nie robić zombie.
-    if (pair_pid > 0) {
-        while (waitpid(pair_pid, NULL, 0) == -1 && errno == EINTR) {}
-    }
-
-    pair_on = 0;
-    pair_pid = -1;
-    pair_wfd = -1;
-    pair_rfd = -1;
-}
-
-static void pair_kill_guardian(void) {
-    if (!pair_on) return;
-    if (pair_pid > 0) {
-        // Na wypadek wywalenia dziecka SIGKILL w środku bramki.
-        kill(pair_pid, SIGKILL);
-    }
-}
-
-/* Aktualizacja liczby obecnych w sektorze*/
-static void obecni_inc(SharedState *stan, int semid, int sektor, int ile) {
-    // Wchodzimy do sekcji krytycznej dla SharedState, żeby nikt nie zmieniał tego samego licznika naraz
-    sem_op(semid, SEM_SHM, -1);
-    // Zmieniamy licznik osób siedzących w sektorze
-    stan->obecni_w_sektorze[sektor] += ile;
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    sem_op(semid, SEM_SHM, 1);
-}
-
-static void obecni_dec(SharedState *stan, int semid, int sektor, int ile) {
-    sem_op(semid, SEM_SHM, -1);
-    // Zmieniamy licznik osób siedzących w sektorze
-    if (ile < 0) ile = -ile;
-    if (stan->obecni_w_sektorze[sektor] >= ile) stan->obecni_w_sektorze[sektor] -= ile;
-    else stan->obecni_w_sektorze[sektor] = 0;
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    sem_op(semid, SEM_SHM, 1);
-}
-
-static const char* team_color(int druzyna) {
-    return (druzyna == 0) ? CLR_DBLUE : CLR_PURPLE;
-}
-
-static const char* team_name(int druzyna) {
-    return (druzyna == 0) ? "GOSP" : "GOSC";
-}
-
-/*
- * Dopisanie rekordu do raportu:
- *  - typ: vip / opiekun / zwykly
- *  - sektor: docelowy sektor (0..7 albo VIP)
- */
-static void append_report(int kibic_id, int wiek, int sektor, int grupa) {
-    const char *typ = (sektor == SEKTOR_VIP) ? "vip" : ((wiek < 15) ? "opiekun z dzieckiem" : "zwykly");
-
-    /* open(): otwiera plik raportu do dopisywania*/
-    int fd = open("raport.txt", O_WRONLY | O_CREAT | O_APPEND, 0644);
-    if (fd == -1) { warn_errno("open(raport.txt)"); return; }
-
-    /* Blokada pliku, żeby wpisy z wielu procesów się nie mieszały*/
-    if (flock(fd, LOCK_EX) == -1) {
-        warn_errno("flock(LOCK_EX)");
-        /* close(): zamyka deskryptor pliku*/
-        if (close(fd) == -1) warn_errno("close(raport.txt)");
-        return;
-    }
-
-    /* Dopisanie linijki/linijek (id typ sektor)*/
-    if (dprintf(fd, "%d %s %d\n", kibic_id, typ, sektor) < 0) {
-        warn_errno("dprintf(raport.txt)");
-    }
-
-    /* Para (opiekun + dziecko) ma mieć 2 wpisy w raporcie, bo to 2 osoby.
-     * Opiekun dostaje „sztuczne” ID, żeby nie dublować numeru dziecka.
-     */
-    if (grupa == 2 && wiek < 15 && sektor != SEKTOR_VIP) {
-        const int opiekun_id = 200000 + kibic_id;
-        if (dprintf(fd, "%d %s %d\n", opiekun_id, typ, sektor) < 0) {
-            warn_errno("dprintf(raport.txt)");
-        }
-    }
-
-    if (flock(fd, LOCK_UN) == -1) warn_errno("flock(LOCK_UN)");
-    /* close(): zamyka deskryptor pliku*/
-    if (close(fd) == -1) warn_errno("close(raport.txt)");
-}
-
-/* Statystyki kto wszedł*/
-static void bump_entered(SharedState *stan, int semid, int wiek, int is_kolega, int grupa) {
-    // Wchodzimy do sekcji krytycznej dla SharedState, żeby nikt nie zmieniał tego samego licznika naraz
-    sem_op(semid, SEM_SHM, -1);
-    if (grupa < 1) grupa = 1;
-    stan->cnt_weszlo += grupa;
-    if (wiek < 15) stan->cnt_opiekun++;
-    if (is_kolega) stan->cnt_kolega++;
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    sem_op(semid, SEM_SHM, 1);
-}
-
-/* Statystyka agresji*/
-static void bump_agresja(SharedState *stan, int semid) {
-    // Wchodzimy do sekcji krytycznej dla SharedState, żeby nikt nie zmieniał tego samego licznika naraz
-    sem_op(semid, SEM_SHM, -1);
-    stan->cnt_agresja++;
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    sem_op(semid, SEM_SHM, 1);
-}
-
-/*Wyproszenie kibica z racą*/
-static void expel_for_flare(SharedState *stan, int semid, int sem_sektora, int sektor, int my_id) {
-    printf(CLR_RED "[KONTROLA] WYKRYTO KIBICA %d Z RACĄ (SEKTOR %d) — WYPROSZONY!" CLR_RESET "\n",
-           my_id, sektor);
-    fflush(stdout);
-
-    if (sektor >= 0 && sektor < LICZBA_SEKTOROW) {
-        // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
-        if (stan->agresor_sektora[sektor] == my_id) stan->agresor_sektora[sektor] = 0;
-    }
-
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    if (sem_sektora >= 0) sem_op(semid, sem_sektora, 1);
-
-    if (shmdt(stan) == -1) warn_errno("shmdt");
-
-    // Dziecko nie wychodzi samo — opiekun też znika.
-    pair_kill_guardian();
-    kill(getpid(), SIGKILL);
-    _exit(137);
-}
-
 int main(int argc, char *argv[]) {
     setbuf(stdout, NULL);
 
-    if (argc != 4 && argc != 5) {
-        fprintf(stderr, "Użycie: %s <id> <vip> <ma_race> [ma_juz_bilet]\n", argv[0]);
+    if (argc < 4 || argc > 7) {
+        fprintf(stderr, "Użycie: %s <id> <vip> <ma_race> [ma_juz_bilet [t_zlecenia_ns [t_zamiaru_ns]]]\n", argv[0]);
         /* exit(): kończy proces*/
         exit(1);
     }
 
+    KibicParametry p;
+    memset(&p, 0, sizeof(p));
     // Przypisujemy kibicowi jego ID z argumentów – to ID jest używane w logach i jako adres na odpowiedź z biletem
-    int my_id = atoi(argv[1]);
+    p.id = atoi(argv[1]);
     // Ustawiamy czy ten kibic jest VIP (osobna kolejka do kas i wejście bez standardowych bramek)
-    int is_vip = atoi(argv[2]);
+    p.is_vip = atoi(argv[2]);
     // Ustawiamy czy kibic ma racę – na kontroli może zostać wyrzucony z wejścia
-    int ma_race = atoi(argv[3]);
+    p.ma_race = atoi(argv[3]);
     // Ustawiamy czy kibic startuje z gotowym biletem (kolega z drugiego biletu omija kasy)
-    int ma_juz_bilet = (argc == 5) ? atoi(argv[4]) : 0;
+    p.ma_juz_bilet = (argc >= 5) ? atoi(argv[4]) : 0;
+    // Chwila zlecenia utworzenia (czas_ns() rodzica) – do pomiaru kosztu startu
+    p.t_zlecenia_ns = (argc >= 6) ? atoll(argv[5]) : 0;
+    // Zamierzony czas przybycia z generatora – od niego liczymy czas do biletu i do wejścia
+    p.t_zamiaru_ns = (argc == 7) ? atoll(argv[6]) : 0;
 
-    /* Losowanie wieku i drużyny*/
-    srand(time(NULL) ^ (getpid() << 16));
-    // Losujemy wiek kibica (dziecko < 15 oznacza wejście razem z opiekunem)
-    int wiek = 10 + rand() % 60;
-    // "Koledzy" z 2 biletów (ma_juz_bilet=1) nie powinni być dziećmi, bo nie pojawiają się w kasie.
-    if (ma_juz_bilet && wiek < 15) {
-        wiek = 18 + rand() % 42;
-    }
-    // Losujemy drużynę kibica (0=GOSP, 1=GOSC) – na bramkach nie wolno mieszać drużyn
-    int druzyna = rand() % 2;
-
-    /* shmget(): pobiera segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    if (shmid == -1) { warn_errno("shmget"); exit(EXIT_FAILURE); }
+    KibicIpc ipc;
 
     /* semget(): pobiera zestaw semaforów*/
-    int semid = semget(KEY_SEM, 0, 0600);
-    if (semid == -1) { warn_errno("semget"); exit(EXIT_FAILURE); }
-
-    /* Kolejka żądań (kibic -> kasjer) */
-    int msgid_req = msgget(KEY_MSG, 0600);
-    if (msgid_req == -1) { warn_errno("msgget(req)"); exit(EXIT_FAILURE); }
-
-    /* Kolejka biletów (kasjer -> kibic). Rozdzielenie request/response
-     * zapobiega zakleszczeniu, gdy kolejka żądań jest zapchana.
-     */
-    int msgid_ticket = msgget(KEY_MSG_TICKET, 0600);
-    if (msgid_ticket == -1) { warn_errno("msgget(ticket)"); exit(EXIT_FAILURE); }
+    ipc.semid = semget(KEY_SEM, 0, 0600);
+    if (ipc.semid == -1) { warn_errno("semget"); exit(EXIT_FAILURE); }
 
-    /* shmat(): mapuje shm do pamięci procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    ipc.stan = stan_podlacz();
     // Kończymy z komunikatem o błędzie
-    if (stan == (void*)-1) die_errno("shmat");
-
-    if (wiek < 15 && !is_vip) usleep(1000);
-    if (stan->ewakuacja_trwa) { if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-    if (!ma_juz_bilet && !is_vip && stan->standard_sold_out) { if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-    if (!ma_juz_bilet && stan->sprzedaz_zakonczona) { if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-
-    // Dziecko nie porusza się bez opiekuna: uruchamiamy opiekuna jako proces-cień.
-    int is_dziecko = (wiek < 15 && !is_vip);
-    // Ile "fizycznych osób" reprezentuje ten proces w modelu tłumu.
-    // Dziecko zawsze wchodzi z opiekunem => zajmują 2 miejsca.
-    int grupa = is_dziecko ? 2 : 1;
-    pair_spawn_if_needed(is_dziecko, my_id, stan, semid);
-
-/*
- * =======================================
- * KOLEJKA DO KAS: shm + msg (SEM_KASY)
- * =======================================
- *  - Najpierw zwiększamy licznik kolejki w shm (kolejka_vip lub kolejka_zwykla).
- *    Robimy to pod SEM_KASY, bo ten licznik jest współdzielony z kasjerami.
- *  - Potem wysyłamy MsgKolejka na kolejkę msg:
- *      mtype = MSGTYPE_VIP_REQ albo MSGTYPE_STD_REQ,
- *      kibic_id = my_id.
- *
- * Kasjer odbiera te żądania i odsyła MsgBilet na typ:
- *  MSGTYPE_TICKET_BASE + my_id (unikalne „kanały” odpowiedzi per kibic).
- */
-
-    /*Jeśli nie ma biletu: dołącza do kolejki i wysyła request do kasjera*/
-    if (!ma_juz_bilet) {
-        // Synchronizacja wejścia do kasy (kolejka + kupno biletu).
-        pair_sync_or_die(PAIR_KASA, 0, 0);
-
-        // Blokujemy dane kas/kolejek, żeby kasjerzy i kibice nie popsuli liczników kolejki
-        sem_op(semid, SEM_KASY, -1);
-        // Zwiększamy/zmniejszamy licznik kolejki VIP (ile osób aktualnie czeka na obsługę VIP)
-        if (is_vip) stan->kolejka_vip += grupa;
-        // Zwiększamy/zmniejszamy licznik kolejki standard (ile osób stoi do zwykłych kas)
-        else stan->kolejka_zwykla += grupa;
-        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-        sem_op(semid, SEM_KASY, 1);
-
-        MsgKolejka req;
-        req.mtype = is_vip ? MSGTYPE_VIP_REQ : MSGTYPE_STD_REQ;
-        req.kibic_id = my_id;
-        req.grupa = grupa;
-
-        /* msgsnd(): wysyła żądanie do kolejki komunikatów*/
-        while (msgsnd(msgid_req, &req, sizeof(MsgKolejka) - sizeof(long), 0) == -1) {
-            if (errno == EINTR) continue;
-            if (errno == EIDRM || errno == EINVAL) { pair_shutdown(); if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-            warn_errno("msgsnd(kolejka)");
-            pair_shutdown();
-            if (shmdt(stan) == -1) warn_errno("shmdt");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    /*Oczekiwanie na bilet*/
-    MsgBilet bilet;
-    while (1) {
-        long my_ticket_type = MSGTYPE_TICKET_BASE + my_id;
-
-        /* msgrcv(): odbiera odpowiedź-bilet z kolejki*/
-        ssize_t r = msgrcv(msgid_ticket, &bilet, sizeof(int), my_ticket_type, 0);
-        if (r >= 0) break;
-
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) { pair_shutdown(); if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-
-        warn_errno("msgrcv(ticket)");
-        pair_shutdown();
-        if (shmdt(stan) == -1) warn_errno("shmdt");
-        exit(EXIT_FAILURE);
-    }
-
-    if (bilet.sektor_id == -1) { pair_shutdown(); if (shmdt(stan) == -1) warn_errno("shmdt"); exit(0); }
-
-    int sektor = bilet.sektor_id;
-
-    // Synchronizacja: razem z opiekunem opuszczamy kasę i idziemy dalej.
-    pair_sync_or_die(PAIR_TICKET, sektor, 0);
-
-/*
- * ==========================
- * RAPORT
- * ==========================
- * Każdy kibic dopisuje jedną linię: "id typ sektor".
- * Ponieważ działa wiele procesów naraz, używamy:
- *  - open(..., O_APPEND) żeby system dopisywał na koniec,
- *  - flock(LOCK_EX) żeby nie przeplatać wpisów.
- */
-    append_report(my_id, wiek, sektor, grupa);
-    const int is_kolega = (my_id >= DYN_ID_START);
-
-/*
- * ==========
- * ŚCIEŻKA VIP
- * ==========
- * VIP omija bramki (osobne wejście), nie przechodzi kontroli bezpieczeństwa.
- */
-
-    if (sektor == SEKTOR_VIP) {
-        bump_entered(stan, semid, wiek, is_kolega, 1);
-        printf(CLR_YELLOW "[VIP %d] WEJŚCIE VIP" CLR_RESET "\n", my_id);
-        fflush(stdout);
-
-        obecni_inc(stan, semid, SEKTOR_VIP, 1);
-        // Czekamy na ewakuację/koniec – ten semafor staje się 0, gdy kierownik ogłosi ewakuację
-        sem_op(semid, SEM_EWAKUACJA, 0);
-        obecni_dec(stan, semid, SEKTOR_VIP, 1);
-
-        pair_shutdown();
-        if (shmdt(stan) == -1) warn_errno("shmdt");
-        exit(0);
-    }
-
-/*
- * ===================
- * ŚCIEŻKA STANDARD
- * ===================
- * Wejście przez bramki sektora:
- *  - sektor ma 2 bramki (Stanowisko[2]),
- *  - każda bramka ma limit MAX_NA_STANOWISKU (tu: 3),
- *  - nie mieszamy drużyn w tej samej bramce:
- *      jeśli bramka jest zajęta i druzyna != moja -> nie wchodzę.
- *
- * Synchronizacja:
- *  - SEM_SEKTOR_START + sektor chroni bramki[sektor][*] oraz agresor_sektora[sektor].
- *  - blokada_sektora[sektor] może być ustawiona komendami 1/2 od kierownika
- *    (pracownik sektora aktualizuje to w shm).
- */
+    if (!ipc.stan) die_errno("stan_podlacz");
 
-    int sem_sektora = SEM_SEKTOR_START + sektor;
-    int wszedl_do_sektora = 0;
+    /* Transport żądań i biletów wybrany przez main (transport.h) */
+    Transport transport;
+    if (transport_podlacz(&transport, ipc.stan) == -1) die_errno("transport_podlacz");
+    ipc.transport = &transport;
 
-    /*
-     * Liczenie "przepuszczonych":
-     * dopiero gdy blokuje nas inna drużyna (konflikt w bramkach), zaczynamy liczyć
-     * ilu kibiców przeciwnej drużyny weszło na kontrolę przed nami.
-     */
-    
-    int konflikt_trwa = 0;
-    int start_opp_wejscia = 0;
+    /* Losowanie wieku i drużyny – z ziarna przebiegu i id kibica (ziarno_dla) */
+    unsigned int ziarno = ziarno_dla(ipc.stan, ZIARNO_KIBIC, (unsigned int)p.id);
+    kibic_losuj_cechy(&p, &ziarno);
 
-    int tryb_agresora = 0;     /* po przekroczeniu cierpliwości */
-    int agresja_ogloszona = 0;
-
-    while (1) {
-        // Sprawdzamy czy trwa ewakuacja (wtedy przerywamy normalne działania i kończymy pętle)
-        if (stan->ewakuacja_trwa) break;
-
-        // Czekamy aż sektor będzie odblokowany (semafor blokady = 0 oznacza 'można wchodzić')
-        sem_op(semid, SEM_SEKTOR_BLOCK_START + sektor, 0);
-        // Sprawdzamy czy trwa ewakuacja (wtedy przerywamy normalne działania i kończymy pętle)
-        if (stan->ewakuacja_trwa) break;
-
-        /* Semafor sektora: chroni stan bramek + agresor_sektora */
-        sem_op(semid, sem_sektora, -1);
-
-        /* Kontrola na bramkach: kibic z racą wylatuje*/
-        if (ma_race) {
-            expel_for_flare(stan, semid, sem_sektora, sektor, my_id);
-        }
-        // Sprawdzamy czy ktoś ma priorytet agresora (jeśli tak i to nie my, czekamy).
-        if (stan->agresor_sektora[sektor] != 0 && stan->agresor_sektora[sektor] != my_id) {
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, sem_sektora, 1);
-            usleep(10000);
-            continue;
-        }
-
-        /* Tryb agresora: rezerwujemy sektor, czekamy aż bramki puste i wchodzimy */
-        if (tryb_agresora) {
-            // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
-            if (stan->agresor_sektora[sektor] == 0) stan->agresor_sektora[sektor] = my_id;
-
-            // Sprawdzamy czy ktoś ma priorytet agresora (jeśli tak i to nie my, czekamy)
-            if (stan->agresor_sektora[sektor] != my_id) {
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, sem_sektora, 1);
-                usleep(10000);
-                continue;
-            }
-
-            // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
-            int empty0 = (stan->bramki[sektor][0].zajetosc == 0);
-            int empty1 = (stan->bramki[sektor][1].zajetosc == 0);
-
-            if (!(empty0 && empty1)) {
-                // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-                sem_op(semid, sem_sektora, 1);
-                usleep(5000);
-                continue;
-            }
-
-            /* bramki są puste => wchodzimy jako pierwsi */
-            bump_entered(stan, semid, wiek, is_kolega, grupa);
-
-            // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
-            stan->bramki[sektor][0].zajetosc += grupa;
-            stan->bramki[sektor][0].druzyna = druzyna;
-            // Dopisz kolejne przejście przez kontrolę (na tym liczymy 'cierpliwość' i moment agresji)
-            stan->wejscia_kontrola[sektor][druzyna] += grupa;
-
-            // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
-            stan->agresor_sektora[sektor] = 0; /* odblokuj wejście kolejnym */
-
-            const char *tc = team_color(druzyna);
-            const char *tn = team_name(druzyna);
-            printf(CLR_RED "[AGRESOR %d] PRIORYTET! WCHODZI do bramki w sektorze %d: %s%s%s. Stan: %d/3" CLR_RESET "\n",
-                   my_id, sektor, tc, tn, CLR_RESET,
-                   // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
-                   stan->bramki[sektor][0].zajetosc);
-            fflush(stdout);
-
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, sem_sektora, 1);
-
-            // Dziecko nie może być na bramce samo.
-            pair_sync_or_die(PAIR_BRAMKA, sektor, 0);
-            usleep(30000);
-
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, sem_sektora, -1);
-            // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
-            if (stan->bramki[sektor][0].zajetosc >= grupa) stan->bramki[sektor][0].zajetosc -= grupa;
-            else stan->bramki[sektor][0].zajetosc = 0;
-            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-            sem_op(semid, sem_sektora, 1);
-
-            // Ogłaszamy ewakuację
-            if (!stan->ewakuacja_trwa) wszedl_do_sektora = 1;
-            break;
-        }
-
-        int wybrane = -1;
-        int powod = 0; // 1=konflikt drużyny, 2=pełno
-
-        /* Szukamy bramki: albo pusta, albo zajęta przez naszą drużynę*/
-        for (int i = 0; i < 2; i++) {
-            // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
-            int n = stan->bramki[sektor][i].zajetosc;
-            int d = stan->bramki[sektor][i].druzyna;
-
-            if (n + grupa <= MAX_NA_STANOWISKU) {
-                if (n == 0 || d == druzyna) { wybrane = i; break; }
-                else powod = 1;
-            } else {
-                if (powod == 0) powod = 2;
-            }
-        }
-
-        if (wybrane != -1) {
-            /* Udane wejście do bramki = liczymy jako wszedł w statystykach*/
-            bump_entered(stan, semid, wiek, is_kolega, grupa);
-
-            // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
-            stan->bramki[sektor][wybrane].zajetosc += grupa;
-            stan->bramki[sektor][wybrane].druzyna = druzyna;
-            stan->wejscia_kontrola[sektor][druzyna] += grupa;
-
-            const char *tc = team_color(druzyna);
-            const char *tn = team_name(druzyna);
-
-            if (wiek < 15) {
-                printf("[SEKTOR %d|ST %d] Wchodzi %s%s%s %s(OPIEKUN + DZIECKO)%s. Stan: %d/3\n",
-                       sektor, wybrane,
-                       tc, tn, CLR_RESET,
-                       CLR_LBLUE, CLR_RESET,
-                       // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
-                       stan->bramki[sektor][wybrane].zajetosc);
-            } else {
-                printf("[SEKTOR %d|ST %d] Wchodzi %s%s%s. Stan: %d/3\n",
-                       sektor, wybrane,
-                       tc, tn, CLR_RESET,
-                       stan->bramki[sektor][wybrane].zajetosc);
-            }
-            fflush(stdout);
-
-            /* Zwolnienie semafora*/
-            sem_op(semid, sem_sektora, 1);
-
-            // Dziecko nie może być na bramce samo.
-            pair_sync_or_die(PAIR_BRAMKA, sektor, wybrane);
-            usleep(30000);
-
-            /* Aktualizacja bramki po przejściu*/
-            sem_op(semid, sem_sektora, -1);
-            if (stan->bramki[sektor][wybrane].zajetosc >= grupa) stan->bramki[sektor][wybrane].zajetosc -= grupa;
-            else stan->bramki[sektor][wybrane].zajetosc = 0;
-            sem_op(semid, sem_sektora, 1);
-
-            if (!stan->ewakuacja_trwa) wszedl_do_sektora = 1;
-            break;
-        }
-
-        /*
-         * Nie udało się wejść:
-         *  - jeśli powodem jest konflikt drużyny, liczymy "przepuszczonych" jako
-         *    wejścia przeciwnej drużyny na kontrolę od momentu konfliktu.
-         */
-        if (powod == 1) {
-            int opp = 1 - druzyna;
-            if (!konflikt_trwa) {
-                konflikt_trwa = 1;
-                // Odczytujemy licznik wejść na kontrolę (żeby policzyć ilu 'wrogów' nas wyprzedziło)
-                start_opp_wejscia = stan->wejscia_kontrola[sektor][opp];
-            }
-
-            int przepuszczone = stan->wejscia_kontrola[sektor][opp] - start_opp_wejscia;
-            if (przepuszczone >= LIMIT_CIERPLIWOSCI) {
-                if (!agresja_ogloszona) {
-                    bump_agresja(stan, semid);
-                    printf(CLR_RED "[AGRESJA] KIBIC %d (DR %d) POD SEKTOREM %d — PRZEPUŚCIŁ %d WROGÓW, BIERZE PRIORYTET!" CLR_RESET "\n",
-                           my_id, druzyna, sektor, przepuszczone);
-                    fflush(stdout);
-                    agresja_ogloszona = 1;
-                }
-                tryb_agresora = 1;
-            }
-        } else {
-            konflikt_trwa = 0;
-        }
-
-        /* puść mutex sektora dopiero po obliczeniach */
-        sem_op(semid, sem_sektora, 1);
-        usleep(10000);
-    }
-
-    if (tryb_agresora) {
-        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-        sem_op(semid, sem_sektora, -1);
-        if (stan->agresor_sektora[sektor] == my_id) stan->agresor_sektora[sektor] = 0;
-        sem_op(semid, sem_sektora, 1);
-    }
-
-    if (wszedl_do_sektora) {
-        // Razem z opiekunem w sektorze.
-        pair_sync_or_die(PAIR_SEKTOR, sektor, 0);
-        obecni_inc(stan, semid, sektor, grupa);
-        // Czekamy na ewakuację/koniec – ten semafor staje się 0, gdy kierownik ogłosi ewakuację
-        sem_op(semid, SEM_EWAKUACJA, 0);
-        obecni_dec(stan, semid, sektor, grupa);
-    }
-
-    pair_shutdown();
-
-    /* shmdt(): odłącza shm od procesu*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
-    return 0;
-}
\ No newline at end of file
+    kibic_proces_koniec(&ipc, kibic_zycie(&p, &ipc));
+}
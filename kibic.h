@@ -0,0 +1,48 @@
+#ifndef KIBIC_H
+#define KIBIC_H
+
+/*
+ * Interfejs cyklu życia kibica (kibic_zycie.c).
+ * Używany przez:
+ *  - ./kibic: jeden kibic = jeden proces (fork+exec z main/kasjera),
+ *  - ./main zygota: jeden kibic = proces forkowany przez zygotę (bez exec),
+ *  - ./main watki: wielu kibiców jako wątki w jednym procesie.
+ */
+
+#include "common.h"
+#include "pamiec.h"
+#include "transport.h"
+
+/* Cechy kibica: to, co wcześniej przychodziło w argv + wylosowany wiek/drużyna. */
+typedef struct {
+    int id;
+    int is_vip;
+    int ma_race;
+    int ma_juz_bilet;
+    int wiek;
+    int druzyna;
+    /* czas_ns() zlecenia utworzenia (0 = nieznany) – do LAT_START_KIBICA */
+    long long t_zlecenia_ns;
+    /* zamierzony czas przybycia z generatora (0 = kolega) – do LAT_BILET/LAT_WEJSCIE */
+    long long t_zamiaru_ns;
+} KibicParametry;
+
+/* Zasoby IPC podpięte przez proces, w którym kibic działa. */
+typedef struct {
+    SharedState *stan;
+    int semid;
+    Transport *transport; // żądanie do kasy i bilet (transport.h)
+} KibicIpc;
+
+/* Wynik kibic_zycie() */
+#define KIBIC_OK         0
+#define KIBIC_BLAD       1
+#define KIBIC_WYRZUCONY  2   /* kontrola wykryła racę */
+
+void kibic_losuj_cechy(KibicParametry *p, unsigned int *ziarno);
+int kibic_zycie(const KibicParametry *p, const KibicIpc *ipc);
+
+/* Koniec procesu-kibica (./kibic albo dziecko zygoty): stan_odlacz + exit wg wyniku. */
+void kibic_proces_koniec(const KibicIpc *ipc, int wynik) __attribute__((noreturn));
+
+#endif
@@ -0,0 +1,690 @@
+#include "kibic.h"
+#include "reguly.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+
+/*
+ * ===================
+ * CYKL ŻYCIA KIBICA
+ * ===================
+ * Kibic przechodzi etapy:
+ *  1) (opcjonalnie) ustawienie się w kolejce do kas i wysłanie żądania (msg),
+ *  2) odebranie biletu (msg) i zapis do raportu (plik + flock),
+ *  3) wejście na stadion:
+ *      - VIP: bez bramek,
+ *      - standard: przez 2 bramki w sektorze + limit osób + brak mieszania drużyn,
+ *  4) siedzenie w sektorze (licznik obecnych w shm),
+ *  5) wyjście przy ewakuacji (stan->ewakuacja_trwa).
+ *
+ * Ten sam kod wykonuje:
+ *  - proces ./kibic (main w kibic.c),
+ *  - proces forkowany przez zygotę w trybie "./main zygota" (main.c),
+ *  - wątek z puli w trybie "./main watki" (main.c).
+ * Dlatego kibic_zycie() nie kończy procesu (exit), tylko zwraca kod KIBIC_*,
+ * a o exit/stan_odlacz decyduje wywołujący.
+ *
+ * Kluczowe mechanizmy:
+ *  - transport (transport.h): żądanie do kasjera i odpowiedź (bilet) – domyślnie pierścień w shm i skrzynka z futexem,
+ *  - shm: wspólny stan (blokady sektorów, bramki, ewakuacja, statystyki),
+ *  - semafory: SEM_SEKTOR_* dla bramek, czekanie na wolną bramkę na futexie sektora; liczniki (sektory[].obecni, cnt_*) zmieniamy atomowo, bez blokady,
+ *  - raport.txt: dopisywanie atomowe przez open()+flock()+dprintf().
+ */
+
+
+/*=====================
+* DZIECKO + OPIEKUN
+* =====================
+* Opiekun nie jest osobnym procesem: para to jeden kibic z grupa=2.
+* Wszystkie etapy przechodzą razem, więc wystarczy, że para:
+*  - zajmuje 2 miejsca w kolejce do kas, w bramce i w sektorze,
+*  - kupuje 2 bilety albo nic (reguly_ile_biletow),
+*  - ma 2 wpisy w raporcie i liczy się do cnt_opiekun.
+* Dzięki temu dziecko nie zajmuje drugiego slotu procesu i nie czeka na opiekuna przy każdym etapie.
+*/
+
+/* Aktualizacja liczby obecnych w sektorze – licznik atomowy, bez blokady */
+static void obecni_inc(SharedState *stan, int sektor, int ile) {
+    // Zmieniamy licznik osób siedzących w sektorze (release: pracownik widzi nas przed wyjściem)
+    wersja_zapis_start(&stan->sektory[sektor].wersja);
+    __atomic_add_fetch(&stan->sektory[sektor].obecni, ile, __ATOMIC_RELEASE);
+    wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+}
+
+static void obecni_dec(SharedState *stan, int sektor, int ile) {
+    if (ile < 0) ile = -ile;
+    int v = __atomic_load_n(&stan->sektory[sektor].obecni, __ATOMIC_RELAXED);
+    // Zmieniamy licznik osób siedzących w sektorze, nie schodząc poniżej zera (przy porażce CAS v = aktualna wartość)
+    wersja_zapis_start(&stan->sektory[sektor].wersja);
+    while (!__atomic_compare_exchange_n(&stan->sektory[sektor].obecni, &v, v >= ile ? v - ile : 0, 1,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+    }
+    wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+    // Ostatni wychodzący z sektora: przy ewakuacji zgłaszamy pracownikowi/kierownikowi, że może już być pusto
+    if (v <= ile) sektor_zmiana(stan, sektor);
+}
+
+/* Pomiar startu (main.c): ilu kibiców stoi już w kolejkach kas, kiedy dołączył co START_PROG-ty i ostatni */
+static void zapisz_w_kolejce(SharedState *stan) {
+    long long t = czas_ns();
+    int n = __atomic_add_fetch(&stan->w_kolejce, 1, __ATOMIC_RELAXED);
+    if (n % START_PROG == 0 && n / START_PROG <= K / START_PROG) {
+        __atomic_store_n(&stan->t_w_kolejce_ns[n / START_PROG], t, __ATOMIC_RELAXED);
+    }
+    long long m = __atomic_load_n(&stan->t_ostatni_w_kolejce_ns, __ATOMIC_RELAXED);
+    while (t > m && !__atomic_compare_exchange_n(&stan->t_ostatni_w_kolejce_ns, &m, t, 1,
+                                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+static const char* team_color(int druzyna) {
+    return (druzyna == 0) ? CLR_DBLUE : CLR_PURPLE;
+}
+
+static const char* team_name(int druzyna) {
+    return (druzyna == 0) ? "GOSP" : "GOSC";
+}
+
+/*
+ * Dopisanie rekordu do raportu:
+ *  - typ: vip / opiekun / zwykly
+ *  - sektor: docelowy sektor (0..7 albo VIP)
+ */
+static void append_report(int kibic_id, int wiek, int sektor, int grupa) {
+    const char *typ = (sektor == SEKTOR_VIP) ? "vip" : ((wiek < 15) ? "opiekun z dzieckiem" : "zwykly");
+
+    /* open(): otwiera plik raportu do dopisywania*/
+    int fd = open("raport.txt", O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd == -1) { warn_errno("open(raport.txt)"); return; }
+
+    /* Blokada pliku, żeby wpisy z wielu procesów się nie mieszały*/
+    if (flock(fd, LOCK_EX) == -1) {
+        warn_errno("flock(LOCK_EX)");
+        /* close(): zamyka deskryptor pliku*/
+        if (close(fd) == -1) warn_errno("close(raport.txt)");
+        return;
+    }
+
+    /* Dopisanie linijki/linijek (id typ sektor)*/
+    if (dprintf(fd, "%d %s %d\n", kibic_id, typ, sektor) < 0) {
+        warn_errno("dprintf(raport.txt)");
+    }
+
+    /* Para (opiekun + dziecko) ma mieć 2 wpisy w raporcie, bo to 2 osoby.
+     * Opiekun dostaje „sztuczne” ID, żeby nie dublować numeru dziecka.
+     */
+    if (grupa == 2 && wiek < 15 && sektor != SEKTOR_VIP) {
+        const int opiekun_id = 200000 + kibic_id;
+        if (dprintf(fd, "%d %s %d\n", opiekun_id, typ, sektor) < 0) {
+            warn_errno("dprintf(raport.txt)");
+        }
+    }
+
+    if (flock(fd, LOCK_UN) == -1) warn_errno("flock(LOCK_UN)");
+    /* close(): zamyka deskryptor pliku*/
+    if (close(fd) == -1) warn_errno("close(raport.txt)");
+}
+
+/* Statystyki kto wszedł – liczniki atomowe, czytane dopiero w raporcie końcowym */
+static void bump_entered(SharedState *stan, int wiek, int is_kolega, int grupa) {
+    if (grupa < 1) grupa = 1;
+    __atomic_add_fetch(&stan->cnt_weszlo, grupa, __ATOMIC_RELAXED);
+    if (wiek < 15) __atomic_add_fetch(&stan->cnt_opiekun, 1, __ATOMIC_RELAXED);
+    if (is_kolega) __atomic_add_fetch(&stan->cnt_kolega, 1, __ATOMIC_RELAXED);
+}
+
+/* Statystyka agresji*/
+static void bump_agresja(SharedState *stan) {
+    __atomic_add_fetch(&stan->cnt_agresja, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Błąd semafora/mutexu (zablokuj_r, odblokuj_r, sem_op_r) -> wynik kibic_zycie().
+ * Nie kończymy procesu: w ./main watki kibic jest wątkiem main (exit zabrałby metryki i sprzątanie).
+ * Zestaw semaforów skasowany (./clean) = koniec symulacji, czyli zwykłe KIBIC_OK.
+ */
+static int blad_synchro(const char *ctx) {
+    if (errno == EIDRM || errno == EINVAL) return KIBIC_OK;
+    warn_errno(ctx);
+    return KIBIC_BLAD;
+}
+
+/*
+ * ==========================
+ * KOLEJKA POD BRAMKAMI
+ * ==========================
+ * Pod bramkami sektora stoją dwie kolejki FIFO, po jednej na drużynę, z numerkami jak w ticket lock:
+ *  - przy pierwszej próbie kibic bierze numer kolejka_nastepny[druzyna] i zapamiętuje, ilu
+ *    przeciwników dostało numer przed nim; do bramki wchodzi tylko czoło (kolejka_czolo[druzyna]),
+ *  - przeciwnicy wpuszczani są po kolei, więc "przepuszczeni" (przeciwnicy, którzy przyszli później,
+ *    a weszli wcześniej) to dokładnie kolejka_czolo[przeciwnik] - przeciwnicy przed nami – O(1),
+ *  - każdy czekający śpi na własnym budziku (budziki_bramek[sektor][druzyna][nr % BUDZIKI_BRAMKI]);
+ *    numer budzika czyta i zgłasza się w czekajacy[] pod mutexem sektora, więc pobudka po puszczeniu
+ *    mutexu nie przepadnie (futex_czekaj od razu wraca z EAGAIN),
+ *  - wychodzący z bramki budzi tylko czoła drużyn, które się teraz zmieszczą (jej drużyna, gdy bramka
+ *    nie jest pusta; obie, gdy opustoszała), a wpuszczone czoło budzi następne, jeśli jest jeszcze miejsce,
+ *  - śpiące czoło, które nie zmieściło się do bramek, zostawia w sektorze swoich "przeciwników przed"
+ *    (czolo_konflikt, czolo_przeciwnicy_przed): każdy wpuszczony przeciwnik przelicza mu cierpliwość
+ *    i budzi je, gdy się skończyła – inaczej licznik rósłby mu we śnie i agresja nie zdarzyłaby się nigdy,
+ *  - agresor (zawsze czoło swojej drużyny) czeka na puste bramki, reszta na jego wejście.
+ * make BRAMKI=polling: ta sama kolejka, ale zamiast budzika dawne usleep() – do porównania (metryki w main).
+ */
+
+#ifndef BRAMKI_POLLING
+static unsigned int *budzik(SharedState *stan, int sektor, int druzyna, unsigned int nr) {
+    return &stan->budziki_bramek[sektor][druzyna][nr % BUDZIKI_BRAMKI];
+}
+#endif
+
+// Wywołujący trzyma mutex sektora; mutex puszczamy tutaj, przed snem na budziku swojego numeru. 0 albo -1 (errno)
+static int czekaj_na_bramke(SharedState *stan, int semid, int sektor, int druzyna, unsigned int nr,
+                             int usleep_polling) {
+    StanSektora *sek = &stan->sektory[sektor];
+    sek->proby_nieudane++;
+#ifdef BRAMKI_POLLING
+    (void)druzyna;
+    (void)nr;
+    if (odblokuj_r(stan, semid, SEM_SEKTOR_START + sektor) == -1) return -1;
+    usleep(usleep_polling);
+#else
+    (void)usleep_polling;
+    unsigned int *b = budzik(stan, sektor, druzyna, nr);
+    unsigned int v = __atomic_load_n(b, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&sek->czekajacy[druzyna], 1, __ATOMIC_RELAXED);
+    if (odblokuj_r(stan, semid, SEM_SEKTOR_START + sektor) == -1) {
+        __atomic_sub_fetch(&sek->czekajacy[druzyna], 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    // Limit 1 s tylko na wszelki wypadek (np. ewakuacja ogłoszona bez bramki_obudz)
+    if (futex_czekaj(b, v, 1000000000LL) == -1 && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+        warn_errno("futex_czekaj(bramka)");
+    }
+    __atomic_sub_fetch(&sek->czekajacy[druzyna], 1, __ATOMIC_RELAXED);
+#endif
+    return 0;
+}
+
+/*
+ * Wywołujący trzyma mutex sektora: coś się zmieniło dla czoła kolejki drużyny – podbijamy jego budzik.
+ * Zwraca budzik do obudz_czolo() po odblokowaniu albo NULL (kolejka pusta / nikt nie śpi / polling).
+ */
+static unsigned int *szturchnij_czolo(SharedState *stan, int sektor, int druzyna) {
+#ifdef BRAMKI_POLLING
+    (void)stan;
+    (void)sektor;
+    (void)druzyna;
+    return NULL;
+#else
+    StanSektora *sek = &stan->sektory[sektor];
+    if (sek->kolejka_czolo[druzyna] == sek->kolejka_nastepny[druzyna]) return NULL;
+    unsigned int *b = budzik(stan, sektor, druzyna, sek->kolejka_czolo[druzyna]);
+    __atomic_add_fetch(b, 1, __ATOMIC_RELAXED);
+    return __atomic_load_n(&sek->czekajacy[druzyna], __ATOMIC_RELAXED) ? b : NULL;
+#endif
+}
+
+static void obudz_czolo(unsigned int *b) {
+    // INT_MAX: na tym samym budziku może spać numer o BUDZIKI_BRAMKI dalej – sprawdzi kolejkę i zaśnie
+    if (b && futex_obudz(b, INT_MAX) == -1) warn_errno("futex_obudz(bramka)");
+}
+
+/*
+ * Wywołujący trzyma mutex sektora: zwolniło się miejsce w bramce (albo bramka = -1: zmiana priorytetu
+ * agresora). Szturcha czoła drużyn, które mogą teraz wejść; budziki do obudz_czolo() w b[].
+ */
+static void zmiana_pod_bramka(SharedState *stan, int sektor, int bramka, unsigned int *b[2]) {
+    StanSektora *sek = &stan->sektory[sektor];
+    int budz[2] = {0, 0};
+    if (bramka == -1 || sek->agresor != 0) {
+        // Z agresorem wejdzie tylko on, i to dopiero do pustych bramek
+        if (bramka == -1 || reguly_bramki_puste(sek->bramki)) budz[0] = budz[1] = 1;
+    } else if (sek->bramki[bramka].zajetosc == 0) {
+        budz[0] = budz[1] = 1;
+    } else {
+        budz[sek->bramki[bramka].druzyna] = 1;
+    }
+    for (int d = 0; d < 2; d++) b[d] = budz[d] ? szturchnij_czolo(stan, sektor, d) : NULL;
+}
+
+/*
+ * Wywołujący trzyma mutex sektora, a czoło drużyny właśnie zajęło miejsce w bramce: przesuwamy kolejkę
+ * i zwracamy czas wejścia. b (jeśli nie NULL) = budziki do obudz_czolo(): b[druzyna] – nowe czoło,
+ * gdy zmieści się jeszcze ktoś z drużyny, b[przeciwnik] – śpiące czoło przeciwników, któremu właśnie
+ * skończyła się cierpliwość.
+ */
+static long long wejdz_do_bramki(SharedState *stan, int sektor, int druzyna, unsigned int *b[2]) {
+    StanSektora *sek = &stan->sektory[sektor];
+    long long t = czas_ns();
+    if (sek->t_pierwsze_wejscie_ns == 0) sek->t_pierwsze_wejscie_ns = t;
+    sek->kolejka_czolo[druzyna]++;
+    sek->czolo_konflikt[druzyna] = 0;
+    if (b) {
+        int powod;
+        b[druzyna] = (sek->agresor == 0 && reguly_wybierz_bramke(sek->bramki, druzyna, 1, &powod) != -1)
+                         ? szturchnij_czolo(stan, sektor, druzyna)
+                         : NULL;
+        // Wpuściliśmy kolejnego przeciwnika śpiącego czoła: budzimy je dokładnie wtedy, gdy skończyła mu się
+        // cierpliwość (ten sam rachunek co u niego – kolejka_czolo[przeciwnik] - przeciwnicy przed nim)
+        int d = 1 - druzyna;
+        b[d] = (sek->czolo_konflikt[d] &&
+                reguly_cierpliwosc_wyczerpana((int)(sek->kolejka_czolo[druzyna] - sek->czolo_przeciwnicy_przed[d])))
+                   ? szturchnij_czolo(stan, sektor, d)
+                   : NULL;
+    }
+    return t;
+}
+
+/*
+ * Wyjście z bramki po przejściu kontroli: zwalniamy miejsce, liczymy zajętość i budzimy tych, co się zmieszczą.
+ * 0 albo -1 (errno z blokady sektora).
+ */
+static int wyjdz_z_bramki(SharedState *stan, int semid, int sektor, int bramka, int grupa, long long t_wejscia) {
+    StanSektora *sek = &stan->sektory[sektor];
+    unsigned int *b[2];
+
+    if (zablokuj_r(stan, semid, SEM_SEKTOR_START + sektor) == -1) return -1;
+    // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
+    wersja_zapis_start(&sek->wersja);
+    if (sek->bramki[bramka].zajetosc >= grupa) sek->bramki[bramka].zajetosc -= grupa;
+    else sek->bramki[bramka].zajetosc = 0;
+    wersja_zapis_koniec(&sek->wersja);
+    long long t = czas_ns();
+    sek->zajete_ns += grupa * (t - t_wejscia);
+    sek->t_ostatnie_wyjscie_ns = t;
+    zmiana_pod_bramka(stan, sektor, bramka, b);
+    int puste = reguly_bramki_puste(sek->bramki);
+    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+    if (odblokuj_r(stan, semid, SEM_SEKTOR_START + sektor) == -1) return -1;
+
+    obudz_czolo(b[0]);
+    obudz_czolo(b[1]);
+    // Bramki opustoszały: przy ewakuacji pracownik sektora sprawdzi, czy to już koniec
+    if (puste) sektor_zmiana(stan, sektor);
+    return 0;
+}
+
+/*Wyproszenie kibica z racą*/
+static int expel_for_flare(SharedState *stan, int semid, int sem_sektora, int sektor, int my_id) {
+    printf(CLR_RED "[KONTROLA] WYKRYTO KIBICA %d Z RACĄ (SEKTOR %d) — WYPROSZONY!" CLR_RESET "\n",
+           my_id, sektor);
+    fflush(stdout);
+
+    if (sektor >= 0 && sektor < LICZBA_SEKTOROW) {
+        // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
+        if (stan->sektory[sektor].agresor == my_id) {
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].agresor = 0;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+        }
+    }
+
+    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+    if (sem_sektora >= 0 && odblokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("odblokuj(sektor)");
+
+    return KIBIC_WYRZUCONY;
+}
+
+/*
+ * Losowanie wieku i drużyny.
+ * rand_r() z własnym ziarnem, bo w trybie wątkowym wielu kibiców losuje naraz.
+ */
+void kibic_losuj_cechy(KibicParametry *p, unsigned int *ziarno) {
+    // Wiek (dziecko < 15 wchodzi z opiekunem) i drużyna – wspólna reguła z silnikiem (reguly.h)
+    reguly_losuj_cechy(p->ma_juz_bilet, ziarno, &p->wiek, &p->druzyna);
+}
+
+void kibic_proces_koniec(const KibicIpc *ipc, int wynik) {
+    /* stan_odlacz(): odłącza shm od procesu*/
+    if (stan_odlacz(ipc->stan) == -1) warn_errno("stan_odlacz");
+
+    if (wynik == KIBIC_WYRZUCONY) {
+        // Wyproszony z racą: proces kończy się „twardo”, jak przy wyrzuceniu przez ochronę.
+        kill(getpid(), SIGKILL);
+        _exit(137);
+    }
+    exit((wynik == KIBIC_BLAD) ? EXIT_FAILURE : 0);
+}
+
+int kibic_zycie(const KibicParametry *p, const KibicIpc *ipc) {
+    SharedState *stan = ipc->stan;
+    int semid = ipc->semid;
+
+    int my_id = p->id;
+    int is_vip = p->is_vip;
+    int ma_race = p->ma_race;
+    int ma_juz_bilet = p->ma_juz_bilet;
+    int wiek = p->wiek;
+    int druzyna = p->druzyna;
+
+    // Kibic gotowy do działania: ile trwało od zlecenia (fork+exec / fork z zygoty / wątek)
+    if (p->t_zlecenia_ns > 0) hist_dodaj(&stan->lat[LAT_START_KIBICA], czas_ns() - p->t_zlecenia_ns);
+
+    if (wiek < 15 && !is_vip) usleep(1000);
+    if (stan->ewakuacja_trwa) return KIBIC_OK;
+    if (!ma_juz_bilet && !is_vip && stan->standard_sold_out) return KIBIC_OK;
+    if (!ma_juz_bilet && stan->sprzedaz_zakonczona) return KIBIC_OK;
+
+    // Ile "fizycznych osób" reprezentuje ten kibic w modelu tłumu.
+    // Dziecko zawsze wchodzi z opiekunem => zajmują 2 miejsca (opiekun to tylko grupa=2).
+    int grupa = reguly_grupa(wiek, is_vip);
+
+/*
+ * ==============================================
+ * KOLEJKA DO KAS: transport_wyslij_zadanie()
+ * ==============================================
+ *  - Żądanie (my_id, grupa) idzie do kolejki VIP albo standard wybranego backendu
+ *    (transport.h): w shm to pierścień stan->kolejka_vip / kolejka_zwykla – bez semafora
+ *    i bez wywołania systemowego, w sysv/posix msgsnd/mq_send bez czekania.
+ *  - Pełna kolejka: czekamy chwilę i ponawiamy (jak blokujący msgsnd).
+ *
+ * Kasjer zdejmuje żądanie i odsyła bilet transport_odpowiedz(); czekamy na niego
+ * w transport_odbierz_bilet() (w shm: skrzynka stan->skrzynki[my_id] z futexem).
+ */
+
+    /*Jeśli nie ma biletu: dołącza do kolejki i wysyła request do kasjera*/
+    if (!ma_juz_bilet) {
+        int r;
+        while ((r = transport_wyslij_zadanie(ipc->transport, my_id, grupa, is_vip)) != 1) {
+            if (r == -1) {
+                // Kolejka skasowana (./clean) = koniec symulacji
+                if (errno == EIDRM || errno == EINVAL) return KIBIC_OK;
+                warn_errno("wyslij_zadanie");
+                return KIBIC_BLAD;
+            }
+            // Sprzedaż się skończyła, zanim zwolniło się miejsce – nikt już nie odpowie
+            if (stan->sprzedaz_zakonczona || stan->ewakuacja_trwa) return KIBIC_OK;
+            usleep(1000);
+        }
+        // Budzimy śpiącego kasjera (tylko gdy jakiś śpi – inaczej to jedna operacja atomowa)
+        kasy_zadzwon(stan);
+        zapisz_w_kolejce(stan);
+    }
+
+    /*Oczekiwanie na bilet: w shm własna skrzynka (futex), O(1) niezależnie od liczby czekających*/
+    int sektor = transport_odbierz_bilet(ipc->transport, my_id);
+    if (sektor == -1) return KIBIC_OK;
+    long long t_bilet = czas_ns();
+    if (p->t_zamiaru_ns > 0) hist_dodaj(&stan->lat[LAT_BILET], t_bilet - p->t_zamiaru_ns);
+
+/*
+ * ==========================
+ * RAPORT
+ * ==========================
+ * Każdy kibic dopisuje jedną linię: "id typ sektor".
+ * Ponieważ działa wiele procesów naraz, używamy:
+ *  - open(..., O_APPEND) żeby system dopisywał na koniec,
+ *  - flock(LOCK_EX) żeby nie przeplatać wpisów.
+ */
+    append_report(my_id, wiek, sektor, grupa);
+    const int is_kolega = (my_id >= DYN_ID_START);
+
+/*
+ * ==========
+ * ŚCIEŻKA VIP
+ * ==========
+ * VIP omija bramki (osobne wejście), nie przechodzi kontroli bezpieczeństwa.
+ */
+
+    if (sektor == SEKTOR_VIP) {
+        bump_entered(stan, wiek, is_kolega, 1);
+        if (p->t_zamiaru_ns > 0) hist_dodaj(&stan->lat[LAT_WEJSCIE], czas_ns() - p->t_zamiaru_ns);
+        printf(CLR_YELLOW "[VIP %d] WEJŚCIE VIP" CLR_RESET "\n", my_id);
+        fflush(stdout);
+
+        obecni_inc(stan, SEKTOR_VIP, 1);
+        // Czekamy na ewakuację/koniec – ten semafor staje się 0, gdy kierownik ogłosi ewakuację
+        int r = sem_op_r(semid, SEM_EWAKUACJA, 0);
+        obecni_dec(stan, SEKTOR_VIP, 1);
+        return (r == -1) ? blad_synchro("semop(ewakuacja)") : KIBIC_OK;
+    }
+
+/*
+ * ===================
+ * ŚCIEŻKA STANDARD
+ * ===================
+ * Wejście przez bramki sektora:
+ *  - sektor ma 2 bramki (Stanowisko[2]),
+ *  - każda bramka ma limit MAX_NA_STANOWISKU (tu: 3),
+ *  - nie mieszamy drużyn w tej samej bramce:
+ *      jeśli bramka jest zajęta i druzyna != moja -> nie wchodzę.
+ *
+ * Synchronizacja:
+ *  - SEM_SEKTOR_START + sektor chroni sektory[sektor] (bramki, kolejki pod bramkami, agresor).
+ *  - sektory[sektor].blokada może być ustawiona komendami 1/2 od kierownika
+ *    (pracownik sektora aktualizuje to w shm).
+ */
+
+    int sem_sektora = SEM_SEKTOR_START + sektor;
+    int wszedl_do_sektora = 0;
+
+    /*
+     * Miejsce w kolejce FIFO swojej drużyny (numerek przy pierwszej próbie) i ilu przeciwników
+     * dostało numer przed nami – "przepuszczeni" to przeciwnicy wpuszczeni ponad tę liczbę.
+     */
+    int w_kolejce = 0;
+    unsigned int moj_nr = 0;
+    unsigned int przeciwnicy_przed = 0;
+
+    int tryb_agresora = 0;     /* po przekroczeniu cierpliwości */
+    int agresja_ogloszona = 0;
+
+    StanSektora *sek = &stan->sektory[sektor];
+    long long t_proby = czas_ns(); // LAT_CZEKANIE_NA_BRAMKE
+
+    while (1) {
+        // Sprawdzamy czy trwa ewakuacja (wtedy przerywamy normalne działania i kończymy pętle)
+        if (stan->ewakuacja_trwa) break;
+
+        // Czekamy aż sektor będzie odblokowany (semafor blokady = 0 oznacza 'można wchodzić')
+        if (sem_op_r(semid, SEM_SEKTOR_BLOCK_START + sektor, 0) == -1) return blad_synchro("semop(blokada sektora)");
+        // Sprawdzamy czy trwa ewakuacja (wtedy przerywamy normalne działania i kończymy pętle)
+        if (stan->ewakuacja_trwa) break;
+
+        /* Semafor sektora: chroni stan bramek + agresora */
+        if (zablokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("zablokuj(sektor)");
+
+        /* Kontrola na bramkach: kibic z racą wylatuje*/
+        if (ma_race) {
+            return expel_for_flare(stan, semid, sem_sektora, sektor, my_id);
+        }
+        if (!w_kolejce) {
+            moj_nr = sek->kolejka_nastepny[druzyna]++;
+            przeciwnicy_przed = sek->kolejka_nastepny[1 - druzyna];
+            w_kolejce = 1;
+        }
+        // FIFO w drużynie: do bramki próbuje tylko czoło, reszta śpi, aż kolejka do niej dojdzie
+        if (sek->kolejka_czolo[druzyna] != moj_nr) {
+            if (czekaj_na_bramke(stan, semid, sektor, druzyna, moj_nr, 10000) == -1) {
+                return blad_synchro("odblokuj(sektor)");
+            }
+            continue;
+        }
+        // Sprawdzamy czy ktoś ma priorytet agresora (jeśli tak i to nie my, czekamy).
+        if (stan->sektory[sektor].agresor != 0 && stan->sektory[sektor].agresor != my_id) {
+            // Czekamy, aż agresor wejdzie (mutex sektora puszcza czekaj_na_bramke)
+            if (czekaj_na_bramke(stan, semid, sektor, druzyna, moj_nr, 10000) == -1) {
+                return blad_synchro("odblokuj(sektor)");
+            }
+            continue;
+        }
+
+        /* Tryb agresora: rezerwujemy sektor, czekamy aż bramki puste i wchodzimy */
+        if (tryb_agresora) {
+            // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
+            if (stan->sektory[sektor].agresor == 0) {
+                wersja_zapis_start(&stan->sektory[sektor].wersja);
+                stan->sektory[sektor].agresor = my_id;
+                wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+            }
+
+            // Sprawdzamy czy ktoś ma priorytet agresora (jeśli tak i to nie my, czekamy)
+            if (stan->sektory[sektor].agresor != my_id) {
+                if (czekaj_na_bramke(stan, semid, sektor, druzyna, moj_nr, 10000) == -1) {
+                    return blad_synchro("odblokuj(sektor)");
+                }
+                continue;
+            }
+
+            // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
+            if (!reguly_bramki_puste(stan->sektory[sektor].bramki)) {
+                // Budzi nas ostatni wychodzący z bramek (zmiana_pod_bramka przy agresorze)
+                if (czekaj_na_bramke(stan, semid, sektor, druzyna, moj_nr, 5000) == -1) {
+                    return blad_synchro("odblokuj(sektor)");
+                }
+                continue;
+            }
+
+            /* bramki są puste => wchodzimy jako pierwsi */
+            bump_entered(stan, wiek, is_kolega, grupa);
+
+            // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].bramki[0].zajetosc += grupa;
+            stan->sektory[sektor].bramki[0].druzyna = druzyna;
+            // Dopisz kolejne przejście przez kontrolę
+            stan->sektory[sektor].wejscia_kontrola[druzyna] += grupa;
+
+            // Rezerwujemy/zwalniamy priorytet agresora – tylko jeden agresor na sektor może przejąć wejście naraz
+            stan->sektory[sektor].agresor = 0; /* odblokuj wejście kolejnym */
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+            long long t_wejscia = wejdz_do_bramki(stan, sektor, druzyna, NULL);
+            hist_dodaj(&stan->lat[LAT_CZEKANIE_NA_BRAMKE], t_wejscia - t_proby);
+            // Koniec priorytetu: czoła obu kolejek mogą próbować
+            unsigned int *b[2];
+            zmiana_pod_bramka(stan, sektor, -1, b);
+
+            const char *tc = team_color(druzyna);
+            const char *tn = team_name(druzyna);
+            printf(CLR_RED "[AGRESOR %d] PRIORYTET! WCHODZI do bramki w sektorze %d: %s%s%s. Stan: %d/3" CLR_RESET "\n",
+                   my_id, sektor, tc, tn, CLR_RESET,
+                   // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
+                   stan->sektory[sektor].bramki[0].zajetosc);
+            fflush(stdout);
+
+            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+            if (odblokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("odblokuj(sektor)");
+            obudz_czolo(b[0]);
+            obudz_czolo(b[1]);
+
+            usleep(30000);
+
+            if (wyjdz_z_bramki(stan, semid, sektor, 0, grupa, t_wejscia) == -1) return blad_synchro("wyjdz_z_bramki");
+
+            // Ogłaszamy ewakuację
+            if (!stan->ewakuacja_trwa) wszedl_do_sektora = 1;
+            break;
+        }
+
+        /* Szukamy bramki: albo pusta, albo zajęta przez naszą drużynę (reguly.h)*/
+        int powod = 0;
+        int wybrane = reguly_wybierz_bramke(stan->sektory[sektor].bramki, druzyna, grupa, &powod);
+
+        if (wybrane != -1) {
+            /* Udane wejście do bramki = liczymy jako wszedł w statystykach*/
+            bump_entered(stan, wiek, is_kolega, grupa);
+
+            // Zmieniamy stan bramki (zajętość + drużyna), żeby pilnować limitu 3 osób i nie mieszać drużyn
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].bramki[wybrane].zajetosc += grupa;
+            stan->sektory[sektor].bramki[wybrane].druzyna = druzyna;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].wejscia_kontrola[druzyna] += grupa;
+            unsigned int *b[2];
+            long long t_wejscia = wejdz_do_bramki(stan, sektor, druzyna, b);
+            hist_dodaj(&stan->lat[LAT_CZEKANIE_NA_BRAMKE], t_wejscia - t_proby);
+
+            const char *tc = team_color(druzyna);
+            const char *tn = team_name(druzyna);
+
+            if (wiek < 15) {
+                printf("[SEKTOR %d|ST %d] Wchodzi %s%s%s %s(OPIEKUN + DZIECKO)%s. Stan: %d/3\n",
+                       sektor, wybrane,
+                       tc, tn, CLR_RESET,
+                       CLR_LBLUE, CLR_RESET,
+                       // Odczytujemy stan bramek, żeby zdecydować czy można wejść i którą bramkę wybrać
+                       stan->sektory[sektor].bramki[wybrane].zajetosc);
+            } else {
+                printf("[SEKTOR %d|ST %d] Wchodzi %s%s%s. Stan: %d/3\n",
+                       sektor, wybrane,
+                       tc, tn, CLR_RESET,
+                       stan->sektory[sektor].bramki[wybrane].zajetosc);
+            }
+            fflush(stdout);
+
+            /* Zwolnienie semafora*/
+            if (odblokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("odblokuj(sektor)");
+            // Obok jest jeszcze miejsce dla naszej drużyny – następny z kolejki nie czeka na wyjście z bramki;
+            // czoło przeciwników sprawdza cierpliwość
+            obudz_czolo(b[0]);
+            obudz_czolo(b[1]);
+
+            usleep(30000);
+
+            /* Aktualizacja bramki po przejściu (i pobudka tych, którzy się teraz zmieszczą)*/
+            if (wyjdz_z_bramki(stan, semid, sektor, wybrane, grupa, t_wejscia) == -1) {
+                return blad_synchro("wyjdz_z_bramki");
+            }
+
+            if (!stan->ewakuacja_trwa) wszedl_do_sektora = 1;
+            break;
+        }
+
+        /*
+         * Nie udało się wejść, a jesteśmy czołem kolejki:
+         *  - jeśli powodem jest konflikt drużyny, "przepuszczeni" to przeciwnicy wpuszczeni
+         *    ponad tych, którzy dostali numer przed nami – dokładnie, bez przeglądania kolejki.
+         */
+        if (powod == POWOD_KONFLIKT) {
+            int przepuszczone = (int)(sek->kolejka_czolo[1 - druzyna] - przeciwnicy_przed);
+            if (przepuszczone < 0) przepuszczone = 0;
+            if (reguly_cierpliwosc_wyczerpana(przepuszczone)) {
+                if (!agresja_ogloszona) {
+                    bump_agresja(stan);
+                    printf(CLR_RED "[AGRESJA] KIBIC %d (DR %d) POD SEKTOREM %d — PRZEPUŚCIŁ %d WROGÓW, BIERZE PRIORYTET!" CLR_RESET "\n",
+                           my_id, druzyna, sektor, przepuszczone);
+                    fflush(stdout);
+                    agresja_ogloszona = 1;
+                }
+                tryb_agresora = 1;
+                sek->czolo_konflikt[druzyna] = 0;
+                // Agresor nie czeka na budzik – od razu próbuje przejąć priorytet
+                if (odblokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("odblokuj(sektor)");
+                continue;
+            }
+        }
+
+        /* puść mutex sektora dopiero po obliczeniach (czekaj_na_bramke) */
+        // Przy pełnych bramkach też: gdy zwolni się miejsce przeciwników, wpuszczony przeciwnik nas szturchnie
+        sek->czolo_konflikt[druzyna] = 1;
+        sek->czolo_przeciwnicy_przed[druzyna] = przeciwnicy_przed;
+        if (czekaj_na_bramke(stan, semid, sektor, druzyna, moj_nr, 10000) == -1) {
+            return blad_synchro("odblokuj(sektor)");
+        }
+    }
+
+    if (tryb_agresora) {
+        unsigned int *b[2] = {NULL, NULL};
+        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+        if (zablokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("zablokuj(sektor)");
+        if (stan->sektory[sektor].agresor == my_id) {
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].agresor = 0;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
+            zmiana_pod_bramka(stan, sektor, -1, b);
+        }
+        if (odblokuj_r(stan, semid, sem_sektora) == -1) return blad_synchro("odblokuj(sektor)");
+        obudz_czolo(b[0]);
+        obudz_czolo(b[1]);
+    }
+
+    if (wszedl_do_sektora) {
+        if (p->t_zamiaru_ns > 0) hist_dodaj(&stan->lat[LAT_WEJSCIE], czas_ns() - p->t_zamiaru_ns);
+        hist_dodaj(&stan->lat[grupa == 2 ? LAT_BRAMKA_DZIECKA : LAT_BRAMKA], czas_ns() - t_bilet);
+        obecni_inc(stan, sektor, grupa);
+        // Czekamy na ewakuację/koniec – ten semafor staje się 0, gdy kierownik ogłosi ewakuację
+        int r = sem_op_r(semid, SEM_EWAKUACJA, 0);
+        obecni_dec(stan, sektor, grupa);
+        if (r == -1) return blad_synchro("semop(ewakuacja)");
+    }
+
+    return KIBIC_OK;
+}
@@ -1,4 +1,7 @@
 #include "common.h"
+#include "pamiec.h"
+#include "reguly.h"
+#include "transport.h"
 #include <sys/wait.h>
 #include <sys/select.h>
 #include <time.h>
@@ -10,8 +13,8 @@
  * KIEROWNIK: STEROWANIE i SYGNAŁY 1/2/3
  * ============================
  * Komendy:
- *  - 1: BLOKADA sektora (pracownik ustawia blokada_sektora[sektor]=1 w shm)
- *  - 2: ODBLOKOWANIE sektora (blokada_sektora[sektor]=0)
+ *  - 1: BLOKADA sektora (pracownik ustawia sektory[sektor].blokada=1 w shm)
+ *  - 2: ODBLOKOWANIE sektora (sektory[sektor].blokada=0)
  *  - 3: EWAKUACJA globalna (ustawia ewakuacja_trwa=1 + pracownicy opróżniają sektory)
  */
 
@@ -28,8 +31,6 @@ union semun {
     unsigned short *array;
 };
 
-#define MSGTYPE_KIEROWNIK_CTRL 5000
-
 static int read_int_line(const char *prompt, int *out) {
     if (prompt) {
         fputs(prompt, stdout);
@@ -71,56 +72,19 @@ static int try_become_master(int semid) {
     return 0;
 }
 
-static void send_to_master(int msgid, int cmd, int sektor) {
-    MsgSterujacy c = {MSGTYPE_KIEROWNIK_CTRL, cmd, sektor};
-
-    /* msgsnd(): wysyła komunikat do kolejki*/
-    if (msgsnd(msgid, &c, sizeof(int) * 2, 0) == -1) {
+static void send_to_master(Transport *t, int cmd, int sektor) {
+    /* transport_steruj(): komenda do master-kierownika (CEL_MASTER)*/
+    if (transport_steruj(t, CEL_MASTER, cmd, sektor) == -1) {
         if (errno == EIDRM || errno == EINVAL) {
             printf("[KONTROLER] Brak działającej symulacji (kolejka skasowana).\n");
             fflush(stdout);
             return;
         }
-        warn_errno("msgsnd(ctrl->master)");
+        warn_errno("steruj(ctrl->master)");
     }
 }
 
-/*
- * Bilety/odmowy dla kibiców idą NA OSOBNĄ KOLEJKĘ (KEY_MSG_TICKET).
- * Jeśli wyślemy je na KEY_MSG (kolejka żądań), kibice będą wisieć w msgrcv()
- * i cała symulacja nie dojdzie do końca (brak ./clean).
- */
-static void send_ticket(int msgid_ticket, int kibic_id, int sektor) {
-    MsgBilet msg;
-    msg.mtype = MSGTYPE_TICKET_BASE + kibic_id;
-    msg.sektor_id = sektor;
-
-    while (msgsnd(msgid_ticket, &msg, sizeof(int), 0) == -1) {
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) return;
-        warn_errno("msgsnd(send_ticket@kierownik)");
-        return;
-    }
-}
-
-static void cancel_queue_type(int msgid_req, int msgid_ticket, long req_type) {
-    MsgKolejka req;
-    while (1) {
-        // Odbieramy wiadomość z kolejki
-        ssize_t r = msgrcv(msgid_req, &req, sizeof(MsgKolejka) - sizeof(long), req_type, IPC_NOWAIT);
-        if (r >= 0) {
-            send_ticket(msgid_ticket, req.kibic_id, -1);
-            continue;
-        }
-        if (errno == ENOMSG) break;
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) break;
-        warn_errno("msgrcv(cancel_queue_type@kierownik)");
-        break;
-    }
-}
-
-static void ewakuacja(int msgid_req, int msgid_ticket, int semid, SharedState *stan) {
+static void ewakuacja(Transport *t, int semid, SharedState *stan) {
 /*
  * =====================
  * EWAKUACJA
@@ -131,21 +95,22 @@ static void ewakuacja(int msgid_req, int msgid_ticket, int semid, SharedState *s
  *  - kasjerzy przestali sprzedawać,
  *  - pracownicy sektorów wiedzieli, że mają opróżnić sektor.
  *
- * Następnie wysyłamy do każdego sektora MsgSterujacy:
- *  mtype=10+sektor, typ_sygnalu=3.
+ * Następnie wysyłamy do każdego sektora MsgSterujacy (transport_steruj):
+ *  adresat CEL_PRACOWNIK(sektor), typ_sygnalu=3.
  *
- * Pracownicy odsyłają raporty mtype=99, kiedy:
+ * Pracownicy odsyłają raporty do CEL_RAPORT, kiedy:
  *  - obie bramki sektora są puste,
- *  - obecni_w_sektorze[sektor]==0.
+ *  - sektory[sektor].obecni==0.
  */
 
     /* Start ewakuacji + mecz zakończony*/
-    // Ogłaszamy ewakuację
-    stan->ewakuacja_trwa = 1;
-    // Ustawiamy status meczu
+    // Ogłaszamy ewakuację (seq_cst: od teraz ostatni wychodzący zgłasza pusty sektor, sektor_zmiana)
+    __atomic_store_n(&stan->ewakuacja_trwa, 1, __ATOMIC_SEQ_CST);
+    // Ustawiamy status meczu i odliczanie razem (jedna zmiana w migawce)
+    wersja_zapis_start(&stan->wersja_meczu);
     stan->status_meczu = 2;
-    // Aktualizujemy odliczanie
     stan->czas_pozostaly = 0;
+    wersja_zapis_koniec(&stan->wersja_meczu);
 
     union semun a;
     a.val = 0;
@@ -165,16 +130,22 @@ static void ewakuacja(int msgid_req, int msgid_ticket, int semid, SharedState *s
         }
     }
 
-    cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_VIP_REQ);
-    cancel_queue_type(msgid_req, msgid_ticket, MSGTYPE_STD_REQ);
+    // Każde oczekujące żądanie dostaje bilet -1
+    transport_anuluj(t, 1);
+    transport_anuluj(t, 0);
+    // Kibice śpiący na skrzynkach (żądanie zdjęte, bilet nie przyjdzie) widzą ewakuację od razu
+    skrzynki_obudz(stan);
+    // Kasjerzy śpiący na dzwonku albo przy zamkniętej kasie też – zobaczą ewakuację i wyjdą
+    kasy_obudz(stan);
+    // Tak samo kibice czekający pod bramkami
+    bramki_obudz(stan);
 
     // Iterujemy po wszystkich sektorach
     for (int i = 0; i < LICZBA_SEKTOROW; i++) {
-        MsgSterujacy msg = {10 + i, 3, i};
-        // Wysyłamy wiadomość do kolejki
-        if (msgsnd(msgid_req, &msg, sizeof(int) * 2, 0) == -1) {
+        // Wysyłamy polecenie ewakuacji do pracownika sektora
+        if (transport_steruj(t, CEL_PRACOWNIK(i), 3, i) == -1) {
             if (errno == EIDRM || errno == EINVAL) return;
-            warn_errno("msgsnd(ewakuacja)");
+            warn_errno("steruj(ewakuacja)");
         }
     }
 
@@ -185,29 +156,83 @@ static void ewakuacja(int msgid_req, int msgid_ticket, int semid, SharedState *s
     int raporty = 0;
     while (raporty < LICZBA_SEKTOROW) {
         MsgSterujacy rap;
-        // Odbieramy wiadomość z kolejki
-        ssize_t res = msgrcv(msgid_req, &rap, sizeof(int) * 2, 99, 0);
-        if (res >= 0) {
+        // Odbieramy raport (czekamy, aż przyjdzie)
+        int res = transport_odbierz_sterowanie(t, CEL_RAPORT, 1, &rap);
+        if (res == 1) {
             printf("[RAPORT] Sektor %d pusty\n", rap.sektor_id);
             fflush(stdout);
             raporty++;
         } else {
             if (errno == EIDRM || errno == EINVAL) break; // kolejka skasowana
-            if (errno == EINTR) continue;
-            warn_errno("msgrcv(raport)");
+            warn_errno("odbierz(raport)");
             break;
         }
     }
 
-    // Sprawdzamy ilu ludzi siedzi w sektorze
-    while (stan->obecni_w_sektorze[SEKTOR_VIP] > 0) {
-        usleep(10000);
-    }
+    // Czekamy, aż wyjdzie ostatni VIP (zgłasza to obecni_dec w kibic_zycie.c)
+    sektor_czekaj_na_pusty(stan, SEKTOR_VIP);
 
     printf("[KIEROWNIK] Koniec symulacji\n");
     fflush(stdout);
 }
 
+/*
+ * ==========================================
+ * AUTOSKALOWANIE KAS (kontroler w masterze)
+ * ==========================================
+ * Co TAKT_KAS_MS master próbkuje długość kolejek i podejmuje jedną decyzję (jak kasy_tik w silnik.c):
+ *  - reguly_otworzyc_kase: otwiera pierwszą zamkniętą kasę (kasa_otworz budzi jej kasjera),
+ *  - reguly_zamknac_kase:  zamyka aktywną kasę o najwyższym id > 1 (kasy 0 i 1 to baza).
+ *
+ * Kasjerzy tylko czytają aktywne_kasy[id]. Jeden decydujący i jedna zmiana na takt –
+ * kasy nie zamykają się wszystkie naraz na podstawie tego samego odczytu i nie oscylują.
+ * k_10 = K/10 jest skalą ile osób „na jedną kasę”.
+ */
+static void autoskaluj_kasy(SharedState *stan, int semid) {
+    if (stan->sprzedaz_zakonczona || stan->ewakuacja_trwa) return;
+
+    int k_10 = (K / 10 > 0) ? K / 10 : 1;
+    // Sprawdzamy długość kolejek (standard nie liczy się po wyprzedaniu)
+    int kolejka = transport_dlugosc(stan, 1) + (stan->standard_sold_out ? 0 : transport_dlugosc(stan, 0));
+    int N = 0;
+    for (int i = 0; i < LICZBA_KAS; i++) if (__atomic_load_n(&stan->aktywne_kasy[i], __ATOMIC_RELAXED)) N++;
+
+    if (reguly_otworzyc_kase(N, kolejka, k_10)) {
+        zablokuj(stan, semid, SEM_KASY);
+        // Szukamy wolnej kasy do otwarcia
+        for (int i = 0; i < LICZBA_KAS; i++) {
+            if (stan->aktywne_kasy[i] == 0) {
+                // Włączamy konkretną kasę i budzimy jej kasjera
+                kasa_otworz(stan, i);
+                stan->kasy_otwarcia++;
+                printf(CLR_GREEN "[SYSTEM] OTWIERAM KASĘ %d (kolejka=%d, aktywne=%d->%d)" CLR_RESET "\n",
+                       i, kolejka, N, N + 1);
+                fflush(stdout);
+                break;
+            }
+        }
+        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+        odblokuj(stan, semid, SEM_KASY);
+    } else if (reguly_zamknac_kase(N, kolejka, k_10)) {
+        zablokuj(stan, semid, SEM_KASY);
+        for (int i = LICZBA_KAS - 1; i > 1; i--) {
+            if (stan->aktywne_kasy[i] != 0) {
+                // Wyłączamy kasę – jej kasjer skończy bieżącą paczkę i zaśnie (kasa_czekaj_na_otwarcie)
+                wersja_zapis_start(&stan->wersja_kas);
+                __atomic_store_n(&stan->aktywne_kasy[i], 0, __ATOMIC_SEQ_CST);
+                wersja_zapis_koniec(&stan->wersja_kas);
+                stan->kasy_zamkniecia++;
+                printf(CLR_RED "[SYSTEM] ZAMYKAM KASĘ %d (kolejka=%d, próg=%d)" CLR_RESET "\n",
+                       i, kolejka, k_10 * (N - 1));
+                fflush(stdout);
+                break;
+            }
+        }
+        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+        odblokuj(stan, semid, SEM_KASY);
+    }
+}
+
 static pid_t start_clock_process(SharedState *stan, int semid) {
     // Sprawdzamy czy wolno jeszcze tworzyć procesy
     if (!reserve_process_slot(stan, semid)) {
@@ -237,15 +262,18 @@ static pid_t start_clock_process(SharedState *stan, int semid) {
         int left = CZAS_PRZED_MECZEM - (int)(now - start);
         if (left <= 0) break;
         // Aktualizujemy odliczanie
+        wersja_zapis_start(&stan->wersja_meczu);
         stan->czas_pozostaly = left;
+        wersja_zapis_koniec(&stan->wersja_meczu);
         sleep(1);
     }
 
     /* Start meczu*/
-    // Ustawiamy status meczu
+    // Ustawiamy status meczu i odliczanie razem (jedna zmiana w migawce)
+    wersja_zapis_start(&stan->wersja_meczu);
     stan->status_meczu = 1;
-    // Aktualizujemy odliczanie
     stan->czas_pozostaly = CZAS_MECZU;
+    wersja_zapis_koniec(&stan->wersja_meczu);
 
     start = time(NULL);
     // Kończymy z komunikatem o błędzie
@@ -258,15 +286,18 @@ static pid_t start_clock_process(SharedState *stan, int semid) {
         int left = CZAS_MECZU - (int)(now - start);
         if (left <= 0) break;
         // Aktualizujemy odliczanie
+        wersja_zapis_start(&stan->wersja_meczu);
         stan->czas_pozostaly = left;
+        wersja_zapis_koniec(&stan->wersja_meczu);
         sleep(1);
     }
 
     /* Koniec meczu zegar kończy działanie*/
-    // Ustawiamy status meczu
+    // Ustawiamy status meczu i odliczanie razem (jedna zmiana w migawce)
+    wersja_zapis_start(&stan->wersja_meczu);
     stan->status_meczu = 2;
-    // Aktualizujemy odliczanie
     stan->czas_pozostaly = 0;
+    wersja_zapis_koniec(&stan->wersja_meczu);
 
     /* exit(): kończy proces potomny*/
     exit(0);
@@ -277,8 +308,8 @@ static pid_t start_clock_process(SharedState *stan, int semid) {
  * OBSŁUGA SYGNAŁÓW 1/2/3
  * ==========================
  * cmd==1 lub 2:
- *  - wysyłamy MsgSterujacy do konkretnego pracownika sektora:
- *      mtype = 10 + sektor
+ *  - wysyłamy MsgSterujacy do konkretnego pracownika sektora (transport_steruj):
+ *      adresat = CEL_PRACOWNIK(sektor)
  *      typ_sygnalu = 1 (blokuj) lub 2 (odblokuj)
  *
  * cmd==3:
@@ -286,11 +317,11 @@ static pid_t start_clock_process(SharedState *stan, int semid) {
  *      1) zatrzymujemy proces zegara,
  *      2) ustawiamy ewakuacja_trwa=1 w shm,
  *      3) rozsyłamy sygnał 3 do wszystkich sektorów,
- *      4) czekamy na raporty mtype=99 „sektor pusty”.
+ *      4) czekamy na raporty CEL_RAPORT „sektor pusty”.
  */
 
     /* Sygnał 3: natychmiastowa ewakuacja zatrzymujemy zegar*/
-static int handle_cmd_master(int msgid_req, int msgid_ticket, int semid, SharedState *stan, pid_t *zegar_pid, int cmd, int sektor) {
+static int handle_cmd_master(Transport *t, int semid, SharedState *stan, pid_t *zegar_pid, int cmd, int sektor) {
     if (cmd == 3) {
         if (*zegar_pid > 0) {
             /* kill(): wysyła sygnał SIGTERM do procesu zegara*/
@@ -299,9 +330,11 @@ static int handle_cmd_master(int msgid_req, int msgid_ticket, int semid, SharedS
             /* waitpid(): czekamy aż zegar się zakończy*/
             while (waitpid(*zegar_pid, NULL, 0) == -1 && errno == EINTR) {}
             *zegar_pid = -1;
+            // Zegar mógł zginąć w połowie zapisu odliczania – migawka nie może czekać na niego w nieskończoność
+            wersja_napraw(&stan->wersja_meczu);
         }
 
-        ewakuacja(msgid_req, msgid_ticket, semid, stan);
+        ewakuacja(t, semid, stan);
         return 1; /* koniec */
     }
 
@@ -313,11 +346,9 @@ static int handle_cmd_master(int msgid_req, int msgid_ticket, int semid, SharedS
             return 0;
         }
 
-        MsgSterujacy msg = {10 + sektor, cmd, sektor};
-
-        /* msgsnd(): wysyła polecenie sterowania do pracownika sektora*/
-        if (msgsnd(msgid_req, &msg, sizeof(int) * 2, 0) == -1) {
-            if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(sterowanie)");
+        /* transport_steruj(): wysyła polecenie sterowania do pracownika sektora*/
+        if (transport_steruj(t, CEL_PRACOWNIK(sektor), cmd, sektor) == -1) {
+            if (!(errno == EIDRM || errno == EINVAL)) warn_errno("steruj(sterowanie)");
         }
         return 0;
     }
@@ -330,30 +361,20 @@ static int handle_cmd_master(int msgid_req, int msgid_ticket, int semid, SharedS
 int main() {
     setbuf(stdout, NULL);
 
-    /* msgget(): pobiera kolejkę żądań (kibic -> kasjer, oraz sterowanie sektorami) */
-    int msgid_req = msgget(KEY_MSG, 0600);
-    // Kończymy z komunikatem o błędzie
-    if (msgid_req == -1) die_errno("msgget(req)");
-
-    /* msgget(): pobiera kolejkę biletów (kasjer/kierownik -> kibic) */
-    int msgid_ticket = msgget(KEY_MSG_TICKET, 0600);
-    // Kończymy z komunikatem o błędzie
-    if (msgid_ticket == -1) die_errno("msgget(ticket)");
-
     /* semget(): pobiera istniejący zestaw semaforów*/
     int semid = semget(KEY_SEM, 0, 0600);
     // Kończymy z komunikatem o błędzie
     if (semid == -1) die_errno("semget");
 
-    /* shmget(): pobiera segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
     // Kończymy z komunikatem o błędzie
-    if (shmid == -1) die_errno("shmget");
+    if (!stan) die_errno("stan_podlacz");
 
-    /* shmat(): mapuje shm do pamięci procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
-    // Kończymy z komunikatem o błędzie
-    if (stan == (void*)-1) die_errno("shmat");
+    /* Transport sterowania (sektory, raporty, kontroler -> master) i anulowania kolejek – transport.h */
+    Transport transport;
+    if (transport_podlacz(&transport, stan) == -1) die_errno("transport_podlacz");
+    rola_gotowa(stan);
 
 /*
  * =============================
@@ -390,7 +411,7 @@ int main() {
             }
 
             if (cmd == 3) {
-                send_to_master(msgid_req, 3, -1);
+                send_to_master(&transport, 3, -1);
                 continue;
             }
 
@@ -403,21 +424,23 @@ int main() {
                 continue;
             }
 
-            send_to_master(msgid_req, cmd, s);
+            send_to_master(&transport, cmd, s);
         }
 
-        /* shmdt(): odłącza shm od procesu kierownika*/
-        if (shmdt(stan) == -1) warn_errno("shmdt");
+        /* stan_odlacz(): odłącza shm od procesu kierownika*/
+        transport_odlacz(&transport);
+        if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
         return 0;
     }
 
     /* Stan początkowy (tylko jeśli setup wyzerował stan)*/
     // Sprawdzamy czy trwa ewakuacja
     if (stan->status_meczu == 0 && stan->czas_pozostaly == 0 && !stan->ewakuacja_trwa) {
-        // Ustawiamy status meczu
+        // Ustawiamy status meczu i odliczanie razem (jedna zmiana w migawce)
+        wersja_zapis_start(&stan->wersja_meczu);
         stan->status_meczu = 0;
-        // Aktualizujemy odliczanie
         stan->czas_pozostaly = CZAS_PRZED_MECZEM;
+        wersja_zapis_koniec(&stan->wersja_meczu);
     }
 
     /* Zegar meczu uruchamia tylko master*/
@@ -432,8 +455,18 @@ int main() {
 
     fd_set readfds;
     struct timeval tv;
+    long long nastepny_takt = czas_ns();
 
     while (1) {
+        /* Takt kontrolera kas: jedna decyzja o kasach co TAKT_KAS_MS */
+        long long teraz = czas_ns();
+        if (teraz >= nastepny_takt) {
+            autoskaluj_kasy(stan, semid);
+            nastepny_takt += TAKT_KAS_MS * 1000000LL;
+            // Po dłuższej przerwie (np. komenda z klawiatury) nie nadrabiamy zaległych taktów
+            if (nastepny_takt < teraz) nastepny_takt = teraz + TAKT_KAS_MS * 1000000LL;
+        }
+
         /*
          * Sprawdzamy, czy zegar już się zakończył:
          * jeśli tak -> automatyczna ewakuacja
@@ -442,7 +475,7 @@ int main() {
             while (1) {
                 // Zbieramy zakończone procesy potomne
                 pid_t w = waitpid(zegar_pid, NULL, WNOHANG);
-                if (w > 0) { ewakuacja(msgid_req, msgid_ticket, semid, stan); goto out; }
+                if (w > 0) { ewakuacja(&transport, semid, stan); goto out; }
                 if (w == 0) break;
                 if (errno == EINTR) continue;
                 warn_errno("waitpid(WNOHANG)");
@@ -453,24 +486,27 @@ int main() {
         /* Odbiór komend od kontrolerów (nie blokuj) */
         while (1) {
             MsgSterujacy c;
-            /* msgrcv(): odbiera komunikat z kolejki*/
-            ssize_t r = msgrcv(msgid_req, &c, sizeof(int) * 2, MSGTYPE_KIEROWNIK_CTRL, IPC_NOWAIT);
-            if (r >= 0) {
-                if (handle_cmd_master(msgid_req, msgid_ticket, semid, stan, &zegar_pid, c.typ_sygnalu, c.sektor_id)) goto out;
+            /* transport_odbierz_sterowanie(): komenda od kontrolera, bez czekania*/
+            int r = transport_odbierz_sterowanie(&transport, CEL_MASTER, 0, &c);
+            if (r == 1) {
+                if (handle_cmd_master(&transport, semid, stan, &zegar_pid, c.typ_sygnalu, c.sektor_id)) goto out;
                 continue;
             }
 
-            if (errno == ENOMSG) break;
-            if (errno == EINTR) continue;
+            if (r == 0) break;
             if (errno == EIDRM || errno == EINVAL) goto out;
-            warn_errno("msgrcv(ctrl)");
+            warn_errno("odbierz(ctrl)");
             break;
         }
 
         FD_ZERO(&readfds);
         FD_SET(STDIN_FILENO, &readfds);
+        // Do następnego taktu kas, a po końcu sprzedaży (kontroler bezczynny) co 500 ms
+        long long do_taktu_us = (nastepny_takt - czas_ns()) / 1000;
+        if (stan->sprzedaz_zakonczona || do_taktu_us > 500000) do_taktu_us = 500000;
+        if (do_taktu_us < 0) do_taktu_us = 0;
         tv.tv_sec = 0;
-        tv.tv_usec = 500000;
+        tv.tv_usec = (suseconds_t)do_taktu_us;
 
         int ret = select(STDIN_FILENO + 1, &readfds, NULL, NULL, &tv);
         if (ret == -1) {
@@ -491,7 +527,7 @@ int main() {
             }
 
             if (cmd == 3) {
-                if (handle_cmd_master(msgid_req, msgid_ticket, semid, stan, &zegar_pid, 3, -1)) break;
+                if (handle_cmd_master(&transport, semid, stan, &zegar_pid, 3, -1)) break;
                 continue;
             }
 
@@ -505,7 +541,7 @@ int main() {
                     continue;
                 }
 
-                if (handle_cmd_master(msgid_req, msgid_ticket, semid, stan, &zegar_pid, cmd, s)) break;
+                if (handle_cmd_master(&transport, semid, stan, &zegar_pid, cmd, s)) break;
                 continue;
             }
 
@@ -515,8 +551,9 @@ int main() {
     }
 
 out:
-    /* shmdt(): odłącza shm od procesu kierownika*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    /* stan_odlacz(): odłącza shm od procesu kierownika*/
+    transport_odlacz(&transport);
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
 
     /* Na wszelki wypadek dobijam zegar jeśli jeszcze żyje
     kill(): wysyła sygnał do procesu*/
@@ -1,14 +1,51 @@
 #include "common.h"
+#include "kibic.h"
+#include "spawn.h"
+#include "przybycia.h"
 #include <sys/wait.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
 
 /*
  * Zadaniem pliku jest:
  *  1) podpiąć IPC (shm/sem/msg) utworzone wcześniej przez ./setup,
- *  2) uruchomić procesy: kierownik, pracownicy sektorów, kasjerzy,
- *  3) generować procesy kibiców w sposób kontrolowany (limit MAX_PROC),
- *  4) na końcu zebrać wszystkie dzieci.
+ *  2) uruchomić procesy: kierownik, pracownicy sektorów, pośrednik (koledzy), kasjerzy,
+ *  3) generować kibiców w sposób kontrolowany:
+ *      - "./main" albo "./main procesy": każdy kibic to osobny ./kibic uruchomiony przez
+ *        spawn_program() (posix_spawn, albo fork+exec po make SPAWN=fork; limit MAX_PROC),
+ *      - "./main zygota": kibiców forkuje (bez exec) zygota podpięta już do IPC,
+ *      - "./main watki [N]": kibice to wątki z puli (max N) w procesie main,
+ *      - "./main drzewo [N]": N podgeneratorów (fork main) tworzy kibiców równolegle,
+ *        każdy swój przedział id, ze slotami procesów rezerwowanymi paczkami,
+ *    a odstępy między kibicami wyznacza rozkład przybyć (przybycia.h): "stale" (domyślny,
+ *    pętla zamknięta), albo pętla otwarta "poisson" / "fala" / "rampa" z czasem zamierzonym,
+ *    albo "natychmiast" (wszyscy naraz – pomiar startu: "czas do N w kolejce"),
+ *  4) na końcu zebrać wszystkie dzieci, wypisać koszt tworzenia kibiców + szczytowy RSS
+ *     i wyeksportować histogramy opóźnień do metryki.txt.
  */
 
+#define TRYB_PROCESY 0
+#define TRYB_WATKI   1
+#define TRYB_ZYGOTA  2
+#define TRYB_DRZEWO  3
+
+static const char *const NAZWY_TRYBOW[] = {"procesy", "watki", "zygota", "drzewo"};
+
+/* Tryb drzewo: domyślna/maksymalna liczba podgeneratorów i wielkość paczki slotów procesów */
+#define PODGENERATORY_DOMYSLNIE 4
+#define PODGENERATORY_MAX       64
+#define PACZKA_SLOTOW           64
+
+/* Role uruchamiane przed generatorem: kierownik, pracownicy, pośrednik, kasjerzy */
+#define LICZBA_ROL (1 + LICZBA_SEKTOROW + 1 + LICZBA_KAS)
+
+/* Stos wątku-kibica: cykl życia to kilka ramek + printf, domyślne 8 MB to marnotrawstwo */
+#define STOS_WATKU_KIBICA (128 * 1024)
+
 static volatile sig_atomic_t g_stop = 0;
 
 static void on_stop_signal(int sig) {
@@ -30,19 +67,707 @@ static int sem_op_blocking(int semid, unsigned short num, short op) {
     return 0;
 }
 
+/*
+ * =====================
+ * PULA WĄTKÓW KIBICÓW
+ * =====================
+ * Tryb "watki": generator zamiast fork+exec wrzuca parametry kibica do kolejki,
+ * a wątki z puli wykonują kibic_zycie() na wspólnym, już podpiętym SharedState.
+ *
+ * Kibic blokuje wątek aż do ewakuacji, więc pula rośnie leniwie do max_watkow:
+ * nowy wątek powstaje tylko wtedy, gdy w kolejce czeka więcej zadań niż jest wolnych wątków.
+ * Gdy max_watkow < liczby kibiców, nadmiarowi czekają w kolejce na zwolniony wątek.
+ */
+typedef struct {
+    KibicIpc ipc;
+
+    KibicParametry *zadania;   /* bufor cykliczny */
+    int pojemnosc;
+    int glowa, ile;
+    int zamknieta;
+
+    pthread_t *watki;
+    int n_watkow;
+    int max_watkow;
+    int wolne;                 /* wątki czekające na zadanie */
+
+    pthread_attr_t attr;
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+} PulaKibicow;
+
+static void *watek_kibica(void *arg) {
+    PulaKibicow *pula = (PulaKibicow*)arg;
+
+    while (1) {
+        pthread_mutex_lock(&pula->mtx);
+        while (pula->ile == 0 && !pula->zamknieta) {
+            pula->wolne++;
+            pthread_cond_wait(&pula->cv, &pula->mtx);
+            pula->wolne--;
+        }
+        if (pula->ile == 0) {
+            pthread_mutex_unlock(&pula->mtx);
+            break;
+        }
+        KibicParametry p = pula->zadania[pula->glowa];
+        pula->glowa = (pula->glowa + 1) % pula->pojemnosc;
+        pula->ile--;
+        pthread_mutex_unlock(&pula->mtx);
+
+        (void)kibic_zycie(&p, &pula->ipc);
+    }
+    return NULL;
+}
+
+static int pula_init(PulaKibicow *pula, const KibicIpc *ipc, int pojemnosc, int max_watkow) {
+    memset(pula, 0, sizeof(*pula));
+    pula->ipc = *ipc;
+    pula->pojemnosc = pojemnosc;
+    pula->max_watkow = max_watkow;
+    pula->zadania = calloc((size_t)pojemnosc, sizeof(KibicParametry));
+    pula->watki = calloc((size_t)max_watkow, sizeof(pthread_t));
+    if (!pula->zadania || !pula->watki) {
+        free(pula->zadania);
+        free(pula->watki);
+        return -1;
+    }
+    pthread_mutex_init(&pula->mtx, NULL);
+    pthread_cond_init(&pula->cv, NULL);
+    pthread_attr_init(&pula->attr);
+    pthread_attr_setstacksize(&pula->attr, STOS_WATKU_KIBICA);
+    return 0;
+}
+
+// Zwraca 0 gdy kibic trafił do puli, -1 gdy kolejka pełna.
+static int pula_dodaj(PulaKibicow *pula, const KibicParametry *p) {
+    pthread_mutex_lock(&pula->mtx);
+    if (pula->ile == pula->pojemnosc) {
+        pthread_mutex_unlock(&pula->mtx);
+        return -1;
+    }
+    pula->zadania[(pula->glowa + pula->ile) % pula->pojemnosc] = *p;
+    pula->ile++;
+
+    if (pula->ile > pula->wolne && pula->n_watkow < pula->max_watkow) {
+        int e = pthread_create(&pula->watki[pula->n_watkow], &pula->attr, watek_kibica, pula);
+        if (e == 0) pula->n_watkow++;
+        else { errno = e; warn_errno("pthread_create(kibic)"); }
+    }
+    pthread_cond_signal(&pula->cv);
+    pthread_mutex_unlock(&pula->mtx);
+    return 0;
+}
+
+// Zamyka kolejkę i czeka, aż wszyscy kibice-wątki skończą (po ewakuacji).
+static void pula_zakoncz(PulaKibicow *pula) {
+    pthread_mutex_lock(&pula->mtx);
+    pula->zamknieta = 1;
+    pthread_cond_broadcast(&pula->cv);
+    pthread_mutex_unlock(&pula->mtx);
+
+    for (int i = 0; i < pula->n_watkow; i++) pthread_join(pula->watki[i], NULL);
+}
+
+/*
+ * ======
+ * ZYGOTA
+ * ======
+ * Tryb "zygota": jeden proces forkowany z main zaraz po podpięciu IPC.
+ * Ma już SharedState (stan_podlacz), semafory i kolejki, więc kibic tworzony przez fork()
+ * z zygoty pomija exec, ładowanie programu i stan_podlacz/semget/msgget.
+ *
+ * Zlecenia (MsgZygota) przychodzą osobną kolejką KEY_MSG_ZYGOTA:
+ *  - od generatora w main,
+ *  - od pośrednika (kolega z drugiego biletu, posrednik.c).
+ * Slot procesu rezerwuje zlecający; zygota cofa go tylko gdy fork padnie.
+ */
+static void zygota_petla(const KibicIpc *ipc, int msgid_zygota) {
+    // Zygota nie przejmuje obsługi Ctrl+C z main: killpg(SIGTERM) ma ją po prostu zabić
+    if (signal(SIGINT, SIG_DFL) == SIG_ERR) warn_errno("signal(SIGINT)");
+    if (signal(SIGTERM, SIG_DFL) == SIG_ERR) warn_errno("signal(SIGTERM)");
+    // Kibiców-dzieci sprząta kernel, zygota na nich nie czeka
+    if (signal(SIGCHLD, SIG_IGN) == SIG_ERR) warn_errno("signal(SIGCHLD)");
+    // Maska z main (SIGCHLD zablokowany dla reapera) nie dotyczy zygoty ani jej kibiców
+    sigset_t maska;
+    sigemptyset(&maska);
+    if (sigprocmask(SIG_SETMASK, &maska, NULL) == -1) warn_errno("sigprocmask(zygota)");
+
+    while (1) {
+        MsgZygota z;
+        /* msgrcv(): czekamy na zlecenie utworzenia kibica */
+        if (msgrcv(msgid_zygota, &z, sizeof(MsgZygota) - sizeof(long), MSGTYPE_ZYGOTA, 0) == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EIDRM || errno == EINVAL) break; /* kolejka skasowana */
+            warn_errno("msgrcv(zygota)");
+            break;
+        }
+        if (z.kibic_id == -1) break;
+
+        /* fork(): kibic dostaje kopię już podpiętego IPC */
+        pid_t p = fork();
+        if (p == -1) {
+            warn_errno("fork(zygota)");
+            // Cofamy rezerwację miejsca na proces
+            rollback_process_slot(ipc->stan, ipc->semid);
+            // Kolega nie powstał: cofamy drugi bilet, żeby nie było "biletu-ducha"
+            if (z.sektor >= 0) {
+                zablokuj(ipc->stan, ipc->semid, SEM_SPRZEDAZ);
+                wersja_zapis_start(&ipc->stan->wersja_sprzedazy);
+                if (ipc->stan->sprzedane_bilety[z.sektor] > 0) ipc->stan->sprzedane_bilety[z.sektor]--;
+                wersja_zapis_koniec(&ipc->stan->wersja_sprzedazy);
+                odblokuj(ipc->stan, ipc->semid, SEM_SPRZEDAZ);
+            }
+            continue;
+        }
+        if (p == 0) {
+            if (signal(SIGCHLD, SIG_DFL) == SIG_ERR) warn_errno("signal(SIGCHLD)");
+
+            KibicParametry kp;
+            memset(&kp, 0, sizeof(kp));
+            kp.id = z.kibic_id;
+            kp.is_vip = z.is_vip;
+            kp.ma_race = z.ma_race;
+            kp.ma_juz_bilet = z.ma_juz_bilet;
+            kp.t_zlecenia_ns = z.t_zlecenia_ns;
+            kp.t_zamiaru_ns = z.t_zamiaru_ns;
+            unsigned int ziarno = ziarno_dla(ipc->stan, ZIARNO_KIBIC, (unsigned int)kp.id);
+            kibic_losuj_cechy(&kp, &ziarno);
+
+            kibic_proces_koniec(ipc, kibic_zycie(&kp, ipc));
+        }
+    }
+
+    /* stan_odlacz(): odłącza shm od zygoty */
+    if (stan_odlacz(ipc->stan) == -1) warn_errno("stan_odlacz");
+    _exit(0);
+}
+
+static void zygota_zatrzymaj(int msgid_zygota) {
+    MsgZygota z;
+    memset(&z, 0, sizeof(z));
+    z.mtype = MSGTYPE_ZYGOTA;
+    z.kibic_id = -1;
+    while (msgsnd(msgid_zygota, &z, sizeof(MsgZygota) - sizeof(long), 0) == -1) {
+        if (errno == EINTR) continue;
+        if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(zygota stop)");
+        return;
+    }
+}
+
+/*
+ * ======================
+ * ZBIERANIE DZIECI (REAPER)
+ * ======================
+ * SIGCHLD jest zablokowany we wszystkich wątkach main (maskę dziedziczą wątki puli),
+ * a odbiera go osobny wątek przez signalfd. Generator tylko tworzy procesy:
+ * waitpid() wołamy dopiero wtedy, gdy kernel zgłosi zakończenie dziecka.
+ *
+ * zyjace = dokładna liczba żyjących dzieci main (role + kibice w trybie procesowym + zygota),
+ * kopiowana do stan->dzieci_main dla monitora. Licznik rośnie przed utworzeniem dziecka,
+ * więc reaper nigdy nie zejdzie poniżej zera.
+ *
+ * Czekanie na konkretne dziecko (kierownik, pośrednik) – reaper_sledz():
+ * rejestracja jest pod tym samym mutexem co waitpid(), więc zakończenia nie da się przegapić.
+ */
+#define REAPER_SLEDZONE 4
+
+typedef struct {
+    SharedState *stan;
+    int sfd;      /* signalfd(SIGCHLD) */
+    int stop_fd;  /* eventfd: main każe zakończyć wątek */
+    pthread_t watek;
+    pthread_mutex_t mtx;
+    pthread_cond_t cv; /* po każdym zebranym dziecku */
+    int zyjace;
+    pid_t sledzone[REAPER_SLEDZONE];
+    int zakonczone[REAPER_SLEDZONE];
+} Reaper;
+
+static void reaper_ustaw_licznik(Reaper *r, int delta) {
+    r->zyjace += delta;
+    __atomic_store_n(&r->stan->dzieci_main, r->zyjace, __ATOMIC_RELAXED);
+}
+
+// Zbiera wszystkie zakończone dzieci (wywoływane po sygnale z signalfd).
+static void reaper_zbierz(Reaper *r) {
+    pthread_mutex_lock(&r->mtx);
+    int zebrane = 0;
+    while (1) {
+        /* waitpid(WNOHANG): kilka SIGCHLD może zlać się w jeden – zbieramy do skutku */
+        pid_t w = waitpid(-1, NULL, WNOHANG);
+        if (w > 0) {
+            reaper_ustaw_licznik(r, -1);
+            for (int i = 0; i < REAPER_SLEDZONE; i++) if (r->sledzone[i] == w) r->zakonczone[i] = 1;
+            zebrane++;
+            continue;
+        }
+        if (w == -1 && errno == EINTR) continue;
+        if (w == -1 && errno != ECHILD) warn_errno("waitpid(reaper)");
+        break;
+    }
+    if (zebrane) pthread_cond_broadcast(&r->cv);
+    pthread_mutex_unlock(&r->mtx);
+}
+
+static void *watek_reapera(void *arg) {
+    Reaper *r = (Reaper*)arg;
+    struct pollfd fds[2] = {{r->sfd, POLLIN, 0}, {r->stop_fd, POLLIN, 0}};
+
+    while (1) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) continue;
+            warn_errno("poll(reaper)");
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            // Opróżniamy signalfd (nieblokujący), liczy się tylko to, że coś się zakończyło
+            struct signalfd_siginfo si[16];
+            while (read(r->sfd, si, sizeof(si)) > 0) {}
+            reaper_zbierz(r);
+        }
+        if (fds[1].revents & POLLIN) break;
+    }
+    reaper_zbierz(r);
+    return NULL;
+}
+
+// Blokuje SIGCHLD (przed utworzeniem jakiegokolwiek wątku) i uruchamia wątek reapera.
+static void reaper_start(Reaper *r, SharedState *stan) {
+    memset(r, 0, sizeof(*r));
+    r->stan = stan;
+    pthread_mutex_init(&r->mtx, NULL);
+    pthread_cond_init(&r->cv, NULL);
+
+    sigset_t maska;
+    sigemptyset(&maska);
+    sigaddset(&maska, SIGCHLD);
+    /* pthread_sigmask(): SIGCHLD czeka w kolejce na signalfd zamiast na handler */
+    int e = pthread_sigmask(SIG_BLOCK, &maska, NULL);
+    if (e != 0) { errno = e; die_errno("pthread_sigmask(SIGCHLD)"); }
+
+    /* signalfd()/eventfd(): CLOEXEC, żeby deskryptory nie wyciekły do ./kibic i ról */
+    r->sfd = signalfd(-1, &maska, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (r->sfd == -1) die_errno("signalfd");
+    r->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (r->stop_fd == -1) die_errno("eventfd");
+
+    e = pthread_create(&r->watek, NULL, watek_reapera, r);
+    if (e != 0) { errno = e; die_errno("pthread_create(reaper)"); }
+}
+
+static void reaper_zatrzymaj(Reaper *r) {
+    uint64_t jeden = 1;
+    if (write(r->stop_fd, &jeden, sizeof(jeden)) == -1) warn_errno("write(eventfd)");
+    pthread_join(r->watek, NULL);
+    close(r->sfd);
+    close(r->stop_fd);
+}
+
+/*
+ * Tworzy dziecko przez spawn_program() i wlicza je do żyjących.
+ * sledz=1: zakończenie tego pid-u będzie można odczekać w reaper_czekaj_pid().
+ */
+static pid_t reaper_spawn(Reaper *r, const char *sciezka, char *const argv[], int sledz) {
+    pthread_mutex_lock(&r->mtx);
+    reaper_ustaw_licznik(r, +1);
+    pid_t pid = spawn_program(sciezka, argv, &r->stan->lat[LAT_SPAWN]);
+    if (pid == -1) {
+        int e = errno;
+        reaper_ustaw_licznik(r, -1);
+        errno = e;
+    } else if (sledz) {
+        for (int i = 0; i < REAPER_SLEDZONE; i++) {
+            if (r->sledzone[i] == 0) { r->sledzone[i] = pid; break; }
+        }
+    }
+    pthread_mutex_unlock(&r->mtx);
+    return pid;
+}
+
+// Dziecko tworzone bez spawn_program() (fork zygoty): najpierw +1, przy błędzie -1.
+static void reaper_dodaj(Reaper *r, int delta) {
+    pthread_mutex_lock(&r->mtx);
+    reaper_ustaw_licznik(r, delta);
+    pthread_mutex_unlock(&r->mtx);
+}
+
+// Czeka na sygnał reapera (cv) co najwyżej ms milisekund; wołający trzyma mtx.
+static void reaper_czekaj_chwile(Reaper *r, int ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (long)ms * 1000000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+    (void)pthread_cond_timedwait(&r->cv, &r->mtx, &ts);
+}
+
+// Czeka na zakończenie śledzonego dziecka (przerywa g_stop).
+static void reaper_czekaj_pid(Reaper *r, pid_t pid) {
+    pthread_mutex_lock(&r->mtx);
+    int i = 0;
+    while (i < REAPER_SLEDZONE && r->sledzone[i] != pid) i++;
+    while (i < REAPER_SLEDZONE && !r->zakonczone[i] && !g_stop) reaper_czekaj_chwile(r, 100);
+    pthread_mutex_unlock(&r->mtx);
+}
+
+/*
+ * Czeka, aż żyjących dzieci będzie mniej niż limit.
+ * termin_ns == 0: do skutku albo do g_stop; inaczej najdłużej do czas_ns() == termin_ns.
+ * Zwraca 1, gdy warunek spełniony.
+ */
+static int reaper_czekaj_ponizej(Reaper *r, int limit, long long termin_ns) {
+    pthread_mutex_lock(&r->mtx);
+    while (r->zyjace >= limit && (termin_ns ? czas_ns() < termin_ns : !g_stop)) reaper_czekaj_chwile(r, 20);
+    int ok = r->zyjace < limit;
+    pthread_mutex_unlock(&r->mtx);
+    return ok;
+}
+
+// Pośrednik kończy się po opróżnieniu kolejki kolegów (posrednik_koniec + pobudka)
+static void posrednik_zatrzymaj(SharedState *stan, int semid) {
+    zablokuj(stan, semid, SEM_KOLEGI);
+    stan->posrednik_koniec = 1;
+    odblokuj(stan, semid, SEM_KOLEGI);
+    (void)sem_op_blocking(semid, SEM_POSREDNIK, +1);
+}
+
+/*
+ * ======================
+ * DRZEWO PODGENERATORÓW
+ * ======================
+ * "./main drzewo [N]": main nie tworzy kibiców sam, tylko forkuje N podgeneratorów
+ * (bez exec – mają już podpięte IPC). Podgenerator j:
+ *  - dostaje przedział id [j*T/N, (j+1)*T/N) i swoją część limitu VIP,
+ *  - rezerwuje sloty procesów paczkami po PACZKA_SLOTOW (jedno wejście pod SEM_SLOTY na paczkę,
+ *    nie na kibica) i oddaje niewykorzystaną resztę,
+ *  - uruchamia ./kibic przez spawn_program(), przybycia z tego samego rozkładu ze skalą N.
+ * Kibice są dziećmi podgeneratora: po wygenerowaniu zgłasza wynik przez shm
+ * (podgeneratory_*), czeka na swoich kibiców i kończy się po ostatnim,
+ * więc reaper main liczy tylko podgeneratory.
+ */
+typedef struct {
+    int nr, n;            /* numer podgeneratora i ilu ich jest */
+    int od, do_;          /* przedział id kibiców [od, do_) */
+    int max_vip;          /* część limitu VIP */
+    int rozklad;
+} Podgenerator;
+
+static void podgenerator_petla(SharedState *stan, int semid, const Podgenerator *pg) {
+    // Podgenerator nie przejmuje obsługi Ctrl+C z main: killpg(SIGTERM) ma go po prostu zabić
+    if (signal(SIGINT, SIG_DFL) == SIG_ERR) warn_errno("signal(SIGINT)");
+    if (signal(SIGTERM, SIG_DFL) == SIG_ERR) warn_errno("signal(SIGTERM)");
+    // Maska z main (SIGCHLD zablokowany dla reapera) nie dotyczy podgeneratora
+    sigset_t maska;
+    sigemptyset(&maska);
+    if (sigprocmask(SIG_SETMASK, &maska, NULL) == -1) warn_errno("sigprocmask(podgenerator)");
+
+    srand(ziarno_dla(stan, ZIARNO_GENERATOR, (unsigned int)pg->nr + 1));
+    Przybycia przybycia;
+    przybycia_init(&przybycia, pg->rozklad, ziarno_dla(stan, ZIARNO_PRZYBYCIA, (unsigned int)pg->nr + 1));
+    przybycia.skala = pg->n;
+
+    int sloty = 0, vip_cnt = 0, wygenerowani = 0;
+    long long czas_tworzenia_ns = 0;
+
+    for (int i = pg->od; i < pg->do_; i++) {
+        long long t_zamiaru = przybycia_czekaj(&przybycia);
+
+        /* Przerywamy generowanie, gdy trwa ewakuacja, sprzedaż jest zakończona albo mecz się skończył */
+        if (stan->ewakuacja_trwa || stan->sprzedaz_zakonczona || stan->status_meczu == 2) break;
+
+        /* VIP: jak w generatorze main, ale z limitem tego podgeneratora */
+        int is_vip = 0;
+        if (stan->standard_sold_out) {
+            if (vip_cnt >= pg->max_vip) break;
+            is_vip = 1;
+            vip_cnt++;
+        } else if (vip_cnt < pg->max_vip) {
+            if ((rand() % 1000 < 3) || (pg->do_ - i <= pg->max_vip - vip_cnt)) {
+                is_vip = 1;
+                vip_cnt++;
+            }
+        }
+
+        /* ~0.5% kibiców ma race*/
+        int has_raca = (rand() % 1000 < 5) ? 1 : 0;
+
+        hist_dodaj(&stan->lat[LAT_SPOZNIENIE_GENERATORA], czas_ns() - t_zamiaru);
+
+        // Sloty procesów bierzemy hurtem: jedna paczka na PACZKA_SLOTOW kibiców
+        if (sloty == 0) {
+            int ile = pg->do_ - i;
+            sloty = reserve_process_slots(stan, semid, ile < PACZKA_SLOTOW ? ile : PACZKA_SLOTOW);
+            if (sloty == 0) {
+                printf("Limit procesow osiagniety — podgenerator %d konczy generowanie.\n", pg->nr);
+                fflush(stdout);
+                break;
+            }
+        }
+
+        /* Tworzymy proces kibica*/
+        long long t0 = czas_ns();
+        char id[20], v[8], r[8], t[24], tz[24];
+        sprintf(id, "%d", i);
+        sprintf(v, "%d", is_vip);
+        sprintf(r, "%d", has_raca);
+        sprintf(t, "%lld", t0);
+        sprintf(tz, "%lld", t_zamiaru);
+
+        /* spawn_program(): uruchamia ./kibic (posix_spawn albo fork+exec)*/
+        char *argv_kibic[] = {"kibic", id, v, r, "0", t, tz, NULL};
+        if (spawn_program("./kibic", argv_kibic, &stan->lat[LAT_SPAWN]) == -1) {
+            warn_errno("spawn(kibic@podgenerator)");
+            break;
+        }
+        czas_tworzenia_ns += czas_ns() - t0;
+        sloty--;
+        wygenerowani++;
+    }
+
+    // Cofamy niewykorzystaną resztę paczki slotów
+    rollback_process_slots(stan, semid, sloty);
+
+    __atomic_add_fetch(&stan->podgeneratory_wygenerowani, wygenerowani, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stan->podgeneratory_czas_tworzenia_ns, czas_tworzenia_ns, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&stan->podgeneratory_pracuja, 1, __ATOMIC_RELEASE);
+
+    /* wait(): zbieramy własnych kibiców, dopiero potem kończy się podgenerator */
+    while (wait(NULL) != -1 || errno == EINTR) {}
+
+    /* stan_odlacz(): odłącza shm od podgeneratora */
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
+    _exit(0);
+}
+
+/*
+ * Forkuje n podgeneratorów i czeka, aż wszystkie skończą generować (albo g_stop).
+ * Zwraca łączną liczbę utworzonych kibiców, koszt ich tworzenia dopisuje do *czas_tworzenia_ns.
+ */
+static int drzewo_generuj(Reaper *r, SharedState *stan, int semid, int n, int total_kibicow,
+                          int max_vip, int rozklad, long long *czas_tworzenia_ns) {
+    __atomic_store_n(&stan->podgeneratory_pracuja, n, __ATOMIC_RELEASE);
+
+    for (int j = 0; j < n; j++) {
+        Podgenerator pg = {j, n, (int)((long long)total_kibicow * j / n),
+                           (int)((long long)total_kibicow * (j + 1) / n),
+                           max_vip / n + (j < max_vip % n), rozklad};
+
+        // Podgenerator też jest procesem: zajmuje slot jak każda rola
+        if (!reserve_process_slot(stan, semid)) {
+            fprintf(stderr, "Osiagnieto limit procesow\n");
+            __atomic_sub_fetch(&stan->podgeneratory_pracuja, n - j, __ATOMIC_RELEASE);
+            break;
+        }
+        reaper_dodaj(r, +1);
+        /* fork(): podgenerator dostaje kopię już podpiętego IPC */
+        pid_t p = fork();
+        if (p == -1) {
+            warn_errno("fork(podgenerator)");
+            reaper_dodaj(r, -1);
+            // Cofamy rezerwację miejsca na proces
+            rollback_process_slot(stan, semid);
+            __atomic_sub_fetch(&stan->podgeneratory_pracuja, n - j, __ATOMIC_RELEASE);
+            break;
+        }
+        if (p == 0) podgenerator_petla(stan, semid, &pg);
+    }
+
+    /* Podgeneratory zgłaszają koniec przez shm; sprawdzamy co 1 ms (nie blokuje to ich pracy) */
+    while (__atomic_load_n(&stan->podgeneratory_pracuja, __ATOMIC_ACQUIRE) > 0 && !g_stop) usleep(1000);
+
+    *czas_tworzenia_ns += __atomic_load_n(&stan->podgeneratory_czas_tworzenia_ns, __ATOMIC_RELAXED);
+    return __atomic_load_n(&stan->podgeneratory_wygenerowani, __ATOMIC_RELAXED);
+}
+
+// Zamiast stałego sleep(1): czekamy, aż role podepną się do IPC (najdłużej 1 s, jak dawniej)
+static void czekaj_na_role(SharedState *stan, int ile) {
+    long long termin = czas_ns() + 1000000000LL;
+    while (__atomic_load_n(&stan->gotowe_role, __ATOMIC_ACQUIRE) < ile && czas_ns() < termin && !g_stop) {
+        usleep(1000);
+    }
+}
+
+/*
+ * Podsumowanie wydajności: stdout + metryki.txt.
+ *  - koszt/tempo: ile kosztuje samo utworzenie kibica (spawn / zlecenie zygocie / oddanie do puli),
+ *  - RSS: ru_maxrss procesu main (w trybie wątkowym obejmuje wszystkich kibiców)
+ *    oraz największego zebranego dziecka (w trybie procesowym ~ jeden kibic),
+ *  - CPU: user/sys main i zebranych dzieci,
+ *  - histogramy LAT_* zbierane przez wszystkie procesy w SharedState.
+ */
+static void wypisz_metryki(FILE *f, SharedState *stan, int tryb, int rozklad, int generated,
+                           long long czas_tworzenia_ns, long long czas_generatora_ns) {
+    struct rusage ru_self, ru_dzieci;
+    if (getrusage(RUSAGE_SELF, &ru_self) == -1) warn_errno("getrusage(SELF)");
+    if (getrusage(RUSAGE_CHILDREN, &ru_dzieci) == -1) warn_errno("getrusage(CHILDREN)");
+
+    double sr_us = generated ? (double)czas_tworzenia_ns / generated / 1000.0 : 0.0;
+    double tempo = czas_tworzenia_ns ? generated * 1e9 / (double)czas_tworzenia_ns : 0.0;
+    double tempo_sciana = czas_generatora_ns ? generated * 1e9 / (double)czas_generatora_ns : 0.0;
+    fprintf(f, "[MAIN] Tryb: %s (%s, synchro: %s, bramki: %s, transport: %s, pamięć: %s/%s, przybycia: %s, ziarno=%u) | "
+               "kibiców: %d | koszt utworzenia: %.1f us | tempo tworzenia: %.0f/s (z odstępami: %.0f/s)\n",
+            NAZWY_TRYBOW[tryb], SPAWN_BACKEND, SYNC_BACKEND, BRAMKI_BACKEND, transport_nazwa(stan->transport),
+            pamiec_nazwa(stan->pamiec), strony_nazwa(stan->strony), NAZWY_ROZKLADOW[rozklad], stan->ziarno, generated,
+            sr_us, tempo, tempo_sciana);
+    fprintf(f, "[MAIN] Szczytowy RSS: main %ld KB | największe dziecko %ld KB\n",
+            ru_self.ru_maxrss, ru_dzieci.ru_maxrss);
+    // Czas CPU (user/sys) – m.in. do porównania backendów synchro.h: semop() to zawsze wywołanie systemowe
+    fprintf(f, "[MAIN] CPU: main user %.2f s sys %.2f s | dzieci user %.2f s sys %.2f s\n",
+            ru_self.ru_utime.tv_sec + ru_self.ru_utime.tv_usec / 1e6,
+            ru_self.ru_stime.tv_sec + ru_self.ru_stime.tv_usec / 1e6,
+            ru_dzieci.ru_utime.tv_sec + ru_dzieci.ru_utime.tv_usec / 1e6,
+            ru_dzieci.ru_stime.tv_sec + ru_dzieci.ru_stime.tv_usec / 1e6);
+
+    // Ten sam format co "[DES] Statystyki" z ./des – do porównania przebiegów
+    fprintf(f, "[MAIN] Statystyki: weszlo=%d opiekun=%d kolega=%d agresja=%d | sprzedane:",
+            __atomic_load_n(&stan->cnt_weszlo, __ATOMIC_RELAXED), __atomic_load_n(&stan->cnt_opiekun, __ATOMIC_RELAXED),
+            __atomic_load_n(&stan->cnt_kolega, __ATOMIC_RELAXED), __atomic_load_n(&stan->cnt_agresja, __ATOMIC_RELAXED));
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) fprintf(f, " %d", stan->sprzedane_bilety[s]);
+    fprintf(f, " VIP %d\n", stan->sprzedane_bilety[SEKTOR_VIP]);
+
+    // Tempo obsługi jednej kasy = 1 / średni czas obsługi klienta (LAT_OBSLUGA_KASY)
+    // Paczki kasjerów (./main paczka=N): tempo jednej kasy = bilety na sekundę pracy nad paczkami,
+    // wejścia SEM_SPRZEDAZ na bilet pokazują, ile blokad rozkłada się na jeden bilet
+    const Histogram *hk = &stan->lat[LAT_OBSLUGA_KASY];
+    int paczki = __atomic_load_n(&stan->kasjerzy_paczki, __ATOMIC_RELAXED);
+    int zadania = __atomic_load_n(&stan->kasjerzy_zadania, __ATOMIC_RELAXED);
+    int bilety = __atomic_load_n(&stan->kasjerzy_bilety, __ATOMIC_RELAXED);
+    long long praca_ns = __atomic_load_n(&stan->kasjerzy_praca_ns, __ATOMIC_RELAXED);
+    fprintf(f, "[MAIN] Kasy (paczka=%d): obsłużono %llu klientów w %d paczkach (śr. %.2f) | bilety: %d | "
+               "tempo jednej kasy: %.1f biletów/s | SEM_SPRZEDAZ na bilet: %.3f\n",
+            stan->paczka_kasy, hk->n, paczki, paczki ? (double)zadania / paczki : 0.0, bilety,
+            praca_ns ? bilety * 1e9 / (double)praca_ns : 0.0,
+            bilety ? (double)__atomic_load_n(&stan->blokady[SEM_SPRZEDAZ].wejscia, __ATOMIC_RELAXED) / bilety : 0.0);
+
+    // Kasjerzy bez klientów śpią na dzwonku (common.h): CPU wszystkich kas i ile uśpień przerwał dzwonek;
+    // kasy otwiera i zamyka kontroler w kierowniku (autoskaluj_kasy) – liczba jego decyzji
+    fprintf(f, "[MAIN] Kasjerzy: CPU %.3f s łącznie | uśpienia %d (pobudki %d, limit czasu %d) | "
+               "kontroler kas (takt %d ms): otwarcia %d, zamknięcia %d\n",
+            __atomic_load_n(&stan->kasjerzy_cpu_ns, __ATOMIC_RELAXED) / 1e9,
+            __atomic_load_n(&stan->kasjerzy_uspienia, __ATOMIC_RELAXED),
+            __atomic_load_n(&stan->kasjerzy_pobudki, __ATOMIC_RELAXED),
+            __atomic_load_n(&stan->kasjerzy_uspienia, __ATOMIC_RELAXED) -
+                __atomic_load_n(&stan->kasjerzy_pobudki, __ATOMIC_RELAXED),
+            TAKT_KAS_MS, __atomic_load_n(&stan->kasy_otwarcia, __ATOMIC_RELAXED),
+            __atomic_load_n(&stan->kasy_zamkniecia, __ATOMIC_RELAXED));
+
+    /*
+     * Bramki (kibic_zycie.c): nieudane próby wejścia na jedno wejście (polling: każde ponowienie,
+     * futex: każda pobudka bez miejsca) i wykorzystanie miejsc = zajętość (osoba * czas)
+     * / (2 bramki * MAX_NA_STANOWISKU * okno od pierwszego wejścia do ostatniego wyjścia), średnio po sektorach.
+     */
+    unsigned long long proby = 0;
+    double wykorzystanie = 0.0;
+    int sektory_z_ruchem = 0;
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) {
+        const StanSektora *sek = &stan->sektory[s];
+        proby += sek->proby_nieudane;
+        long long okno = sek->t_ostatnie_wyjscie_ns - sek->t_pierwsze_wejscie_ns;
+        if (sek->t_pierwsze_wejscie_ns == 0 || okno <= 0) continue;
+        wykorzystanie += (double)sek->zajete_ns / (2.0 * MAX_NA_STANOWISKU * okno);
+        sektory_z_ruchem++;
+    }
+    const Histogram *hb = &stan->lat[LAT_CZEKANIE_NA_BRAMKE];
+    fprintf(f, "[MAIN] Bramki (%s): wejść %llu | nieudane próby %llu (%.2f na wejście) | "
+               "wykorzystanie miejsc %.1f%% | śr. czekanie %.1f ms\n",
+            BRAMKI_BACKEND, hb->n, proby, hb->n ? (double)proby / hb->n : 0.0,
+            sektory_z_ruchem ? 100.0 * wykorzystanie / sektory_z_ruchem : 0.0, hb->n ? hb->suma_ns / 1e6 / hb->n : 0.0);
+
+    // Rywalizacja o mutexy (synchro.h): ile wejść musiało czekać; sektory zsumowane
+    static const char *const NAZWY_BLOKAD[SEM_SEKTOR_START] = {"sprzedaz", "kasy", "sloty", "kolegi"};
+    fprintf(f, "[MAIN] Blokady (czekania/wejścia):");
+    for (int i = 0; i <= SEM_SEKTOR_START; i++) {
+        unsigned long long we = 0, cz = 0;
+        for (int j = i; j < (i < SEM_SEKTOR_START ? i + 1 : LICZBA_MUTEXOW); j++) {
+            we += __atomic_load_n(&stan->blokady[j].wejscia, __ATOMIC_RELAXED);
+            cz += __atomic_load_n(&stan->blokady[j].czekania, __ATOMIC_RELAXED);
+        }
+        fprintf(f, "%s %s %llu/%llu (%.2f%%)", i ? " |" : "", i < SEM_SEKTOR_START ? NAZWY_BLOKAD[i] : "sektory",
+                cz, we, we ? 100.0 * cz / we : 0.0);
+    }
+    fprintf(f, "\n");
+
+    // Pomiar startu: czas od startu generatora do N-tego kibica w kolejce do kas
+    int w_kolejce = __atomic_load_n(&stan->w_kolejce, __ATOMIC_RELAXED);
+    if (w_kolejce > 0 && stan->start_generatora_ns > 0) {
+        fprintf(f, "[MAIN] Start: w kolejce do kas %d kibiców | czas do N w kolejce:", w_kolejce);
+        for (int n = 1; n <= w_kolejce / START_PROG && n <= K / START_PROG; n++) {
+            fprintf(f, " %d: %.1f ms |", n * START_PROG,
+                    (stan->t_w_kolejce_ns[n] - stan->start_generatora_ns) / 1e6);
+        }
+        fprintf(f, " ostatni: %.1f ms\n", (stan->t_ostatni_w_kolejce_ns - stan->start_generatora_ns) / 1e6);
+    }
+
+    for (int i = 0; i < LAT_N; i++) hist_wypisz(f, NAZWY_LAT[i], &stan->lat[i]);
+    fflush(f);
+}
+
+static void zapisz_metryki(SharedState *stan, int tryb, int rozklad, int generated,
+                           long long czas_tworzenia_ns, long long czas_generatora_ns) {
+    wypisz_metryki(stdout, stan, tryb, rozklad, generated, czas_tworzenia_ns, czas_generatora_ns);
+    FILE *mf = fopen("metryki.txt", "w");
+    if (!mf) warn_errno("fopen(metryki.txt)");
+    else {
+        wypisz_metryki(mf, stan, tryb, rozklad, generated, czas_tworzenia_ns, czas_generatora_ns);
+        if (fclose(mf) == EOF) warn_errno("fclose(metryki.txt)");
+    }
+}
+
 static void request_shutdown(SharedState *stan, int semid) {
-    if (sem_op_blocking(semid, SEM_SHM, -1) == -1) return;
+    zablokuj(stan, semid, SEM_SPRZEDAZ);
     // Ustawiamy globalny koniec sprzedaży
     stan->sprzedaz_zakonczona = 1;
-    // Ogłaszamy ewakuację
-    stan->ewakuacja_trwa = 1;
-    (void)sem_op_blocking(semid, SEM_SHM, +1);
+    odblokuj(stan, semid, SEM_SPRZEDAZ);
+    // Ogłaszamy ewakuację (flaga sterująca, jak u kierownika – bez blokady)
+    __atomic_store_n(&stan->ewakuacja_trwa, 1, __ATOMIC_SEQ_CST);
+    // Śpiący kasjerzy (dzwonek / zamknięta kasa) i kibice pod bramkami sprawdzą flagi od razu
+    kasy_obudz(stan);
+    bramki_obudz(stan);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     setbuf(stdout, NULL);
 
-    if (K > MAX_PROC - 2000) {
+    int tryb = TRYB_PROCESY;
+    int max_watkow = 0;
+    int n_podgeneratorow = PODGENERATORY_DOMYSLNIE;
+    int rozklad = ROZKLAD_STALY;
+    unsigned int ziarno = 0;
+    int paczka = 1;
+    int transport_rodzaj = TRANSPORT_SHM;
+    // Tryb, liczba wątków, rozkład przybyć, ziarno, paczka kasjera i transport w dowolnej kolejności,
+    // np. "./main watki 64 poisson ziarno=7 paczka=8 transport=sysv"
+    for (int a = 1; a < argc; a++) {
+        int r = rozklad_z_nazwy(argv[a]);
+        if (r >= 0) rozklad = r;
+        else if (strncmp(argv[a], "ziarno=", 7) == 0 && strtoul(argv[a] + 7, NULL, 10) > 0) {
+            ziarno = (unsigned int)strtoul(argv[a] + 7, NULL, 10);
+        }
+        else if (strncmp(argv[a], "paczka=", 7) == 0 && atoi(argv[a] + 7) >= 1 && atoi(argv[a] + 7) <= PACZKA_KASY_MAX) {
+            paczka = atoi(argv[a] + 7);
+        }
+        else if (strncmp(argv[a], "transport=", 10) == 0 && transport_z_nazwy(argv[a] + 10) >= 0) {
+            transport_rodzaj = transport_z_nazwy(argv[a] + 10);
+        }
+        else if (strcmp(argv[a], "watki") == 0) tryb = TRYB_WATKI;
+        else if (strcmp(argv[a], "zygota") == 0) tryb = TRYB_ZYGOTA;
+        else if (strcmp(argv[a], "procesy") == 0) tryb = TRYB_PROCESY;
+        else if (strcmp(argv[a], "drzewo") == 0) tryb = TRYB_DRZEWO;
+        else if (tryb == TRYB_WATKI && atoi(argv[a]) > 0) max_watkow = atoi(argv[a]);
+        else if (tryb == TRYB_DRZEWO && atoi(argv[a]) > 0 && atoi(argv[a]) <= PODGENERATORY_MAX) {
+            n_podgeneratorow = atoi(argv[a]);
+        } else {
+            fprintf(stderr, "Użycie: %s [procesy | zygota | watki [max_watkow] | drzewo [podgeneratory 1..%d]] "
+                            "[stale | poisson | fala | rampa | natychmiast] [ziarno=N] [paczka=1..%d] "
+                            "[transport=shm|sysv|posix]\n",
+                    argv[0], PODGENERATORY_MAX, PACZKA_KASY_MAX);
+            return 1;
+        }
+    }
+
+    /* Limit MAX_PROC dotyczy tylko trybu procesowego – wątki-kibice nie zajmują slotów. */
+    if (tryb != TRYB_WATKI && K > MAX_PROC - 2000) {
         fprintf(stderr, "Zdefiniowano za duzo kibicow. W common.h zmien K na liczbę z przedziału od 1 do %d\n", MAX_PROC-2000);
         return 1;
     }
@@ -55,38 +780,76 @@ int main() {
     if (sigaction(SIGINT, &sa, NULL) == -1) warn_errno("sigaction(SIGINT)");
     if (sigaction(SIGTERM, &sa, NULL) == -1) warn_errno("sigaction(SIGTERM)");
 
-    /* shmget(): pobiera istniejący segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    if (shmid == -1) {
-        warn_errno("shmget");
-        fprintf(stderr, "Uruchom najpierw ./setup\n");
-        /* exit(): kończy proces z kodem błędu*/
-        exit(EXIT_FAILURE);
-    }
-
     /* semget(): pobiera istniejący zestaw semaforów*/
     int semid = semget(KEY_SEM, 0, 0600);
     // Kończymy z komunikatem o błędzie
     if (semid == -1) die_errno("semget");
 
-    /* msgget(): pobiera istniejącą kolejkę komunikatów*/
-    int msgid = msgget(KEY_MSG, 0600);
+    /* msgget(): kolejka zleceń dla zygoty */
+    int msgid_zygota = msgget(KEY_MSG_ZYGOTA, 0600);
     // Kończymy z komunikatem o błędzie
-    if (msgid == -1) die_errno("msgget");
-    (void)msgid;
+    if (msgid_zygota == -1) die_errno("msgget(zygota)");
 
-    /* shmat(): mapuje shm do pamięci procesu, żeby czytać/ustawiać stan symulacji*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
-    // Kończymy z komunikatem o błędzie
-    if (stan == (void*)-1) die_errno("shmat");
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
+    if (!stan) {
+        warn_errno("stan_podlacz");
+        fprintf(stderr, "Uruchom najpierw ./setup\n");
+        /* exit(): kończy proces z kodem błędu*/
+        exit(EXIT_FAILURE);
+    }
+
+    /* Ziarno przebiegu – przed startem ról, bo losują z niego kasjerzy, pośrednik i kibice (ziarno_dla) */
+    if (ziarno == 0) ziarno = (unsigned int)(time(NULL) ^ (getpid() << 16));
+    if (ziarno == 0) ziarno = 1;
+    stan->ziarno = ziarno;
+    stan->paczka_kasy = paczka;
+    stan->transport = transport_rodzaj;
+
+    /* Transport komunikatów (transport.h) – main potrzebuje go dla kibiców-wątków i dzieci zygoty */
+    Transport transport;
+    if (transport_podlacz(&transport, stan) == -1) {
+        warn_errno("transport_podlacz");
+        fprintf(stderr, "Transport %s niedostępny (./setup nie utworzył kolejek?)\n", transport_nazwa(transport_rodzaj));
+        if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
+        exit(EXIT_FAILURE);
+    }
 
     /* Limit VIP*/
     int max_vip = (int)(K * 0.003);
     if (max_vip < 1) max_vip = 1;
 
+    /* Reaper startuje przed pierwszym dzieckiem i przed wątkami puli (dziedziczą maskę SIGCHLD) */
+    Reaper reaper;
+    reaper_start(&reaper, stan);
+
     printf("--- START SYMULACJI ---\n");
     fflush(stdout);
 
+    /* Zygota startuje pierwsza: jest mała i ma już podpięte całe IPC. */
+    if (tryb == TRYB_ZYGOTA) {
+        if (!reserve_process_slot(stan, semid)) {
+            fprintf(stderr, "Osiagnieto limit procesow\n");
+            if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
+            return 1;
+        }
+        reaper_dodaj(&reaper, +1);
+        pid_t zp = fork();
+        if (zp == -1) {
+            reaper_dodaj(&reaper, -1);
+            // Cofamy rezerwację miejsca na proces
+            rollback_process_slot(stan, semid);
+            // Kończymy z komunikatem o błędzie
+            die_errno("fork(zygota)");
+        }
+        if (zp == 0) {
+            KibicIpc ipc = {stan, semid, &transport};
+            zygota_petla(&ipc, msgid_zygota);
+        }
+        // Pośrednik (startuje niżej) zleca kolegów zygocie, gdy to pole != 0
+        stan->zygota_pid = zp;
+    }
+
 /*
  * ======================
  * URUCHAMIANIE PROCESÓW
@@ -94,6 +857,7 @@ int main() {
  * Każdy element symulacji jest osobnym procesem:
  *  - kierownik: steruje sygnałami 1/2/3 i (jako master) zegarem meczu,
  *  - pracownik(sektor): wykonuje blokadę/odblokowanie i ewakuację sektora,
+ *  - pośrednik: tworzy kolegów z drugiego biletu zleconych przez kasjerów,
  *  - kasjer(kasa): obsługuje kolejki, sprzedaje bilety,
  *  - kibic: klient kas + próba wejścia przez bramki + zachowania (agresja).
  *
@@ -103,22 +867,18 @@ int main() {
     // Sprawdzamy czy wolno jeszcze tworzyć procesy
     if (!reserve_process_slot(stan, semid)) {
         fprintf(stderr, "Osiagnieto limit procesow\n");
-        if (shmdt(stan) == -1) warn_errno("shmdt");
+        if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
         return 1;
     }
     /* Start procesu kierownika. */
-    /* fork(): tworzy proces*/
-    pid_t pid = fork();
+    /* spawn_program(): posix_spawn (albo fork+exec) programu ./kierownik*/
+    char *argv_kierownik[] = {"kierownik", NULL};
+    pid_t pid = reaper_spawn(&reaper, "./kierownik", argv_kierownik, 1);
     if (pid == -1) {
         // Cofamy rezerwację miejsca na proces
         rollback_process_slot(stan, semid);
         // Kończymy z komunikatem o błędzie
-        die_errno("fork(kierownik)");
-    }
-    if (pid == 0) {
-        /* exec(): uruchamia program ./kierownik*/
-        execl("./kierownik", "kierownik", NULL);
-        die_errno("execl(kierownik)");
+        die_errno("spawn(kierownik)");
     }
 
     /* Start 8 pracowników*/
@@ -130,20 +890,36 @@ int main() {
             g_stop = 1;
             break;
         }
-        /* fork(): tworzy proces*/
-        pid_t p = fork();
-        if (p == -1) {
+        char b[10];
+        sprintf(b, "%d", i);
+        /* spawn_program(): uruchamia ./pracownik*/
+        char *argv_pracownik[] = {"pracownik", b, NULL};
+        if (reaper_spawn(&reaper, "./pracownik", argv_pracownik, 0) == -1) {
             // Cofamy rezerwację miejsca na proces
             rollback_process_slot(stan, semid);
             // Kończymy z komunikatem o błędzie
-            die_errno("fork(pracownik)");
+            die_errno("spawn(pracownik)");
         }
-        if (p == 0) {
-            char b[10];
-            sprintf(b, "%d", i);
-            /* exec(): uruchamia ./pracownik*/
-            execl("./pracownik", "pracownik", b, NULL);
-            die_errno("execl(pracownik)");
+    }
+
+    /* Start pośrednika – musi działać, zanim kasjerzy zaczną zlecać kolegów */
+    pid_t pid_posrednik = -1;
+    if (!g_stop) {
+        // Sprawdzamy czy wolno jeszcze tworzyć procesy
+        if (!reserve_process_slot(stan, semid)) {
+            fprintf(stderr, "Osiagnieto limit procesow\n");
+            request_shutdown(stan, semid);
+            g_stop = 1;
+        } else {
+            /* spawn_program(): uruchamia ./posrednik*/
+            char *argv_posrednik[] = {"posrednik", NULL};
+            pid_posrednik = reaper_spawn(&reaper, "./posrednik", argv_posrednik, 1);
+            if (pid_posrednik == -1) {
+                // Cofamy rezerwację miejsca na proces
+                rollback_process_slot(stan, semid);
+                // Kończymy z komunikatem o błędzie
+                die_errno("spawn(posrednik)");
+            }
         }
     }
 
@@ -157,20 +933,15 @@ int main() {
             g_stop = 1;
             break;
         }
-        /* fork(): tworzy proces*/
-        pid_t p = fork();
-        if (p == -1) {
+        char b[10];
+        sprintf(b, "%d", i);
+        /* spawn_program(): uruchamia ./kasjer*/
+        char *argv_kasjer[] = {"kasjer", b, NULL};
+        if (reaper_spawn(&reaper, "./kasjer", argv_kasjer, 0) == -1) {
             // Cofamy rezerwację miejsca na proces
             rollback_process_slot(stan, semid);
             // Kończymy z komunikatem o błędzie
-            die_errno("fork(kasjer)");
-        }
-        if (p == 0) {
-            char b[10];
-            sprintf(b, "%d", i);
-            /* exec(): uruchamia ./kasjer*/
-            execl("./kasjer", "kasjer", b, NULL);
-            die_errno("execl(kasjer)");
+            die_errno("spawn(kasjer)");
         }
     }
 
@@ -190,49 +961,50 @@ int main() {
 
     
     int total_kibicow = (int)(K*0.85);
-    int active = 0, vip_cnt = 0;
+    int vip_cnt = 0;
 
     int stopped_by_match_end = 0;
     int generated = 0;
 
+    /* Tryb wątkowy: pula wątków na wspólnym (już podpiętym) SharedState */
+    PulaKibicow pula;
+    if (tryb == TRYB_WATKI) {
+        KibicIpc ipc = {stan, semid, &transport};
+        if (max_watkow <= 0) max_watkow = total_kibicow;
+        if (pula_init(&pula, &ipc, total_kibicow, max_watkow) == -1) die_errno("calloc(pula)");
+    }
+
+    /* Pomiar kosztu tworzenia kibica: czas spawn_program(), zlecenia dla zygoty albo oddania zadania do puli */
+    long long czas_tworzenia_ns = 0;
+
     if (time(NULL) == (time_t)-1) warn_errno("time");
-    srand((unsigned)time(NULL));
-    sleep(1);
+    srand(ziarno_dla(stan, ZIARNO_GENERATOR, 0));
+    Przybycia przybycia;
+    przybycia_init(&przybycia, rozklad, ziarno_dla(stan, ZIARNO_PRZYBYCIA, 0));
+    czekaj_na_role(stan, LICZBA_ROL);
+
+    long long start_generatora = czas_ns();
+    stan->start_generatora_ns = start_generatora;
+
+    if (tryb == TRYB_DRZEWO) {
+        generated = drzewo_generuj(&reaper, stan, semid, n_podgeneratorow, total_kibicow, max_vip, rozklad,
+                                   &czas_tworzenia_ns);
+        if (g_stop) request_shutdown(stan, semid);
+        else if (stan->status_meczu == 2) stopped_by_match_end = 1;
+    }
+
+    for (int i = 0; tryb != TRYB_DRZEWO && i < total_kibicow; i++) {
+        /* Czekamy na (zamierzony) czas przybycia kolejnego kibica */
+        long long t_zamiaru = przybycia_czekaj(&przybycia);
 
-    for (int i = 0; i < total_kibicow; i++) {
         /* Jeśli Ctrl+C, kończymy generowanie i przechodzimy do sprzątania*/
         if (g_stop) {
             request_shutdown(stan, semid);
             break;
         }
 
-        while (1) {
-            /* waitpid(WNOHANG): zbiera zakończone dzieci żeby nie powstały zombie*/
-            pid_t w = waitpid(-1, NULL, WNOHANG);
-            if (w > 0) { active--; continue; }
-            if (w == 0) break;
-
-            if (errno == EINTR) {
-                if (g_stop) break;
-                continue;
-            }
-            // Zbieramy zakończone procesy potomne
-            if (errno != ECHILD) warn_errno("waitpid(WNOHANG)");
-            break;
-        }
-
-        if (active >= MAX_PROC) {
-            while (1) {
-                pid_t w = wait(NULL);
-                if (w > 0) { active--; break; }
-                if (errno == EINTR) {
-                    if (g_stop) break;
-                    continue;
-                }
-                if (errno != ECHILD) warn_errno("wait");
-                break;
-            }
-        }
+        /* Zakończone dzieci zbiera reaper; tu tylko nie przekraczamy MAX_PROC żyjących */
+        if (tryb == TRYB_PROCESY) (void)reaper_czekaj_ponizej(&reaper, MAX_PROC, 0);
 
         /* Przerywamy generowanie, gdy trwa ewakuacja lub sprzedaż jest zakończona*/
         if (stan->ewakuacja_trwa) break;
@@ -263,54 +1035,97 @@ int main() {
             }
         }
 
-        
-        
+        /* ~0.5% kibiców ma race*/
+        int has_raca = (rand() % 1000 < 5) ? 1 : 0;
+
+        // O ile generator (reaper, brak slotu, poprzedni spawn) spóźnił się względem harmonogramu
+        hist_dodaj(&stan->lat[LAT_SPOZNIENIE_GENERATORA], czas_ns() - t_zamiaru);
+
+        if (tryb == TRYB_WATKI) {
+            KibicParametry p;
+            memset(&p, 0, sizeof(p));
+            p.id = i;
+            p.is_vip = is_vip;
+            p.ma_race = has_raca;
+            unsigned int ziarno_kibica = ziarno_dla(stan, ZIARNO_KIBIC, (unsigned int)i);
+            kibic_losuj_cechy(&p, &ziarno_kibica);
+
+            long long t0 = czas_ns();
+            p.t_zlecenia_ns = t0;
+            p.t_zamiaru_ns = t_zamiaru;
+            int rc = pula_dodaj(&pula, &p);
+            czas_tworzenia_ns += czas_ns() - t0;
+            if (rc == -1) {
+                printf("Kolejka puli wątków pełna — koncze generowanie.\n");
+                fflush(stdout);
+                break;
+            }
+
+            generated++;
+            continue;
+        }
+
         // Sprawdzamy czy wolno jeszcze tworzyć procesy
         if (!reserve_process_slot(stan, semid)) {
             printf("Limit procesow osiagniety — koncze generowanie.\n");
             fflush(stdout);
             break;
         }
+
+        if (tryb == TRYB_ZYGOTA) {
+            MsgZygota z = {MSGTYPE_ZYGOTA, i, is_vip, has_raca, 0, -1, 0, t_zamiaru};
+            long long t0 = czas_ns();
+            z.t_zlecenia_ns = t0;
+            /* msgsnd(): zlecenie dla zygoty – fork zrobi ona */
+            int ok = 1;
+            while (msgsnd(msgid_zygota, &z, sizeof(MsgZygota) - sizeof(long), 0) == -1) {
+                if (errno == EINTR) continue;
+                // Cofamy rezerwację miejsca na proces
+                rollback_process_slot(stan, semid);
+                if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(zygota)");
+                request_shutdown(stan, semid);
+                g_stop = 1;
+                ok = 0;
+                break;
+            }
+            if (!ok) break;
+            czas_tworzenia_ns += czas_ns() - t0;
+
+            generated++;
+            continue;
+        }
+
         /* Tworzymy proces kibica*/
-        /* fork(): tworzy proces*/
-        pid_t pk = fork();
-        if (pk == -1) {
+        long long t0 = czas_ns();
+        char id[20], v[8], r[8], t[24], tz[24];
+        sprintf(id, "%d", i);
+        sprintf(v, "%d", is_vip);
+        sprintf(r, "%d", has_raca);
+        sprintf(t, "%lld", t0);
+        sprintf(tz, "%lld", t_zamiaru);
+
+        /* spawn_program(): uruchamia ./kibic (posix_spawn albo fork+exec)*/
+        char *argv_kibic[] = {"kibic", id, v, r, "0", t, tz, NULL};
+        if (reaper_spawn(&reaper, "./kibic", argv_kibic, 0) == -1) {
             // Cofamy rezerwację miejsca na proces
             rollback_process_slot(stan, semid);
-            warn_errno("fork(kibic)");
+            warn_errno("spawn(kibic)");
             request_shutdown(stan, semid);
             g_stop = 1;
             break;
         }
-        if (pk == 0) {
-            char id[20], v[8], r[8];
-            sprintf(id, "%d", i);
-            sprintf(v, "%d", is_vip);
 
-            /* ~0.5% kibiców ma race*/
-            int has_raca = (rand() % 1000 < 5) ? 1 : 0;
-            sprintf(r, "%d", has_raca);
-
-            /* exec(): uruchamia ./kibic*/
-            execl("./kibic", "kibic", id, v, r, "0", NULL);
-            die_errno("execl(kibic)");
-        }
+        czas_tworzenia_ns += czas_ns() - t0;
 
-        active++;
         generated++;
-        usleep(1000 + (rand() % 1000)); /* nie chcemy odpalić wszystkiego naraz*/
     }
 
+    long long czas_generatora_ns = czas_ns() - start_generatora;
+
     /* Jeśli mecz zakończył się zanim wygenerowaliśmy wszystkich kibiców,
      * to nie chcemy wisieć w wait()*/
-    int ewakuacja_now = 0;
-    if (sem_op_blocking(semid, SEM_SHM, -1) == 0) {
-        // Sprawdzamy czy trwa ewakuacja
-        ewakuacja_now = stan->ewakuacja_trwa;
-        (void)sem_op_blocking(semid, SEM_SHM, +1);
-    } else {
-        ewakuacja_now = stan->ewakuacja_trwa;
-    }
+    // Sprawdzamy czy trwa ewakuacja
+    int ewakuacja_now = __atomic_load_n(&stan->ewakuacja_trwa, __ATOMIC_ACQUIRE);
 
     if (!g_stop && stopped_by_match_end && generated < total_kibicow && !ewakuacja_now) {
         printf("\n[MAIN] Mecz zakonczony przed koncem generowania (%d/%d). Uruchamiam ./clean...\n", generated, total_kibicow);
@@ -321,7 +1136,13 @@ int main() {
             warn_errno("killpg(SIGTERM)");
         }
 
-        if (shmdt(stan) == -1) warn_errno("shmdt");
+        // Koszt tworzenia i histogramy są już kompletne dla tych, których zdążyliśmy utworzyć
+        zapisz_metryki(stan, tryb, rozklad, generated, czas_tworzenia_ns, czas_generatora_ns);
+
+        // Reaper zbiera kończące się dzieci i zapisuje dzieci_main – musi stanąć przed stan_odlacz()
+        reaper_zatrzymaj(&reaper);
+        // Kibice-wątki mogą jeszcze czytać SharedState (skrzynki, mutexy) – shm odłączy exit()
+        if (tryb != TRYB_WATKI && stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
         if (system("./clean > /dev/null 2>&1") == -1) warn_errno("system(./clean)");
         return 0;
     }
@@ -342,44 +1163,43 @@ int main() {
     printf("[MAIN] Koniec generowania kibiców. Czekam na procesy...\n");
     fflush(stdout);
 
+    /* Kibice-wątki kończą się po ewakuacji; przy Ctrl+C nie czekamy – zginą z procesem. */
+    if (tryb == TRYB_WATKI && !g_stop) pula_zakoncz(&pula);
+
     /*
-     * Czekamy aż wszystkie dzieci zakończą pracę.
-     * Przy Ctrl+C nie chcemy wisieć w wait() w nieskończoność
+     * Pośrednik (i zygota) żyją, dopóki kasjerzy mogą zlecać kolegów: zatrzymujemy je po końcu
+     * kierownika. Zygotę dopiero po pośredniku – jego ostatnie zlecenia muszą trafić przed stopem.
      */
-    int spin = 0;
-    while (1) {
-        // Zbieramy zakończone procesy potomne
-        pid_t w = waitpid(-1, NULL, WNOHANG);
-        if (w > 0) continue;
-
-        if (w == 0) {
-            if (!g_stop) {
-                w = wait(NULL);
-                if (w > 0) continue;
-                if (errno == EINTR) continue;
-                if (errno != ECHILD) warn_errno("wait");
-                break;
-            }
-
-            usleep(2000);
-            if (++spin == 100) {
-                if (killpg(getpgrp(), SIGKILL) == -1 && errno != ESRCH) {
-                    warn_errno("killpg(SIGKILL)");
-                }
-            }
-            continue;
+    if (!g_stop) {
+        reaper_czekaj_pid(&reaper, pid);
+        posrednik_zatrzymaj(stan, semid);
+        if (tryb == TRYB_ZYGOTA) {
+            if (pid_posrednik > 0) reaper_czekaj_pid(&reaper, pid_posrednik);
+            zygota_zatrzymaj(msgid_zygota);
         }
+    }
 
-        if (errno == EINTR) continue;
-        if (errno == ECHILD) break;
-
-        // Zbieramy zakończone procesy potomne
-        warn_errno("waitpid");
-        break;
+    /*
+     * Czekamy aż wszystkie dzieci zakończą pracę (zbiera je reaper).
+     * Przy Ctrl+C nie chcemy czekać w nieskończoność: po ~200 ms dobijamy grupę SIGKILL.
+     */
+    if (!g_stop) (void)reaper_czekaj_ponizej(&reaper, 1, 0);
+    // Sygnał mógł przyjść dopiero w trakcie czekania (po bloku "Przerwano sygnałem" wyżej)
+    if (g_stop && killpg(getpgrp(), SIGTERM) == -1 && errno != ESRCH) warn_errno("killpg(SIGTERM)");
+    if (g_stop && !reaper_czekaj_ponizej(&reaper, 1, czas_ns() + 200000000LL)) {
+        if (killpg(getpgrp(), SIGKILL) == -1 && errno != ESRCH) {
+            warn_errno("killpg(SIGKILL)");
+        }
     }
+    reaper_zatrzymaj(&reaper);
+
+    /* Podsumowanie wydajności: na ekran i do metryki.txt */
+    zapisz_metryki(stan, tryb, rozklad, generated, czas_tworzenia_ns, czas_generatora_ns);
+    if (tryb == TRYB_WATKI) printf("[MAIN] Wątków w puli: %d\n", pula.n_watkow);
 
-    /* shmdt(): odłącza pamięć współdzieloną od procesu main*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    /* stan_odlacz(): odłącza pamięć współdzieloną od procesu main*/
+    transport_odlacz(&transport);
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
 
     /* Sprzątanie IPC*/
     if (system("./clean > /dev/null 2>&1") == -1) warn_errno("system(./clean)");
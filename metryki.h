@@ -0,0 +1,91 @@
+#ifndef METRYKI_H
+#define METRYKI_H
+
+/*
+ * Metryki wydajnościowe symulacji.
+ *  - czas_ns(): znacznik czasu CLOCK_MONOTONIC (wspólny dla wszystkich procesów),
+ *  - Histogram: rozkład opóźnień w nanosekundach, trzymany w SharedState,
+ *    więc każdy proces/wątek dopisuje próbki bez semaforów (__atomic).
+ *
+ * Koszyki log-liniowe: 4 pod-koszyki na każdą potęgę dwójki,
+ * czyli percentyl jest podawany z dokładnością ~20%.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#define HIST_POD_BITY 2
+#define HIST_KOSZYKI (64 << HIST_POD_BITY)
+
+typedef struct {
+    unsigned long long licznik[HIST_KOSZYKI];
+    unsigned long long n;
+    unsigned long long suma_ns;
+    unsigned long long max_ns;
+} __attribute__((aligned(64))) Histogram; // każdy histogram od nowej linii cache (n/suma/max są gorące)
+
+static inline long long czas_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline int hist_koszyk(unsigned long long ns) {
+    if (ns < (1ULL << HIST_POD_BITY)) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int pod = (int)((ns >> (msb - HIST_POD_BITY)) & ((1 << HIST_POD_BITY) - 1));
+    return ((msb - HIST_POD_BITY + 1) << HIST_POD_BITY) + pod;
+}
+
+// Górna granica koszyka (w ns) – to ją raportujemy jako wartość percentyla.
+static inline unsigned long long hist_granica(int k) {
+    if (k < (1 << HIST_POD_BITY)) return (unsigned long long)k;
+    int msb = (k >> HIST_POD_BITY) + HIST_POD_BITY - 1;
+    unsigned long long pod = (unsigned long long)(k & ((1 << HIST_POD_BITY) - 1));
+    unsigned long long baza = (1ULL << HIST_POD_BITY) | pod;
+    return ((baza + 1) << (msb - HIST_POD_BITY)) - 1;
+}
+
+static inline void hist_dodaj(Histogram *h, long long ns) {
+    if (ns < 0) ns = 0;
+    unsigned long long v = (unsigned long long)ns;
+    __atomic_fetch_add(&h->licznik[hist_koszyk(v)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->n, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->suma_ns, v, __ATOMIC_RELAXED);
+
+    unsigned long long m = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+    while (v > m && !__atomic_compare_exchange_n(&h->max_ns, &m, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// p w zakresie 0..1, np. 0.99
+static inline unsigned long long hist_percentyl(const Histogram *h, double p) {
+    unsigned long long n = __atomic_load_n(&h->n, __ATOMIC_RELAXED);
+    if (n == 0) return 0;
+    unsigned long long cel = (unsigned long long)(p * (double)n);
+    if (cel >= n) cel = n - 1;
+    unsigned long long suma = 0;
+    for (int k = 0; k < HIST_KOSZYKI; k++) {
+        suma += __atomic_load_n(&h->licznik[k], __ATOMIC_RELAXED);
+        if (suma > cel) {
+            unsigned long long g = hist_granica(k);
+            return (g > h->max_ns) ? h->max_ns : g;
+        }
+    }
+    return h->max_ns;
+}
+
+// Jedna linia: nazwa, liczba próbek, średnia i percentyle w mikrosekundach.
+static inline void hist_wypisz(FILE *f, const char *nazwa, const Histogram *h) {
+    unsigned long long n = __atomic_load_n(&h->n, __ATOMIC_RELAXED);
+    if (n == 0) return;
+    fprintf(f, "%-28s n=%-8llu sr=%9.1f us  p50=%9.1f  p90=%9.1f  p99=%9.1f  p99.9=%9.1f  max=%9.1f\n",
+            nazwa, n,
+            (double)h->suma_ns / (double)n / 1000.0,
+            hist_percentyl(h, 0.50) / 1000.0,
+            hist_percentyl(h, 0.90) / 1000.0,
+            hist_percentyl(h, 0.99) / 1000.0,
+            hist_percentyl(h, 0.999) / 1000.0,
+            h->max_ns / 1000.0);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef MIGAWKA_H
+#define MIGAWKA_H
+
+#include "common.h"
+
+#include <sched.h>
+
+/*
+ * ===================================
+ * MIGAWKA SharedState BEZ SEMAFORÓW
+ * ===================================
+ * Spójna kopia pól, które pokazuje monitor, zbierana przez seqlocki domen (Wersja, common.h):
+ *  - mecz: status_meczu + czas_pozostaly (wersja_meczu),
+ *  - kasy: aktywne_kasy (wersja_kas),
+ *  - sprzedaż: sprzedane_bilety (wersja_sprzedazy),
+ *  - sektor s: bramki, agresor, blokada, obecni (sektory[s].wersja).
+ *
+ * Podwójny odczyt po wszystkich domenach naraz: najpierw dla każdej start == koniec
+ * (nikt nie pisze), potem kopia pól, potem start bez zmian. Wtedy żadna domena nie zmieniła się
+ * od chwili sprawdzenia ostatniej z nich do końca kopii, więc kopia = stan całości w jednej chwili
+ * (np. nie ma kibica w bramce, którego biletu jeszcze nie widać w sprzedaży).
+ * Piszący nie czekają na czytelnika – to czytelnik ponawia próbę.
+ *
+ * Poza migawką (luźne odczyty, tylko informacyjnie): dzieci_main, active_proc, długości kolejek.
+ */
+
+#define MIGAWKA_DOMENY (3 + LICZBA_SEKTOROW + 1)
+
+typedef struct {
+    int status_meczu;
+    int czas_pozostaly;
+    int aktywne_kasy[LICZBA_KAS];
+    int sprzedane_bilety[LICZBA_SEKTOROW + 1];
+    struct {
+        Stanowisko bramki[2];
+        int agresor;
+        int blokada;
+        int obecni;
+    } sektory[LICZBA_SEKTOROW + 1];
+} Migawka;
+
+static inline void migawka_domeny(SharedState *stan, Wersja *w[MIGAWKA_DOMENY]) {
+    w[0] = &stan->wersja_meczu;
+    w[1] = &stan->wersja_kas;
+    w[2] = &stan->wersja_sprzedazy;
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) w[3 + s] = &stan->sektory[s].wersja;
+}
+
+static inline void migawka_kopiuj(SharedState *stan, Migawka *m) {
+    m->status_meczu = __atomic_load_n(&stan->status_meczu, __ATOMIC_RELAXED);
+    m->czas_pozostaly = __atomic_load_n(&stan->czas_pozostaly, __ATOMIC_RELAXED);
+    for (int i = 0; i < LICZBA_KAS; i++) m->aktywne_kasy[i] = __atomic_load_n(&stan->aktywne_kasy[i], __ATOMIC_RELAXED);
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) {
+        StanSektora *sek = &stan->sektory[s];
+        m->sprzedane_bilety[s] = __atomic_load_n(&stan->sprzedane_bilety[s], __ATOMIC_RELAXED);
+        for (int b = 0; b < 2; b++) {
+            m->sektory[s].bramki[b].zajetosc = __atomic_load_n(&sek->bramki[b].zajetosc, __ATOMIC_RELAXED);
+            m->sektory[s].bramki[b].druzyna = __atomic_load_n(&sek->bramki[b].druzyna, __ATOMIC_RELAXED);
+        }
+        m->sektory[s].agresor = __atomic_load_n(&sek->agresor, __ATOMIC_RELAXED);
+        m->sektory[s].blokada = __atomic_load_n(&sek->blokada, __ATOMIC_RELAXED);
+        m->sektory[s].obecni = __atomic_load_n(&sek->obecni, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Pobiera migawkę w co najwyżej max_prob podejściach. Zwraca numer udanego podejścia (1 = od razu)
+ * albo 0, gdy każde trafiło na zapis – wtedy m zawiera ostatnią, być może niespójną kopię
+ * (np. piszący zginął w połowie zapisu i jego domena już się nie domknie).
+ */
+static inline int migawka_pobierz(SharedState *stan, Migawka *m, int max_prob) {
+    Wersja *w[MIGAWKA_DOMENY];
+    unsigned int start[MIGAWKA_DOMENY];
+    migawka_domeny(stan, w);
+
+    for (int proba = 1; proba <= max_prob; proba++) {
+        int spojna = 1;
+        for (int d = 0; d < MIGAWKA_DOMENY; d++) {
+            // Najpierw koniec, potem start: równe = żaden zapis domeny nie jest w toku
+            unsigned int koniec = __atomic_load_n(&w[d]->koniec, __ATOMIC_ACQUIRE);
+            start[d] = __atomic_load_n(&w[d]->start, __ATOMIC_ACQUIRE);
+            if (start[d] != koniec) spojna = 0;
+        }
+        migawka_kopiuj(stan, m);
+        // Kopia pól przed ponownym odczytem start (jak smp_rmb() w seqlocku jądra)
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        for (int d = 0; d < MIGAWKA_DOMENY && spojna; d++) {
+            if (__atomic_load_n(&w[d]->start, __ATOMIC_RELAXED) != start[d]) spojna = 0;
+        }
+        if (spojna) return proba;
+        // Piszący mógł zostać wywłaszczony w połowie zapisu – oddajemy mu procesor
+        sched_yield();
+    }
+    return 0;
+}
+
+#endif
@@ -1,4 +1,10 @@
 #include "common.h"
+#include "pamiec.h"
+#include "migawka.h"
+#include "transport.h"
+
+/* Ile razy monitor ponawia migawkę (migawka.h), zanim pokaże kopię mimo trwającego zapisu */
+#define MIGAWKA_PROBY 100
 
 void print_timer(int sekundy) {
     int m = sekundy / 60;
@@ -7,23 +13,17 @@ void print_timer(int sekundy) {
 }
 
 int main() {
-    /* shmget(): pobiera segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    if (shmid == -1) {
-        warn_errno("shmget");
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
+    if (!stan) {
+        warn_errno("stan_podlacz");
         fprintf(stderr, "Uruchom najpierw ./setup\n");
         /* exit(): kończy proces*/
         exit(EXIT_FAILURE);
     }
 
-    /* shmat(): mapuje pamięć współdzieloną do przestrzeni adresowej procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
-    if (stan == (void*)-1) {
-        die_errno("shmat");
-    }
-
     /*
-     * Monitor działa w pętli i podgląda stan:
+     * Monitor działa w pętli i podgląda stan (z migawki – spójnej kopii bez semaforów, migawka.h):
      *  - status meczu + timer
      *  - kolejki przed kasami
      *  - aktywne kasy
@@ -34,20 +34,23 @@ int main() {
     while (1) {
         if (stan->ewakuacja_trwa) break;
 
+        Migawka m;
+        int proba = migawka_pobierz(stan, &m, MIGAWKA_PROBY);
+
         printf("\033[H\033[J");
 
         printf("================================================================\n");
 
         /* Status meczu*/
-        if (stan->status_meczu == 0) {
+        if (m.status_meczu == 0) {
             printf("OCZEKIWANIE NA MECZ (START ZA: ");
             printf("\033[1;33m");
-            print_timer(stan->czas_pozostaly);
+            print_timer(m.czas_pozostaly);
             printf("\033[0m)\n");
-        } else if (stan->status_meczu == 1) {
+        } else if (m.status_meczu == 1) {
             printf("\033[1;32mMECZ TRWA\033[0m (KONIEC ZA: ");
             printf("\033[1;37m");
-            print_timer(stan->czas_pozostaly);
+            print_timer(m.czas_pozostaly);
             printf("\033[0m)\n");
         } else {
             printf("\033[1;31mMECZ ZAKOŃCZONY - EWAKUACJA\033[0m\n");
@@ -55,14 +58,21 @@ int main() {
 
         printf("================================================================\n");
 
-        /* Podgląd kolejek*/
-        printf("KOLEJKA PRZED HALĄ: Zwykli: %d | VIP: %d\n",
-               stan->kolejka_zwykla, stan->kolejka_vip);
+        if (proba) printf("MIGAWKA: spójna (podejście %d)\n", proba);
+        else printf("\033[1;31mMIGAWKA: NIESPÓJNA\033[0m (zapis w toku po %d podejściach)\n", MIGAWKA_PROBY);
+
+        /* Procesy: żyjące dzieci main (dokładny licznik reapera) i zajęte sloty MAX_PROC */
+        printf("PROCESY: dzieci main: %d | utworzone (sloty): %d / %d\n",
+               __atomic_load_n(&stan->dzieci_main, __ATOMIC_RELAXED), stan->active_proc, MAX_PROC);
+
+        /* Podgląd kolejek: długości kolejek żądań wybranego transportu (transport_dlugosc) */
+        printf("KOLEJKA PRZED HALĄ (%s): Zwykli: %d | VIP: %d\n", transport_nazwa(stan->transport),
+               transport_dlugosc(stan, 0), transport_dlugosc(stan, 1));
 
         /* Podgląd statusu kas*/
         printf("\n--- STATUS KAS ---\n");
         for (int i = 0; i < LICZBA_KAS; i++) {
-            if (stan->aktywne_kasy[i]) printf("[ON ] ");
+            if (m.aktywne_kasy[i]) printf("[ON ] ");
             else printf("[ . ] ");
         }
         printf("\n");
@@ -70,22 +80,22 @@ int main() {
         /* Sprzedaż biletów per sektor + VIP*/
         printf("\n--- SPRZEDAŻ BILETÓW ---\n");
         for (int i = 0; i < LICZBA_SEKTOROW; i++) {
-            printf("S%d: %3d | ", i, stan->sprzedane_bilety[i]);
+            printf("S%d: %3d | ", i, m.sprzedane_bilety[i]);
             if ((i + 1) % 4 == 0) printf("\n");
         }
 
         /* Limit VIP*/
         int limit_vip = (int)(K * 0.003);
         if (limit_vip < 1) limit_vip = 1;
-        printf("VIP: %3d / %d\n", stan->sprzedane_bilety[SEKTOR_VIP], limit_vip);
+        printf("VIP: %3d / %d\n", m.sprzedane_bilety[SEKTOR_VIP], limit_vip);
 
         /* Ilu kibiców faktycznie siedzi w sektorach + VIP). */
         printf("\n--- OBECNI NA HALI (WEDŁUG SEKTORÓW) ---\n");
         for (int i = 0; i < LICZBA_SEKTOROW; i++) {
-            printf("S%d: %3d | ", i, stan->obecni_w_sektorze[i]);
+            printf("S%d: %3d | ", i, m.sektory[i].obecni);
             if ((i + 1) % 4 == 0) printf("\n");
         }
-        printf("VIP: %3d\n", stan->obecni_w_sektorze[SEKTOR_VIP]);
+        printf("VIP: %3d\n", m.sektory[SEKTOR_VIP].obecni);
 
         /*
          * Bramki: dla każdego sektora są 2 bramki.
@@ -96,18 +106,18 @@ int main() {
          */
         printf("\n--- KONTROLA BEZPIECZEŃSTWA ---\n");
         for (int i = 0; i < LICZBA_SEKTOROW; i++) {
-            int n0 = stan->bramki[i][0].zajetosc;
-            int d0 = stan->bramki[i][0].druzyna;
-            int n1 = stan->bramki[i][1].zajetosc;
-            int d1 = stan->bramki[i][1].druzyna;
+            int n0 = m.sektory[i].bramki[0].zajetosc;
+            int d0 = m.sektory[i].bramki[0].druzyna;
+            int n1 = m.sektory[i].bramki[1].zajetosc;
+            int d1 = m.sektory[i].bramki[1].druzyna;
 
             char s0[64], s1[64];
             if (n0 > 0) sprintf(s0, "[%d:%d]", n0, d0); else sprintf(s0, "[ . ]");
             if (n1 > 0) sprintf(s1, "[%d:%d]", n1, d1); else sprintf(s1, "[ . ]");
 
             printf("SEKTOR %d: %-10s | %-10s ", i, s0, s1);
-            if (stan->blokada_sektora[i]) printf("[BLOKADA]");
-            if (stan->agresor_sektora[i] != 0) printf("[AGRESOR:%d]", stan->agresor_sektora[i]);
+            if (m.sektory[i].blokada) printf("[BLOKADA]");
+            if (m.sektory[i].agresor != 0) printf("[AGRESOR:%d]", m.sektory[i].agresor);
             printf("\n");
         }
 
@@ -115,7 +125,7 @@ int main() {
         usleep(500000); /* Odświeżanie*/
     }
 
-    /* shmdt(): odłącza shm od procesu monitora. */
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    /* stan_odlacz(): odłącza shm od procesu monitora. */
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
     return 0;
 }
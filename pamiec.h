@@ -0,0 +1,284 @@
+#ifndef PAMIEC_H
+#define PAMIEC_H
+
+#include "common.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+
+/*
+ * ===================================
+ * NOŚNIK SharedState (./setup pamiec=)
+ * ===================================
+ *  - sysv (domyślnie): segment shmget(KEY_SHM) – znika w ./clean,
+ *  - plik: plik PLIK_STANU na tmpfs (/dev/shm) mapowany mmap(MAP_SHARED). ./clean zapisuje przed
+ *    usunięciem kopię stanu do PLIK_ZRZUTU – końcowy stan przebiegu do obejrzenia offline (./zrzut).
+ *
+ * ./setup strony=duze: duże strony (mniej wpisów TLB przy dużym K – skrzynki i tablice per kibic):
+ *  - sysv: shmget(SHM_HUGETLB), plik: plik na hugetlbfs (KATALOG_HUGETLBFS) + mmap(MAP_HUGETLB),
+ *  - oba wymagają zarezerwowanych stron (/proc/sys/vm/nr_hugepages); bez nich zostaje
+ *    madvise(MADV_HUGEPAGE) – przezroczyste duże strony, gdy shmem_enabled na to pozwala.
+ *
+ * Role nie znają wyboru: stan_podlacz() szuka po kolei segmentu sysv, pliku na tmpfs i na hugetlbfs
+ * (setup zostawia tylko jeden z nich), a stan_odlacz() odłącza wg stan->pamiec.
+ */
+
+enum { PAMIEC_SYSV, PAMIEC_PLIK, PAMIEC_N };
+enum { STRONY_ZWYKLE, STRONY_HUGETLB, STRONY_THP };
+
+#define PLIK_STANU "/dev/shm/hala_stan"
+#define KATALOG_HUGETLBFS "/dev/hugepages"
+#define PLIK_STANU_HUGETLBFS KATALOG_HUGETLBFS "/hala_stan"
+#define PLIK_ZRZUTU "/dev/shm/hala_stan.zrzut"
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
+static inline const char *pamiec_nazwa(int rodzaj) {
+    static const char *const nazwy[PAMIEC_N] = {"sysv", "plik"};
+    return (rodzaj >= 0 && rodzaj < PAMIEC_N) ? nazwy[rodzaj] : "?";
+}
+
+static inline const char *strony_nazwa(int strony) {
+    switch (strony) {
+    case STRONY_HUGETLB: return "hugetlb";
+    case STRONY_THP: return "thp (madvise)";
+    default: return "zwykłe";
+    }
+}
+
+static inline size_t pamiec_zaokraglij(size_t rozmiar, size_t strona) {
+    return (rozmiar + strona - 1) / strona * strona;
+}
+
+// Przezroczyste duże strony dla mapowania (każdy proces osobno – rada dotyczy VMA, nie pliku)
+static inline int pamiec_thp(void *p, size_t rozmiar) {
+    /* madvise(MADV_HUGEPAGE): prośba o duże strony tmpfs/shm dla tego mapowania */
+    return madvise(p, rozmiar, MADV_HUGEPAGE);
+}
+
+/* =========================
+ * Tworzenie (setup)
+ * ========================= */
+
+// sysv: segment KEY_SHM, przy duzych najpierw SHM_HUGETLB. NULL przy błędzie (errno)
+static inline SharedState *pamiec_utworz_sysv(int duze, int *strony, size_t *rozmiar) {
+    int shmid = -1;
+    if (duze) {
+        // Segment SHM_HUGETLB musi mieć rozmiar w pełnych dużych stronach (domyślnie 2 MB)
+        *rozmiar = pamiec_zaokraglij(sizeof(SharedState), 2UL << 20);
+        /* shmget(SHM_HUGETLB): segment z zarezerwowanych dużych stron */
+        shmid = shmget(KEY_SHM, *rozmiar, IPC_CREAT | IPC_EXCL | SHM_HUGETLB | 0600);
+        if (shmid == -1) warn_errno("shmget(SHM_HUGETLB)");
+        else *strony = STRONY_HUGETLB;
+    }
+    if (shmid == -1) {
+        *rozmiar = sizeof(SharedState);
+        /* shmget(): tworzy segment pamięci współdzielonej */
+        shmid = shmget(KEY_SHM, *rozmiar, IPC_CREAT | IPC_EXCL | 0600);
+        if (shmid == -1) return NULL;
+    }
+
+    /* shmat(): podłącza shm do przestrzeni adresowej procesu */
+    SharedState *stan = (SharedState *)shmat(shmid, NULL, 0);
+    if (stan == (void *)-1) {
+        int e = errno;
+        /* shmctl(IPC_RMID): usuwa segment shm: sprzątanie po błędzie */
+        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+        errno = e;
+        return NULL;
+    }
+    if (duze && *strony != STRONY_HUGETLB && pamiec_thp(stan, *rozmiar) == 0) *strony = STRONY_THP;
+    return stan;
+}
+
+// Plik o danym rozmiarze zmapowany MAP_SHARED; przy błędzie usuwa plik. NULL przy błędzie (errno)
+static inline SharedState *pamiec_utworz_plik_w(const char *sciezka, size_t rozmiar, int flagi_mmap) {
+    /* open(O_EXCL): nowy plik stanu, tylko dla właściciela */
+    int fd = open(sciezka, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) return NULL;
+    void *p = MAP_FAILED;
+    /* ftruncate(): rozmiar pliku = stan (tmpfs/hugetlbfs daje strony wyzerowane) */
+    if (ftruncate(fd, (off_t)rozmiar) == 0) {
+        /* mmap(MAP_SHARED): zapisy widzą wszystkie procesy mapujące ten plik */
+        p = mmap(NULL, rozmiar, PROT_READ | PROT_WRITE, MAP_SHARED | flagi_mmap, fd, 0);
+    }
+    int e = errno;
+    /* close(): mapowanie trzyma plik, deskryptor nie jest potrzebny */
+    if (close(fd) == -1) warn_errno("close(stan)");
+    if (p == MAP_FAILED) {
+        if (unlink(sciezka) == -1) warn_errno("unlink(stan)");
+        errno = e;
+        return NULL;
+    }
+    return (SharedState *)p;
+}
+
+// plik: przy duzych najpierw hugetlbfs, potem tmpfs (/dev/shm). NULL przy błędzie (errno)
+static inline SharedState *pamiec_utworz_plik(int duze, int *strony, size_t *rozmiar) {
+    SharedState *stan = NULL;
+    if (duze) {
+        struct statfs fs;
+        /* statfs(): czy KATALOG_HUGETLBFS to hugetlbfs i jaka jest w nim duża strona */
+        if (statfs(KATALOG_HUGETLBFS, &fs) == -1 || fs.f_type != HUGETLBFS_MAGIC) {
+            fprintf(stderr, "[SETUP] Brak hugetlbfs w %s\n", KATALOG_HUGETLBFS);
+        } else {
+            *rozmiar = pamiec_zaokraglij(sizeof(SharedState), (size_t)fs.f_bsize);
+            stan = pamiec_utworz_plik_w(PLIK_STANU_HUGETLBFS, *rozmiar, MAP_HUGETLB);
+            if (stan) *strony = STRONY_HUGETLB;
+            else warn_errno("mmap(MAP_HUGETLB)");
+        }
+    }
+    if (!stan) {
+        *rozmiar = sizeof(SharedState);
+        stan = pamiec_utworz_plik_w(PLIK_STANU, *rozmiar, 0);
+        if (!stan) return NULL;
+        if (duze && pamiec_thp(stan, *rozmiar) == 0) *strony = STRONY_THP;
+    }
+    return stan;
+}
+
+/*
+ * Tworzy wyzerowany SharedState na wybranym nośniku i wpisuje do niego opis nośnika.
+ * Stan po poprzednim przebiegu (dowolny nośnik) setup usuwa wcześniej – stan_usun(0).
+ * NULL przy błędzie (errno).
+ */
+static inline SharedState *stan_utworz(int rodzaj, int duze) {
+    int strony = STRONY_ZWYKLE;
+    size_t rozmiar = 0;
+    SharedState *stan = (rodzaj == PAMIEC_PLIK) ? pamiec_utworz_plik(duze, &strony, &rozmiar)
+                                                : pamiec_utworz_sysv(duze, &strony, &rozmiar);
+    if (!stan) return NULL;
+
+    memset(stan, 0, sizeof(SharedState));
+    stan->rozmiar_stanu = sizeof(SharedState);
+    stan->pamiec = rodzaj;
+    stan->strony = strony;
+    stan->rozmiar_mapy = rozmiar;
+    return stan;
+}
+
+/* =========================
+ * Podłączanie (role)
+ * ========================= */
+
+// Plik stanu zmapowany w całości; NULL przy błędzie (errno, ENOENT = nie ma pliku)
+static inline SharedState *pamiec_podlacz_plik(const char *sciezka) {
+    /* open(): istniejący plik stanu */
+    int fd = open(sciezka, O_RDWR);
+    if (fd == -1) return NULL;
+    struct stat st;
+    void *p = MAP_FAILED;
+    /* fstat(): długość mapowania = rozmiar pliku (na hugetlbfs zaokrąglony do dużej strony) */
+    if (fstat(fd, &st) == 0) {
+        if ((size_t)st.st_size < sizeof(SharedState)) errno = EINVAL; // plik z innej kompilacji (K)
+        else p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int e = errno;
+    if (close(fd) == -1) warn_errno("close(stan)");
+    errno = e;
+    return (p == MAP_FAILED) ? NULL : (SharedState *)p;
+}
+
+/*
+ * Podłącza SharedState utworzony przez ./setup, niezależnie od nośnika.
+ * NULL przy błędzie (errno; ENOENT = brak stanu, czyli nie było ./setup).
+ */
+static inline SharedState *stan_podlacz(void) {
+    /* shmget(): segment System V (pamiec=sysv) */
+    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
+    if (shmid != -1) {
+        /* shmat(): mapuje shm do pamięci procesu */
+        SharedState *stan = (SharedState *)shmat(shmid, NULL, 0);
+        if (stan == (void *)-1) return NULL;
+        if (stan->strony == STRONY_THP) (void)pamiec_thp(stan, stan->rozmiar_mapy);
+        return stan;
+    }
+    if (errno != ENOENT) return NULL;
+
+    static const char *const pliki[] = {PLIK_STANU, PLIK_STANU_HUGETLBFS};
+    for (size_t i = 0; i < sizeof(pliki) / sizeof(pliki[0]); i++) {
+        SharedState *stan = pamiec_podlacz_plik(pliki[i]);
+        if (!stan) {
+            if (errno == ENOENT) continue;
+            return NULL;
+        }
+        if (stan->strony == STRONY_THP) (void)pamiec_thp(stan, stan->rozmiar_mapy);
+        return stan;
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+// Odpowiednik shmdt() dla obu nośników. Zwraca 0 albo -1 (errno)
+static inline int stan_odlacz(SharedState *stan) {
+    if (stan->pamiec == PAMIEC_PLIK) {
+        /* munmap(): odłącza plik stanu od procesu */
+        return munmap(stan, stan->rozmiar_mapy);
+    }
+    /* shmdt(): odłącza shm od procesu */
+    return shmdt(stan);
+}
+
+/* =========================
+ * Zrzut i sprzątanie (clean)
+ * ========================= */
+
+// Kopia SharedState do PLIK_ZRZUTU: najpierw plik tymczasowy, potem rename – zrzut zawsze jest cały
+static inline int stan_zapisz_zrzut(const SharedState *stan) {
+    const char *tmp = PLIK_ZRZUTU ".tmp";
+    /* open(O_TRUNC): plik tymczasowy zrzutu */
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) return -1;
+    const char *p = (const char *)stan;
+    size_t zostalo = sizeof(SharedState);
+    while (zostalo > 0) {
+        /* write(): stan prosto z mapowania (także z hugetlbfs, którego pliku nie da się czytać read()) */
+        ssize_t n = write(fd, p, zostalo);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            int e = errno;
+            close(fd);
+            unlink(tmp);
+            errno = e;
+            return -1;
+        }
+        p += n;
+        zostalo -= (size_t)n;
+    }
+    if (close(fd) == -1) return -1;
+    /* rename(): podmienia zrzut atomowo – poprzedni przebieg zostaje, dopóki nowy nie jest gotowy */
+    return rename(tmp, PLIK_ZRZUTU);
+}
+
+/*
+ * Usuwa SharedState z każdego nośnika (nieistniejące pomija).
+ * zachowaj: stan z pliku (pamiec=plik) najpierw trafia do PLIK_ZRZUTU.
+ */
+static inline void stan_usun(int zachowaj) {
+    /* shmget(): próba znalezienia istniejącego segmentu shm */
+    int shmid = shmget(KEY_SHM, 0, 0600);
+    if (shmid != -1) {
+        /* shmctl(IPC_RMID): usuwa segment pamięci współdzielonej */
+        if (shmctl(shmid, IPC_RMID, NULL) == -1) warn_errno("shmctl(IPC_RMID)");
+    } else if (errno != ENOENT) warn_errno("shmget");
+
+    static const char *const pliki[] = {PLIK_STANU, PLIK_STANU_HUGETLBFS};
+    for (size_t i = 0; i < sizeof(pliki) / sizeof(pliki[0]); i++) {
+        if (zachowaj) {
+            SharedState *stan = pamiec_podlacz_plik(pliki[i]);
+            if (stan) {
+                if (stan_zapisz_zrzut(stan) == -1) warn_errno("zrzut stanu");
+                else printf("[OK] Stan zachowany w %s (./zrzut)\n", PLIK_ZRZUTU);
+                if (stan_odlacz(stan) == -1) warn_errno("munmap");
+            } else if (errno != ENOENT) warn_errno("open(stan)");
+        }
+        /* unlink(): usuwa plik stanu (mapowania jeszcze żyjących procesów zostają do ich munmap) */
+        if (unlink(pliki[i]) == -1 && errno != ENOENT) warn_errno("unlink(stan)");
+    }
+}
+
+#endif
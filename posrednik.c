@@ -0,0 +1,123 @@
+#include "common.h"
+#include "pamiec.h"
+#include "spawn.h"
+#include "transport.h"
+
+/*
+ * ==========================
+ * POŚREDNIK: TWORZENIE KOLEGÓW
+ * ==========================
+ * Kasjer, który sprzedał 2 bilety, nie tworzy kolegi sam – wstawia zlecenie
+ * (id kolegi, sektor) do kolejki kolegi[] w shm i od razu wraca do swoich kolejek żądań.
+ * Pośrednik to jeden proces, który:
+ *  - czeka na SEM_POSREDNIK (semafor zliczający zlecenia),
+ *  - zdejmuje zlecenie pod SEM_KOLEGI,
+ *  - tworzy kolegę: spawn_program() ./kibic albo zlecenie MsgZygota dla zygoty,
+ *  - wysyła koledze bilet transport_odpowiedz() (dopiero gdy proces powstał),
+ *  - gdy utworzenie padnie: cofa slot procesu i drugi bilet ("bilet-duch").
+ *
+ * Koniec: main ustawia posrednik_koniec i podbija SEM_POSREDNIK;
+ * pośrednik kończy się, gdy kolejka jest już pusta.
+ */
+
+
+/*
+ * Uruchamia kolegę ze zlecenia (slot na proces zarezerwował kasjer):
+ *  - tryb zwykły: spawn_program() ./kibic (posix_spawn albo fork+exec),
+ *  - tryb zygoty (stan->zygota_pid != 0): zlecenie MsgZygota, fork robi zygota.
+ */
+static int spawn_kolegi(SharedState *stan, int semid, int msgid_zygota, const ZlecenieKolegi *zl) {
+    /* ~0.5% kibiców ma race (także koledzy) */
+    int has_raca = (rand() % 1000 < 5) ? 1 : 0;
+    long long t0 = czas_ns();
+
+    if (stan->zygota_pid != 0) {
+        /* args: id, vip=0, has_raca, ma_juz_bilet=1 */
+        MsgZygota z = {MSGTYPE_ZYGOTA, zl->kibic_id, 0, has_raca, 1, zl->sektor, t0, 0};
+        while (msgsnd(msgid_zygota, &z, sizeof(MsgZygota) - sizeof(long), 0) == -1) {
+            if (errno == EINTR) continue;
+            // Cofamy rezerwację miejsca na proces
+            rollback_process_slot(stan, semid);
+            if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(spawn_kolegi@zygota)");
+            return 0;
+        }
+        return 1;
+    }
+
+    char idbuf[32], racabuf[8], tbuf[24];
+    sprintf(idbuf, "%d", zl->kibic_id);
+    sprintf(racabuf, "%d", has_raca);
+    sprintf(tbuf, "%lld", t0);
+    /* args: id, vip=0, has_raca, ma_juz_bilet=1, t_zlecenia_ns */
+    char *argv_kibic[] = {"kibic", idbuf, "0", racabuf, "1", tbuf, NULL};
+    if (spawn_program("./kibic", argv_kibic, &stan->lat[LAT_SPAWN]) == -1) {
+        // Cofamy rezerwację miejsca na proces
+        rollback_process_slot(stan, semid);
+        warn_errno("spawn(spawn_kolegi)");
+        return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    /* signal(): koledzy to nasze dzieci – nie czekamy na nich, sprząta kernel (bez zombie) */
+    if (signal(SIGCHLD, SIG_IGN) == SIG_ERR) warn_errno("signal(SIGCHLD)");
+
+    /* semget(): pobiera istniejący zestaw semaforów*/
+    int semid = semget(KEY_SEM, 0, 0600);
+    // Kończymy z komunikatem o błędzie
+    if (semid == -1) die_errno("semget");
+
+    /* msgget(): pobiera kolejkę zleceń zygoty (używana tylko w trybie ./main zygota) */
+    int msgid_zygota = msgget(KEY_MSG_ZYGOTA, 0600);
+    // Kończymy z komunikatem o błędzie
+    if (msgid_zygota == -1) die_errno("msgget(zygota)");
+
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
+    // Kończymy z komunikatem o błędzie
+    if (!stan) die_errno("stan_podlacz");
+    /* Bilety dla kolegów idą tym samym transportem co odpowiedzi kas (transport.h) */
+    Transport transport;
+    if (transport_podlacz(&transport, stan) == -1) die_errno("transport_podlacz");
+    rola_gotowa(stan);
+
+    srand(ziarno_dla(stan, ZIARNO_POSREDNIK, 0));
+
+    while (1) {
+        // Czekamy na zlecenie (albo na sygnał końca od main)
+        sem_op(semid, SEM_POSREDNIK, -1);
+
+        ZlecenieKolegi zl = {0};
+        // Wchodzimy do sekcji krytycznej kolejki kolegów – kasjerzy dopisują do tej samej kolejki
+        zablokuj(stan, semid, SEM_KOLEGI);
+        int jest = kolegi_zdejmij(stan, &zl);
+        int koniec = stan->posrednik_koniec;
+        // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+        odblokuj(stan, semid, SEM_KOLEGI);
+
+        if (!jest) {
+            if (koniec) break;
+            continue;
+        }
+
+        if (spawn_kolegi(stan, semid, msgid_zygota, &zl)) {
+            hist_dodaj(&stan->lat[LAT_START_KOLEGI], czas_ns() - zl.t_zlecenia_ns);
+            transport_odpowiedz(&transport, zl.kibic_id, zl.sektor);
+        } else {
+            // Kolega nie powstał: cofamy drugi bilet, żeby nie było "biletu-ducha"
+            zablokuj(stan, semid, SEM_SPRZEDAZ);
+            // Zmniejszamy licznik sprzedanych biletów dla sektora
+            wersja_zapis_start(&stan->wersja_sprzedazy);
+            if (stan->sprzedane_bilety[zl.sektor] > 0) stan->sprzedane_bilety[zl.sektor]--;
+            wersja_zapis_koniec(&stan->wersja_sprzedazy);
+            // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+            odblokuj(stan, semid, SEM_SPRZEDAZ);
+        }
+    }
+
+    /* stan_odlacz(): odłącza shm od procesu pośrednika*/
+    transport_odlacz(&transport);
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "common.h"
+#include "pamiec.h"
+#include "transport.h"
 
 union semun {
     int val;
@@ -12,11 +14,11 @@ union semun {
  * ==========================
  * Jeden pracownik = jeden sektor (0..7).
  * Pracownik jest ramieniem wykonawczym kierownika:
- *  - odbiera MsgSterujacy z kolejki msg o typie mtype = 10 + sektor,
+ *  - odbiera MsgSterujacy adresowane do CEL_PRACOWNIK(sektor) (transport.h; w sysv mtype = 10 + sektor),
  *  - wykonuje komendy:
- *      1 -> blokada_sektora[sektor]=1
- *      2 -> blokada_sektora[sektor]=0
- *      3 -> ewakuacja sektora i raport do kierownika (mtype=99)
+ *      1 -> sektory[sektor].blokada=1
+ *      2 -> sektory[sektor].blokada=0
+ *      3 -> ewakuacja sektora i raport do kierownika (CEL_RAPORT)
  *
  * Blokada jest w shm
  *  - kibice mogą ją odczytywać bezpośrednio (bez dodatkowej kolejki),
@@ -24,18 +26,6 @@ union semun {
  */
 
 
-// Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-static void sem_op(int semid, int idx, int op) {
-    struct sembuf sb = {(unsigned short)idx, (short)op, 0};
-    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
-    while (semop(semid, &sb, 1) == -1) {
-        if (errno == EINTR) continue;
-        if (errno == EIDRM || errno == EINVAL) _exit(0);
-        // Kończymy z komunikatem o błędzie
-        die_errno("semop");
-    }
-}
-
 int main(int argc, char *argv[]) {
     /* Pracownik odpowiada za JEDEN sektor i reaguje na komendy kierownika*/
     if (argc != 2) {
@@ -51,43 +41,35 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    /* shmget(): pobiera segment pamięci współdzielonej*/
-    int shmid = shmget(KEY_SHM, sizeof(SharedState), 0600);
-    // Kończymy z komunikatem o błędzie
-    if (shmid == -1) die_errno("shmget");
-
-    /* msgget(): pobiera kolejkę komunikatów*/
-    int msgid = msgget(KEY_MSG, 0600);
-    // Kończymy z komunikatem o błędzie
-    if (msgid == -1) die_errno("msgget");
-
     /* semget(): pobiera zestaw semaforów*/
     int semid = semget(KEY_SEM, 0, 0600);
     // Kończymy z komunikatem o błędzie
     if (semid == -1) die_errno("semget");
 
-    /* shmat(): mapuje shm do pamięci procesu*/
-    SharedState *stan = (SharedState*)shmat(shmid, NULL, 0);
+    /* stan_podlacz(): SharedState z ./setup – segment shm albo plik stanu (pamiec.h) */
+    SharedState *stan = stan_podlacz();
     // Kończymy z komunikatem o błędzie
-    if (stan == (void*)-1) die_errno("shmat");
+    if (!stan) die_errno("stan_podlacz");
 
-    long my_type = 10 + sektor;
+    /* Polecenia kierownika i raport idą transportem wybranym przez main (transport.h) */
+    Transport transport;
+    if (transport_podlacz(&transport, stan) == -1) die_errno("transport_podlacz");
+    rola_gotowa(stan);
 
     while (1) {
         MsgSterujacy msg;
 
 /*
- * Odbieramy komendy dla tego konkretnego sektora:
- *  - my_type = 10 + sektor
- * dzięki temu jeden kanał msg obsługuje wszystkie sektory,
- * ale każdy pracownik filtruje tylko swoje wiadomości.
+ * Odbieramy komendy dla tego konkretnego sektora (adresat CEL_PRACOWNIK(sektor)):
+ *  - shm: własny kanał sterujący w SharedState,
+ *  - sysv: wspólna kolejka msg, pracownik filtruje mtype = 10 + sektor,
+ *  - posix: własna kolejka mq.
  */
 
-        /* msgrcv(): odbiera polecenie z kolejki */
-        if (msgrcv(msgid, &msg, sizeof(int) * 2, my_type, 0) == -1) {
-            if (errno == EINTR) continue;
+        /* transport_odbierz_sterowanie(): czeka na polecenie */
+        if (transport_odbierz_sterowanie(&transport, CEL_PRACOWNIK(sektor), 1, &msg) == -1) {
             if (errno == EIDRM || errno == EINVAL) break; /* kolejka skasowana -> kończymy */
-            warn_errno("msgrcv");
+            warn_errno("odbierz(sterowanie)");
             break;
         }
 
@@ -99,7 +81,9 @@ int main(int argc, char *argv[]) {
          */
         if (msg.typ_sygnalu == 1) {
             // Włączamy blokadę sektora na polecenie kierownika
-            stan->blokada_sektora[sektor] = 1;
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].blokada = 1;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
             /* semafor-zdarzenie: 1 = zablokowany */
             union semun a; a.val = 1;
             // Ustawiamy wartość semafora
@@ -112,7 +96,9 @@ int main(int argc, char *argv[]) {
 
         } else if (msg.typ_sygnalu == 2) {
             // Wyłączamy blokadę sektora na polecenie kierownika
-            stan->blokada_sektora[sektor] = 0;
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].blokada = 0;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
             /* semafor-zdarzenie: 0 = odblokowany */
             union semun a; a.val = 0;
             // Ustawiamy wartość semafora
@@ -129,16 +115,20 @@ int main(int argc, char *argv[]) {
 
 /*
  * W ewakuacji warunek „sektor pusty” jest dwuetapowy:
- *  1) bramki puste (pod semaforem sektora) -> nikt nie jest w przejściu,
- *  2) obecni_w_sektorze==0 (pod SEM_SHM)  -> nikt nie siedzi w sektorze.
+ *  1) bramki puste -> nikt nie jest w przejściu,
+ *  2) sektory[s].obecni==0 (licznik atomowy) -> nikt nie siedzi w sektorze.
+ * Nie odpytujemy co 10 ms: sektor_czekaj_na_pusty() (common.h) śpi na zdarzeniu sektora,
+ * które zgłasza ostatni wychodzący z bramek albo z sektora.
  *
- * Dopiero wtedy odsyłamy raport do kierownika (mtype=99),
+ * Dopiero wtedy odsyłamy raport do kierownika (CEL_RAPORT),
  * a kierownik kończy symulację dopiero po zebraniu 8 raportów.
  */
 
             /* W ewakuacji blokujemy sektor w shm, ale semafor zdarzenia zostawiamy OTWARTY (0),
                żeby nikt nie utknął na czekaniu na odblokowanie. */
-            stan->blokada_sektora[sektor] = 1;
+            wersja_zapis_start(&stan->sektory[sektor].wersja);
+            stan->sektory[sektor].blokada = 1;
+            wersja_zapis_koniec(&stan->sektory[sektor].wersja);
             union semun a; a.val = 0;
             // Ustawiamy wartość semafora
             if (semctl(semid, SEM_SEKTOR_BLOCK_START + sektor, SETVAL, a) == -1) {
@@ -146,38 +136,12 @@ int main(int argc, char *argv[]) {
                 warn_errno("semctl");
             }
 
-            int sem_sektora = SEM_SEKTOR_START + sektor;
-
-            while (1) {
-                int b0, b1, ob;
-
-                /* Bramki sektora chronione semaforem sektora*/
-                sem_op(semid, sem_sektora, -1);
-                // Odczytujemy stan bramek
-                b0 = stan->bramki[sektor][0].zajetosc;
-                b1 = stan->bramki[sektor][1].zajetosc;
-                // Synchronizujemy się semaforem
-                sem_op(semid, sem_sektora, 1);
-
-                /* Licznik obecnych w sektorze*/
-                sem_op(semid, SEM_SHM, -1);
-                // Sprawdzamy ilu ludzi siedzi w sektorze
-                ob = stan->obecni_w_sektorze[sektor];
-                // Synchronizujemy się semaforem
-                sem_op(semid, SEM_SHM, 1);
-
-                /* Dopiero gdy bramki puste i nikt nie siedzi w sektorze -> sektor ewakuowany*/
-                if (b0 == 0 && b1 == 0 && ob == 0) break;
-                usleep(10000);
-            }
+            /* Dopiero gdy bramki puste i nikt nie siedzi w sektorze -> sektor ewakuowany*/
+            sektor_czekaj_na_pusty(stan, sektor);
 
             /* Raport do kierownika: sektor pusty*/
-            msg.mtype = 99;
-            msg.sektor_id = sektor;
-
-            /* msgsnd(): wysyła raport do kolejki komunikatów*/
-            if (msgsnd(msgid, &msg, sizeof(int) * 2, 0) == -1) {
-                if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(raport)");
+            if (transport_steruj(&transport, CEL_RAPORT, 3, sektor) == -1) {
+                if (!(errno == EIDRM || errno == EINVAL)) warn_errno("steruj(raport)");
             }
 
             printf("[TECH %d] Raport wysłany\n", sektor);
@@ -186,7 +150,8 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    /* shmdt(): odłącza shm od procesu pracownika*/
-    if (shmdt(stan) == -1) warn_errno("shmdt");
+    /* stan_odlacz(): odłącza shm od procesu pracownika*/
+    transport_odlacz(&transport);
+    if (stan_odlacz(stan) == -1) warn_errno("stan_odlacz");
     return 0;
 }
@@ -0,0 +1,130 @@
+#ifndef PRZYBYCIA_H
+#define PRZYBYCIA_H
+
+/*
+ * Proces przybyć kibiców dla generatora w main.c.
+ *
+ *  - "stale": dawne zachowanie, pętla zamknięta – usleep(1000 + rand()%1000) po każdym kibicu,
+ *    więc każdy przestój generatora (waitpid, brak slotu, fork) przesuwa wszystkie dalsze przybycia,
+ *  - pozostałe rozkłady to pętla otwarta: zamierzony czas przybycia liczymy z góry z rozkładu,
+ *    a generator śpi clock_nanosleep(TIMER_ABSTIME) do tej chwili. Spóźniony generator nie śpi
+ *    i nie przesuwa harmonogramu, a opóźnienia mierzone od czasu zamierzonego nie chowają
+ *    przestojów (coordinated omission).
+ *      * poisson: wykładnicze odstępy, średnio 1.5 ms (tyle co 1000 + rand()%1000 us),
+ *      * fala:    otwarcie bramek co sekundę – przez 200 ms 4x gęściej, potem 4x rzadziej
+ *                 (średnio tyle samo co poisson),
+ *      * rampa:   intensywność rośnie liniowo od 0 do 2x średniej w chwili startu meczu
+ *                 (CZAS_PRZED_MECZEM od startu generatora), potem jest stała,
+ *  - "natychmiast": wszyscy kibice mają ten sam czas zamierzony (start generatora) i nikt nie
+ *    czeka – test startu: generator tworzy kibiców tak szybko, jak potrafi.
+ *
+ * skala: podgenerator trybu ./main drzewo z N podgeneratorami dostaje skala = N, czyli N razy
+ * dłuższe odstępy – łącznie wszystkie podgeneratory dają ten sam strumień przybyć.
+ *
+ * Rozkłady niejednorodne losujemy przerzedzaniem (thinning): kandydaci z procesu Poissona
+ * o intensywności maksymalnej, kandydat zostaje z prawdopodobieństwem intensywnosc(t)/max.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+
+enum { ROZKLAD_STALY, ROZKLAD_POISSON, ROZKLAD_FALA, ROZKLAD_RAMPA, ROZKLAD_NATYCHMIAST, ROZKLAD_N };
+
+static const char *const NAZWY_ROZKLADOW[ROZKLAD_N] = {"stale", "poisson", "fala", "rampa", "natychmiast"};
+
+#define PRZYBYCIE_SREDNIO_NS 1500000LL
+#define FALA_OKRES_NS        1000000000LL
+#define FALA_SZCZYT_NS       200000000LL
+
+typedef struct {
+    int rozklad;
+    unsigned int ziarno;
+    int skala;          // mnożnik odstępów (1 = jeden generator)
+    long long start_ns; // 0 = jeszcze nie było pierwszego przybycia
+    long long nast_ns;  // zamierzony czas kolejnego przybycia
+} Przybycia;
+
+// Zwraca ROZKLAD_* albo -1, gdy nazwa nie jest rozkładem.
+static inline int rozklad_z_nazwy(const char *nazwa) {
+    for (int i = 0; i < ROZKLAD_N; i++) if (strcmp(nazwa, NAZWY_ROZKLADOW[i]) == 0) return i;
+    return -1;
+}
+
+static inline void przybycia_init(Przybycia *p, int rozklad, unsigned int ziarno) {
+    memset(p, 0, sizeof(*p));
+    p->rozklad = rozklad;
+    p->ziarno = ziarno;
+    p->skala = 1;
+}
+
+// Intensywność w chwili t (ns od startu) względem średniej (1.0 = co 1.5 ms).
+static inline double przybycia_intensywnosc(int rozklad, long long t) {
+    switch (rozklad) {
+        case ROZKLAD_FALA:
+            return (t % FALA_OKRES_NS < FALA_SZCZYT_NS) ? 4.0 : 0.25;
+        case ROZKLAD_RAMPA: {
+            double T = CZAS_PRZED_MECZEM * 1e9;
+            return (t < T) ? 2.0 * (double)t / T : 2.0;
+        }
+        default:
+            return 1.0;
+    }
+}
+
+static inline double przybycia_max(int rozklad) {
+    if (rozklad == ROZKLAD_FALA) return 4.0;
+    if (rozklad == ROZKLAD_RAMPA) return 2.0;
+    return 1.0;
+}
+
+static inline double przybycia_los01(Przybycia *p) {
+    return (rand_r(&p->ziarno) + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+// Kolejny zamierzony czas (ns od startu) po chwili t.
+static inline long long przybycia_po(Przybycia *p, long long t) {
+    double lmax = przybycia_max(p->rozklad);
+    double t_d = (double)t;
+    do {
+        t_d += -log(przybycia_los01(p)) * (double)PRZYBYCIE_SREDNIO_NS * p->skala / lmax;
+    } while (przybycia_los01(p) * lmax > przybycia_intensywnosc(p->rozklad, (long long)t_d));
+    return (long long)t_d;
+}
+
+/*
+ * Czeka na kolejne przybycie i zwraca jego zamierzony czas (CLOCK_MONOTONIC, ns).
+ * W trybie "stale" czas zamierzony = chwila po usleep (pętla zamknięta).
+ * Sygnał (EINTR) przerywa sen – wołający i tak sprawdza g_stop.
+ */
+static inline long long przybycia_czekaj(Przybycia *p) {
+    if (p->rozklad == ROZKLAD_STALY) {
+        if (p->start_ns != 0) usleep((1000 + (rand() % 1000)) * p->skala); /* nie chcemy odpalić wszystkiego naraz*/
+        else p->start_ns = czas_ns();
+        return czas_ns();
+    }
+    if (p->rozklad == ROZKLAD_NATYCHMIAST) {
+        if (p->start_ns == 0) p->start_ns = czas_ns();
+        return p->start_ns;
+    }
+
+    if (p->start_ns == 0) {
+        p->start_ns = czas_ns();
+        p->nast_ns = p->start_ns;
+        if (p->rozklad == ROZKLAD_RAMPA) p->nast_ns = p->start_ns + przybycia_po(p, 0);
+    }
+
+    long long cel = p->nast_ns;
+    struct timespec ts = {(time_t)(cel / 1000000000LL), (long)(cel % 1000000000LL)};
+    // Spóźnieni nie śpimy: clock_nanosleep z czasem w przeszłości wraca od razu
+    (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+    p->nast_ns = p->start_ns + przybycia_po(p, cel - p->start_ns);
+    return cel;
+}
+
+#endif
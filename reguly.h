@@ -0,0 +1,120 @@
+#ifndef REGULY_H
+#define REGULY_H
+
+#include "common.h"
+
+/*
+ * ===================
+ * REGUŁY TŁUMU
+ * ===================
+ * Jedno miejsce z zasadami, które muszą być identyczne niezależnie od tego,
+ * kto je wykonuje:
+ *  - kibic-proces / kibic-wątek (kibic_zycie.c) i kasjer (kasjer.c),
+ *  - silnik zdarzeniowy (silnik.c), gdzie kibic jest tylko rekordem stanu.
+ *
+ * Funkcje są czyste (bez IPC i bez semaforów) – wywołujący odpowiada za to,
+ * żeby dane wejściowe czytał pod właściwą blokadą.
+ */
+
+// Powód odmowy wejścia do bramki
+#define POWOD_KONFLIKT 1 // wolne miejsce jest, ale w bramce stoi inna drużyna
+#define POWOD_PELNO    2 // brak miejsca na naszą grupę
+
+// Dziecko (< 15 lat, nie VIP) nie porusza się bez opiekuna.
+static inline int reguly_dziecko(int wiek, int is_vip) {
+    return wiek < 15 && !is_vip;
+}
+
+/*
+ * Losowanie wieku i drużyny (rand_r z własnym ziarnem – bezpieczne w wątkach).
+ * "Koledzy" z 2 biletów nie są dziećmi, bo nie pojawiają się w kasie.
+ */
+static inline void reguly_losuj_cechy(int kolega, unsigned int *ziarno, int *wiek, int *druzyna) {
+    *wiek = 10 + rand_r(ziarno) % 60;
+    if (kolega && *wiek < 15) *wiek = 18 + rand_r(ziarno) % 42;
+    // 0=GOSP, 1=GOSC – na bramkach nie wolno mieszać drużyn
+    *druzyna = rand_r(ziarno) % 2;
+}
+
+// Ile "fizycznych osób" reprezentuje kibic: dziecko + opiekun zajmują 2 miejsca.
+static inline int reguly_grupa(int wiek, int is_vip) {
+    return reguly_dziecko(wiek, is_vip) ? 2 : 1;
+}
+
+/*
+ * Wybór bramki sektora:
+ *  - bramka ma limit MAX_NA_STANOWISKU osób,
+ *  - nie mieszamy drużyn: bramka pusta albo zajęta przez naszą drużynę.
+ * Zwraca indeks bramki albo -1; wtedy *powod = POWOD_KONFLIKT / POWOD_PELNO.
+ */
+static inline int reguly_wybierz_bramke(const Stanowisko bramki[2], int druzyna, int grupa, int *powod) {
+    *powod = 0;
+    for (int i = 0; i < 2; i++) {
+        int n = bramki[i].zajetosc;
+        int d = bramki[i].druzyna;
+
+        if (n + grupa <= MAX_NA_STANOWISKU) {
+            if (n == 0 || d == druzyna) return i;
+            *powod = POWOD_KONFLIKT;
+        } else {
+            if (*powod == 0) *powod = POWOD_PELNO;
+        }
+    }
+    return -1;
+}
+
+// Agresor wchodzi dopiero, gdy obie bramki sektora są puste (zawsze do bramki 0).
+static inline int reguly_bramki_puste(const Stanowisko bramki[2]) {
+    return bramki[0].zajetosc == 0 && bramki[1].zajetosc == 0;
+}
+
+// Cierpliwość: ilu kibiców przeciwnej drużyny nas wyprzedziło (kibic_zycie.c: dokładnie, z numerków
+// kolejki FIFO pod bramkami; silnik.c i des.c: wejścia przeciwników od początku konfliktu).
+static inline int reguly_cierpliwosc_wyczerpana(int przepuszczone) {
+    return przepuszczone >= LIMIT_CIERPLIWOSCI;
+}
+
+/*
+ * Ile biletów sprzedać do sektora z 'wolne' miejscami:
+ *  - para opiekun+dziecko: 2 albo nic (dziecko nie wchodzi samo),
+ *  - zwykły klient: 1 zawsze gdy jest miejsce, 2 tylko gdy chce 2 i jest slot na kolegę.
+ */
+static inline int reguly_ile_biletow(int wolne, int para_opiekun_dziecko, int slot_kolegi) {
+    if (para_opiekun_dziecko) return (wolne >= 2) ? 2 : 0;
+    if (wolne < 1) return 0;
+    return (slot_kolegi && wolne >= 2) ? 2 : 1;
+}
+
+/*
+ * Wybór sektora przy sprzedaży standardowej (jak pętla w kasjer.c) dla modeli bez IPC:
+ * start od losowego sektora, w każdym losujemy 1 albo 2 bilety (para zawsze 2).
+ * slot_kolegi mówi, czy jest miejsce na dodatkowego kibica – kolegę z drugiego biletu.
+ * Zwraca sektor albo -1 (brak miejsc); *ile = liczba biletów do sprzedania.
+ */
+static inline int reguly_wybierz_sektor(const int sprzedane[], int limit_sektor, int para_opiekun_dziecko,
+                                        int slot_kolegi, unsigned int *ziarno, int *ile) {
+    int start = rand_r(ziarno) % LICZBA_SEKTOROW;
+    for (int i = 0; i < LICZBA_SEKTOROW; i++) {
+        int s = (start + i) % LICZBA_SEKTOROW;
+        int chciane = para_opiekun_dziecko ? 2 : ((rand_r(ziarno) % 2) + 1);
+        *ile = reguly_ile_biletow(limit_sektor - sprzedane[s], para_opiekun_dziecko, slot_kolegi && chciane == 2);
+        if (*ile > 0) return s;
+    }
+    *ile = 0;
+    return -1;
+}
+
+/*
+ * Autoskalowanie kas (k_10 = K/10 osób „na jedną kasę”):
+ *  - zamykamy nadmiarową kasę, gdy kolejka < k_10 * (N-1) i aktywne są > 2,
+ *  - otwieramy kolejną, gdy kolejka wymaga więcej niż N kas.
+ */
+static inline int reguly_zamknac_kase(int aktywne, int kolejka, int k_10) {
+    return aktywne > 2 && kolejka < k_10 * (aktywne - 1);
+}
+
+static inline int reguly_otworzyc_kase(int aktywne, int kolejka, int k_10) {
+    return (kolejka / k_10) + 1 > aktywne && aktywne < LICZBA_KAS;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef RING_H
+#define RING_H
+
+/*
+ * Pierścień MPMC (wielu producentów / wielu konsumentów) w pamięci współdzielonej,
+ * bez semaforów: żądania kibic -> kasjer (osobny pierścień dla VIP i dla standardu).
+ *
+ * Algorytm z numerem sekwencyjnym w każdej komórce (D. Vyukov, "bounded MPMC queue"):
+ *  - ogon: następna pozycja do wstawienia (kibice), glowa: następna do zdjęcia (kasjerzy),
+ *  - komórka na pozycji p jest wolna, gdy seq == p, a zapełniona, gdy seq == p + 1,
+ *  - producent/konsument rezerwuje pozycję CAS-em na ogon/glowa, zapisuje/czyta dane
+ *    i dopiero potem publikuje komórkę nowym seq (release),
+ *  - zdjęta komórka dostaje seq = p + RING_POJEMNOSC, czyli jest wolna dla następnego okrążenia.
+ * Pozycje to 64-bitowe liczniki (nie przekręcą się), indeks komórki = p % RING_POJEMNOSC.
+ *
+ * Długość kolejki = ogon - glowa (liczba żądań, nie osób – para dziecko+opiekun to jedno żądanie).
+ * Pierścień jest zerowany przez ./setup, potem ring_init() ustawia numery sekwencyjne.
+ * Każde żądanie niesie czas wstawienia (czas_ns()) – kasjer mierzy z niego czas czekania.
+ */
+
+#include "metryki.h"
+
+#define RING_POJEMNOSC 16384 // potęga dwójki; pełny pierścień = kibic ponawia wstawienie
+
+typedef struct {
+    unsigned long long seq;
+    int kibic_id;
+    int grupa; // ile osób reprezentuje żądanie (dziecko z opiekunem = 2)
+    long long t_wstawienia_ns;
+} RingKomorka;
+
+typedef struct {
+    // glowa i ogon w osobnych liniach cache: kibice i kasjerzy nie unieważniają sobie nawzajem linii
+    unsigned long long ogon __attribute__((aligned(64)));
+    unsigned long long glowa __attribute__((aligned(64)));
+    RingKomorka komorki[RING_POJEMNOSC] __attribute__((aligned(64)));
+} Ring;
+
+static inline void ring_init(Ring *r) {
+    r->ogon = 0;
+    r->glowa = 0;
+    for (unsigned long long i = 0; i < RING_POJEMNOSC; i++) r->komorki[i].seq = i;
+}
+
+// Zwraca 1 po wstawieniu, 0 gdy pierścień jest pełny.
+static inline int ring_wstaw(Ring *r, int kibic_id, int grupa) {
+    unsigned long long poz = __atomic_load_n(&r->ogon, __ATOMIC_RELAXED);
+    while (1) {
+        RingKomorka *k = &r->komorki[poz & (RING_POJEMNOSC - 1)];
+        unsigned long long seq = __atomic_load_n(&k->seq, __ATOMIC_ACQUIRE);
+        long long roznica = (long long)(seq - poz);
+        if (roznica == 0) {
+            // Komórka wolna: rezerwujemy pozycję (przy porażce CAS wczytuje aktualny ogon do poz)
+            if (__atomic_compare_exchange_n(&r->ogon, &poz, poz + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                k->kibic_id = kibic_id;
+                k->grupa = grupa;
+                k->t_wstawienia_ns = czas_ns();
+                __atomic_store_n(&k->seq, poz + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (roznica < 0) {
+            return 0; // konsumenci jeszcze nie zdjęli żądania sprzed okrążenia
+        } else {
+            poz = __atomic_load_n(&r->ogon, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Zwraca 1 i wypełnia *kibic_id/*grupa (i *t_wstawienia_ns, jeśli nie NULL), albo 0 gdy pierścień jest pusty.
+static inline int ring_zdejmij(Ring *r, int *kibic_id, int *grupa, long long *t_wstawienia_ns) {
+    unsigned long long poz = __atomic_load_n(&r->glowa, __ATOMIC_RELAXED);
+    while (1) {
+        RingKomorka *k = &r->komorki[poz & (RING_POJEMNOSC - 1)];
+        unsigned long long seq = __atomic_load_n(&k->seq, __ATOMIC_ACQUIRE);
+        long long roznica = (long long)(seq - (poz + 1));
+        if (roznica == 0) {
+            if (__atomic_compare_exchange_n(&r->glowa, &poz, poz + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *kibic_id = k->kibic_id;
+                *grupa = k->grupa;
+                if (t_wstawienia_ns) *t_wstawienia_ns = k->t_wstawienia_ns;
+                __atomic_store_n(&k->seq, poz + RING_POJEMNOSC, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (roznica < 0) {
+            return 0; // producent jeszcze nie opublikował tej komórki (albo pusto)
+        } else {
+            poz = __atomic_load_n(&r->glowa, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Przybliżona długość (migawka bez blokady): wstawione - zdjęte.
+static inline int ring_dlugosc(const Ring *r) {
+    unsigned long long glowa = __atomic_load_n(&r->glowa, __ATOMIC_RELAXED);
+    unsigned long long ogon = __atomic_load_n(&r->ogon, __ATOMIC_RELAXED);
+    return (ogon > glowa) ? (int)(ogon - glowa) : 0;
+}
+
+/*
+ * Kanał sterujący: mały pierścień MPMC według tego samego schematu numerów sekwencyjnych,
+ * ale z 32-bitowymi pozycjami (poleceń sterujących jest mało, różnica liczona modulo 2^32).
+ * Polecenia kierownika dla pracownika, raporty "sektor pusty" i komendy do mastera w backendzie
+ * shm (transport.h); budzenie odbiorcy (zdarzenie + czeka) robi transport.h futexem.
+ */
+#define KANAL_POJEMNOSC 16 // potęga dwójki; pełny kanał = nadawca ponawia (jak blokujący msgsnd)
+
+typedef struct {
+    unsigned int seq;
+    int typ_sygnalu;
+    int sektor_id;
+} KanalKomorka;
+
+typedef struct {
+    unsigned int ogon;
+    unsigned int glowa;
+    unsigned int zdarzenie; // słowo futexa: +1 po każdym wstawieniu
+    int czeka;              // odbiorca śpi (albo zaraz zaśnie) na zdarzeniu
+    KanalKomorka komorki[KANAL_POJEMNOSC];
+} __attribute__((aligned(64))) KanalSterujacy;
+
+static inline void kanal_init(KanalSterujacy *k) {
+    k->ogon = 0;
+    k->glowa = 0;
+    for (unsigned int i = 0; i < KANAL_POJEMNOSC; i++) k->komorki[i].seq = i;
+}
+
+// Zwraca 1 po wstawieniu, 0 gdy kanał jest pełny.
+static inline int kanal_wstaw(KanalSterujacy *k, int typ_sygnalu, int sektor_id) {
+    unsigned int poz = __atomic_load_n(&k->ogon, __ATOMIC_RELAXED);
+    while (1) {
+        KanalKomorka *c = &k->komorki[poz & (KANAL_POJEMNOSC - 1)];
+        int roznica = (int)(__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) - poz);
+        if (roznica == 0) {
+            if (__atomic_compare_exchange_n(&k->ogon, &poz, poz + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                c->typ_sygnalu = typ_sygnalu;
+                c->sektor_id = sektor_id;
+                __atomic_store_n(&c->seq, poz + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (roznica < 0) {
+            return 0;
+        } else {
+            poz = __atomic_load_n(&k->ogon, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Zwraca 1 i wypełnia *typ_sygnalu/*sektor_id, albo 0 gdy kanał jest pusty.
+static inline int kanal_zdejmij(KanalSterujacy *k, int *typ_sygnalu, int *sektor_id) {
+    unsigned int poz = __atomic_load_n(&k->glowa, __ATOMIC_RELAXED);
+    while (1) {
+        KanalKomorka *c = &k->komorki[poz & (KANAL_POJEMNOSC - 1)];
+        int roznica = (int)(__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) - (poz + 1));
+        if (roznica == 0) {
+            if (__atomic_compare_exchange_n(&k->glowa, &poz, poz + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *typ_sygnalu = c->typ_sygnalu;
+                *sektor_id = c->sektor_id;
+                __atomic_store_n(&c->seq, poz + KANAL_POJEMNOSC, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (roznica < 0) {
+            return 0;
+        } else {
+            poz = __atomic_load_n(&k->glowa, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#endif
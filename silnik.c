@@ -0,0 +1,642 @@
+#include "reguly.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*
+ * ===================
+ * SILNIK ZDARZENIOWY
+ * ===================
+ * Jeden proces, kilka wątków-planistów, kibic = 16-bajtowy rekord stanu.
+ * Zamiast procesu blokującego się w msgrcv/semop kibic przechodzi przez stany
+ *   KOLEJKA -> CZEKA_NA_BILET -> PRZED_BRAMKA -> W_BRAMCE -> W_SEKTORZE -> EWAKUACJA -> POZA
+ * tylko wtedy, gdy zajdzie dotyczące go zdarzenie (koniec obsługi w kasie,
+ * zwolnienie bramki, koniec przejścia, ewakuacja). Dzięki temu na jednej
+ * maszynie da się puścić K rzędu milionów i zmierzyć przepustowość bramek.
+ *
+ * Czas jest wirtualny: 1 tik = 1 ms, stałe jak w wersji procesowej:
+ *  - kibic co 1-2 ms (main.c), obsługa w kasie 10 ms (kasjer.c),
+ *  - przejście przez bramkę 30 ms (kibic_zycie.c).
+ *
+ * Zasady tłumu pochodzą z reguly.h (te same co w kibic_zycie.c i kasjer.c):
+ *  - MAX_NA_STANOWISKU na bramkę i bez mieszania drużyn,
+ *  - LIMIT_CIERPLIWOSCI -> agresor z priorytetem (wchodzi, gdy obie bramki puste),
+ *  - dziecko + opiekun = jeden rekord z grupą 2 (2 bilety, 2 miejsca w bramce),
+ *  - raca -> wyproszenie na kontroli,
+ *  - sprzedaż 1/2 biletów, "kolega" z drugiego biletu, autoskalowanie kas.
+ *
+ * Świadome uproszczenia wobec procesów:
+ *  - przed bramkami czeka się w kolejce FIFO osobno dla każdej drużyny zamiast
+ *    losowych ponowień co 10 ms, więc "przepuszczonych" liczy kibic z czoła kolejki,
+ *  - nie ma kierownika: brak blokad sektorów (komendy 1/2), ewakuacja tylko na koniec.
+ *
+ * Wątki:
+ *  - kasy nie zależą od stanu bramek, więc wątek 0 liczy przybycia, autoskalowanie
+ *    i kasy (jedna księga sprzedaży) od razu dla okna OKNO_TIKOW tików,
+ *  - potem każdy wątek przechodzi to samo okno dla swoich sektorów (sektor s -> wątek s % watki);
+ *    kibic dopisany pod sektor w tiku t jest widoczny przy bramkach dopiero od tiku t,
+ *  - fazy rozdziela pthread_barrier (raz na okno, nie na tik), więc dane sektora ma
+ *    naraz tylko jeden wątek i nie potrzebujemy żadnych blokad ani atomików.
+ *
+ * Użycie: ./silnik [K [watki [czas_s [skala_przybyc [ziarno]]]]]
+ *  - czas_s = 0: bez limitu meczu, kończymy gdy nikt już nie czeka,
+ *  - skala_przybyc: ile razy gęściej niż w main.c przychodzą kibice.
+ */
+
+#define CZAS_OBSLUGI_MS 10
+#define CZAS_BRAMKI_MS  30
+#define OKNO_TIKOW      64
+#define BRAK UINT32_MAX
+
+enum {
+    FAN_KOLEJKA,        // w kolejce do kas
+    FAN_CZEKA_NA_BILET, // obsługiwany w kasie
+    FAN_PRZED_BRAMKA,   // z biletem, w kolejce swojej drużyny pod sektorem
+    FAN_W_BRAMCE,       // przechodzi kontrolę
+    FAN_W_SEKTORZE,
+    FAN_EWAKUACJA,
+    FAN_POZA            // wyszedł: bez biletu, wyproszony, nie zdążył albo po ewakuacji
+};
+
+#define F_VIP      0x01
+#define F_RACA     0x02
+#define F_DRUZYNA  0x04
+#define F_KOLEGA   0x08
+#define F_KONFLIKT 0x10 // konflikt drużyn trwa, start_opp jest ważny
+
+typedef struct {
+    uint8_t stan;
+    uint8_t flagi;
+    uint8_t sektor;
+    uint8_t wiek;
+    uint32_t nast;      // następny rekord na liście (BRAK = koniec)
+    uint32_t t_kolejki; // tik dołączenia pod sektor (kolejność między drużynami)
+    uint32_t start_opp; // wejścia przeciwników na kontrolę w chwili początku konfliktu
+} Fan;
+
+// Lista FIFO wpleciona w rekordy (pole nast) – kibic jest naraz na co najwyżej jednej liście.
+typedef struct {
+    uint32_t glowa, ogon, n;
+} Lista;
+
+typedef struct {
+    uint32_t fan;
+    uint32_t t_koniec;
+} Przejscie;
+
+typedef struct {
+    Stanowisko bramki[2];
+    Przejscie w_bramce[2][MAX_NA_STANOWISKU]; // w kolejności wejścia = w kolejności wyjścia
+    int n_w_bramce[2];
+    int wejscia_kontrola[2];
+    Lista czeka[2];   // FIFO pod sektorem, osobno dla każdej drużyny
+    Lista siedzacy;
+    Lista wychodzacy; // w trakcie ewakuacji
+    uint32_t agresor; // kibic z priorytetem (BRAK = nikt)
+
+    // Statystyki – pisze tylko wątek-właściciel sektora
+    long long weszlo, opiekunowie, koledzy, agresja, wyrzuceni;
+    long long przez_bramki; // osoby, które zakończyły przejście
+    long long nie_weszli, ewakuowani;
+    int obecni;
+} __attribute__((aligned(64))) Sektor;
+
+typedef struct {
+    int aktywna;
+    uint32_t fan; // obsługiwany kibic (BRAK = wolna)
+    uint32_t t_koniec;
+} Kasa;
+
+static struct {
+    // Parametry
+    int k, watki, limit_sektor, limit_vip, k_10, total, max_vip;
+    uint32_t czas_ms;
+    double skala;
+
+    Fan *fany;
+    uint32_t n_fanow, pojemnosc;
+    Sektor sektory[LICZBA_SEKTOROW + 1];
+
+    // Część wątku 0: przybycia + kasy
+    unsigned int ziarno;
+    int wygenerowani, vip_cnt, generator_koniec, koledzy;
+    double t_przybycia_us;
+    Lista kolejka_vip, kolejka_zwykla;
+    int q_vip, q_std; // osoby w kolejkach (jak kolejka_vip/kolejka_zwykla w SharedState)
+    Kasa kasy[LICZBA_KAS];
+    int sprzedane[LICZBA_SEKTOROW + 1];
+    int standard_sold_out, sprzedaz_zakonczona;
+    long long bez_biletu;
+
+    // Sterowanie fazami (zapis tylko w fazie wątku 0, odczyt po barierze)
+    int ewakuacja, koniec;
+    uint32_t t_ewakuacji, tiki, okno;
+    pthread_barrier_t bariera;
+} sim;
+
+static void lista_dodaj(Lista *l, uint32_t f) {
+    sim.fany[f].nast = BRAK;
+    if (l->n == 0) l->glowa = f;
+    else sim.fany[l->ogon].nast = f;
+    l->ogon = f;
+    l->n++;
+}
+
+static uint32_t lista_zdejmij(Lista *l) {
+    if (l->n == 0) return BRAK;
+    uint32_t f = l->glowa;
+    l->glowa = sim.fany[f].nast;
+    l->n--;
+    return f;
+}
+
+static int fan_grupa(const Fan *f) {
+    return reguly_grupa(f->wiek, f->flagi & F_VIP);
+}
+
+static uint32_t fan_nowy(int is_vip, int ma_race, int kolega) {
+    if (sim.n_fanow >= sim.pojemnosc) return BRAK;
+    uint32_t i = sim.n_fanow++;
+    Fan *f = &sim.fany[i];
+    int wiek, druzyna;
+    reguly_losuj_cechy(kolega, &sim.ziarno, &wiek, &druzyna);
+    f->wiek = (uint8_t)wiek;
+    f->flagi = (is_vip ? F_VIP : 0) | (ma_race ? F_RACA : 0) | (druzyna ? F_DRUZYNA : 0) | (kolega ? F_KOLEGA : 0);
+    f->nast = BRAK;
+    return i;
+}
+
+// Kibic opuszcza kolejkę do kas bez biletu
+static void odeslij_wszystkich(Lista *l, int *q) {
+    uint32_t f;
+    while ((f = lista_zdejmij(l)) != BRAK) {
+        sim.fany[f].stan = FAN_POZA;
+        sim.bez_biletu++;
+    }
+    *q = 0;
+}
+
+static void ustaw_sold_out(void) {
+    if (!sim.standard_sold_out) {
+        int wszystkie = 1;
+        for (int s = 0; s < LICZBA_SEKTOROW; s++) if (sim.sprzedane[s] < sim.limit_sektor) wszystkie = 0;
+        if (wszystkie) {
+            sim.standard_sold_out = 1;
+            odeslij_wszystkich(&sim.kolejka_zwykla, &sim.q_std);
+        }
+    }
+    if (sim.standard_sold_out && !sim.sprzedaz_zakonczona && sim.sprzedane[SEKTOR_VIP] >= sim.limit_vip) {
+        sim.sprzedaz_zakonczona = 1;
+        odeslij_wszystkich(&sim.kolejka_vip, &sim.q_vip);
+        for (int i = 0; i < LICZBA_KAS; i++) sim.kasy[i].aktywna = 0;
+    }
+}
+
+static void pod_sektor(uint32_t f, int sektor, uint32_t t) {
+    Fan *fan = &sim.fany[f];
+    fan->stan = FAN_PRZED_BRAMKA;
+    fan->sektor = (uint8_t)sektor;
+    fan->t_kolejki = t;
+    lista_dodaj(&sim.sektory[sektor].czeka[(fan->flagi & F_DRUZYNA) ? 1 : 0], f);
+}
+
+/* Sprzedaż jak w kasjer.c: VIP osobno, standard od losowego sektora, 2 bilety -> kolega */
+static void sprzedaj(uint32_t f, uint32_t t) {
+    Fan *fan = &sim.fany[f];
+    int grupa = fan_grupa(fan);
+
+    if (fan->flagi & F_VIP) {
+        if (sim.sprzedane[SEKTOR_VIP] + grupa <= sim.limit_vip) {
+            sim.sprzedane[SEKTOR_VIP] += grupa;
+            // VIP omija bramki – od razu w sektorze (poza ewakuacją sektor VIP zmienia tylko faza kas)
+            Sektor *vip = &sim.sektory[SEKTOR_VIP];
+            fan->stan = FAN_W_SEKTORZE;
+            fan->sektor = SEKTOR_VIP;
+            vip->weszlo++;
+            if (fan->wiek < 15) vip->opiekunowie++;
+            vip->obecni++;
+            lista_dodaj(&vip->siedzacy, f);
+        } else {
+            fan->stan = FAN_POZA;
+            sim.bez_biletu++;
+        }
+        ustaw_sold_out();
+        return;
+    }
+
+    int para = (grupa == 2);
+    int ile = 0;
+    // "Slot na kolegę" = wolny rekord w puli (odpowiednik reserve_process_slot)
+    int sektor = reguly_wybierz_sektor(sim.sprzedane, sim.limit_sektor, para,
+                                       sim.n_fanow < sim.pojemnosc, &sim.ziarno, &ile);
+    if (sektor != -1) sim.sprzedane[sektor] += ile;
+
+    if (sektor == -1) {
+        fan->stan = FAN_POZA;
+        sim.bez_biletu++;
+        ustaw_sold_out();
+        return;
+    }
+
+    pod_sektor(f, sektor, t);
+    if (!para && ile == 2) {
+        uint32_t k = fan_nowy(0, 0, 1);
+        sim.koledzy++;
+        pod_sektor(k, sektor, t);
+    }
+    ustaw_sold_out();
+}
+
+/* Przybycia jak generator w main.c: VIP ~0.3% (max 0.3% K), raca ~0.5% */
+static void przybycia(uint32_t t) {
+    while (!sim.generator_koniec && sim.t_przybycia_us <= (double)t * 1000.0) {
+        if (sim.wygenerowani >= sim.total || sim.sprzedaz_zakonczona) { sim.generator_koniec = 1; break; }
+        int i = sim.wygenerowani;
+
+        int is_vip = 0;
+        if (sim.standard_sold_out) {
+            if (sim.vip_cnt >= sim.max_vip) { sim.generator_koniec = 1; break; }
+            is_vip = 1;
+            sim.vip_cnt++;
+        } else if (sim.vip_cnt < sim.max_vip) {
+            if ((rand_r(&sim.ziarno) % 1000 < 3) || (sim.total - i <= sim.max_vip - sim.vip_cnt)) {
+                is_vip = 1;
+                sim.vip_cnt++;
+            }
+        }
+        int has_raca = (rand_r(&sim.ziarno) % 1000 < 5) ? 1 : 0;
+
+        uint32_t f = fan_nowy(is_vip, has_raca, 0);
+        sim.wygenerowani++;
+        sim.t_przybycia_us += (1000.0 + rand_r(&sim.ziarno) % 1000) / sim.skala;
+
+        Fan *fan = &sim.fany[f];
+        fan->stan = FAN_KOLEJKA;
+        if (is_vip) {
+            lista_dodaj(&sim.kolejka_vip, f);
+            sim.q_vip += fan_grupa(fan);
+        } else {
+            lista_dodaj(&sim.kolejka_zwykla, f);
+            sim.q_std += fan_grupa(fan);
+        }
+    }
+}
+
+static int nikt_nie_czeka(void) {
+    if (!sim.generator_koniec) return 0;
+    if (sim.kolejka_vip.n || sim.kolejka_zwykla.n) return 0;
+    for (int i = 0; i < LICZBA_KAS; i++) if (sim.kasy[i].fan != BRAK) return 0;
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) {
+        Sektor *sk = &sim.sektory[s];
+        if (sk->czeka[0].n || sk->czeka[1].n || sk->n_w_bramce[0] || sk->n_w_bramce[1] || sk->agresor != BRAK) return 0;
+    }
+    return 1;
+}
+
+/* Jeden tik kas: przybycia, autoskalowanie, koniec obsługi i pobranie kolejnych klientów */
+static void kasy_tik(uint32_t t) {
+    przybycia(t);
+
+    /* Autoskalowanie: jedna decyzja na tik, zamyka się tylko wolna kasa o id > 1 */
+    if (!sim.sprzedaz_zakonczona) {
+        int total_queue = sim.q_vip + (sim.standard_sold_out ? 0 : sim.q_std);
+        int N = 0;
+        for (int i = 0; i < LICZBA_KAS; i++) if (sim.kasy[i].aktywna) N++;
+
+        if (reguly_zamknac_kase(N, total_queue, sim.k_10)) {
+            for (int i = LICZBA_KAS - 1; i > 1; i--) {
+                if (sim.kasy[i].aktywna && sim.kasy[i].fan == BRAK) { sim.kasy[i].aktywna = 0; break; }
+            }
+        } else if (reguly_otworzyc_kase(N, total_queue, sim.k_10)) {
+            for (int i = 0; i < LICZBA_KAS; i++) {
+                if (!sim.kasy[i].aktywna) { sim.kasy[i].aktywna = 1; break; }
+            }
+        }
+    }
+
+    for (int i = 0; i < LICZBA_KAS; i++) {
+        Kasa *k = &sim.kasy[i];
+        if (k->fan != BRAK && k->t_koniec <= t) {
+            uint32_t f = k->fan;
+            k->fan = BRAK;
+            sprzedaj(f, t);
+        }
+        if (k->fan != BRAK || !k->aktywna || sim.sprzedaz_zakonczona) continue;
+
+        // Priorytet: VIP zawsze pierwszy
+        uint32_t f = BRAK;
+        if (sim.kolejka_vip.n) {
+            f = lista_zdejmij(&sim.kolejka_vip);
+            sim.q_vip -= fan_grupa(&sim.fany[f]);
+        } else if (!sim.standard_sold_out && sim.kolejka_zwykla.n) {
+            f = lista_zdejmij(&sim.kolejka_zwykla);
+            sim.q_std -= fan_grupa(&sim.fany[f]);
+        }
+        if (f == BRAK) continue;
+
+        sim.fany[f].stan = FAN_CZEKA_NA_BILET;
+        k->fan = f;
+        k->t_koniec = t + CZAS_OBSLUGI_MS;
+    }
+}
+
+/*
+ * Faza wątku 0: koniec meczu / ewakuacja, a poza nią kasy dla całego okna.
+ * Zwraca liczbę tików okna, które potem przejdą sektory.
+ */
+static uint32_t faza_kas(uint32_t t) {
+    if (sim.ewakuacja) {
+        // Tik ewakuacji: sektory -> EWAKUACJA, następny tik: -> POZA, potem koniec
+        if (t >= sim.t_ewakuacji + 2) { sim.koniec = 1; sim.tiki = t; }
+        return 1;
+    }
+
+    if ((sim.czas_ms && t >= sim.czas_ms) || (!sim.czas_ms && nikt_nie_czeka())) {
+        sim.ewakuacja = 1;
+        sim.t_ewakuacji = t;
+        odeslij_wszystkich(&sim.kolejka_vip, &sim.q_vip);
+        odeslij_wszystkich(&sim.kolejka_zwykla, &sim.q_std);
+        for (int i = 0; i < LICZBA_KAS; i++) {
+            if (sim.kasy[i].fan != BRAK) {
+                sim.fany[sim.kasy[i].fan].stan = FAN_POZA;
+                sim.bez_biletu++;
+                sim.kasy[i].fan = BRAK;
+            }
+            sim.kasy[i].aktywna = 0;
+        }
+        return 1;
+    }
+
+    uint32_t w = OKNO_TIKOW;
+    if (sim.czas_ms && t + w > sim.czas_ms) w = sim.czas_ms - t;
+    for (uint32_t i = 0; i < w; i++) kasy_tik(t + i);
+    return w;
+}
+
+static void wpusc(Sektor *sk, uint32_t f, int b, uint32_t t) {
+    Fan *fan = &sim.fany[f];
+    int grupa = fan_grupa(fan);
+    int druzyna = (fan->flagi & F_DRUZYNA) ? 1 : 0;
+
+    // Jak bump_entered(): wejście do bramki liczy się jako "wszedł"
+    sk->weszlo += grupa;
+    if (fan->wiek < 15) sk->opiekunowie++;
+    if (fan->flagi & F_KOLEGA) sk->koledzy++;
+
+    sk->bramki[b].zajetosc += grupa;
+    sk->bramki[b].druzyna = druzyna;
+    sk->wejscia_kontrola[druzyna] += grupa;
+
+    Przejscie *p = &sk->w_bramce[b][sk->n_w_bramce[b]++];
+    p->fan = f;
+    p->t_koniec = t + CZAS_BRAMKI_MS;
+    fan->stan = FAN_W_BRAMCE;
+}
+
+/*
+ * Próba wpuszczenia kibica z czoła kolejki drużyny.
+ * Zwraca 1, gdy coś się zmieniło (wszedł, wyproszony albo został agresorem).
+ */
+static int probuj_czolo(Sektor *sk, int druzyna, uint32_t t) {
+    Lista *l = &sk->czeka[druzyna];
+    if (l->n == 0) return 0;
+    uint32_t f = l->glowa;
+    Fan *fan = &sim.fany[f];
+    // Kasy liczą całe okno z wyprzedzeniem – kibic pojawia się pod sektorem dopiero w swoim tiku
+    if (fan->t_kolejki > t) return 0;
+
+    /* Kontrola na bramkach: kibic z racą wylatuje */
+    if (fan->flagi & F_RACA) {
+        lista_zdejmij(l);
+        fan->stan = FAN_POZA;
+        sk->wyrzuceni++;
+        return 1;
+    }
+
+    int powod = 0;
+    int b = reguly_wybierz_bramke(sk->bramki, druzyna, fan_grupa(fan), &powod);
+    if (b != -1) {
+        lista_zdejmij(l);
+        wpusc(sk, f, b, t);
+        return 1;
+    }
+
+    if (powod != POWOD_KONFLIKT) {
+        fan->flagi &= ~F_KONFLIKT;
+        return 0;
+    }
+
+    int opp = 1 - druzyna;
+    if (!(fan->flagi & F_KONFLIKT)) {
+        fan->flagi |= F_KONFLIKT;
+        fan->start_opp = (uint32_t)sk->wejscia_kontrola[opp];
+    }
+    int przepuszczone = sk->wejscia_kontrola[opp] - (int)fan->start_opp;
+    if (!reguly_cierpliwosc_wyczerpana(przepuszczone)) return 0;
+
+    lista_zdejmij(l);
+    sk->agresja++;
+    sk->agresor = f;
+    return 1;
+}
+
+static void ewakuuj_sektor(Sektor *sk, uint32_t t) {
+    if (t == sim.t_ewakuacji) {
+        // Czekający i będący w bramce już nie wejdą
+        for (int d = 0; d < 2; d++) {
+            uint32_t f;
+            while ((f = lista_zdejmij(&sk->czeka[d])) != BRAK) {
+                sim.fany[f].stan = FAN_POZA;
+                sk->nie_weszli++;
+            }
+        }
+        if (sk->agresor != BRAK) {
+            sim.fany[sk->agresor].stan = FAN_POZA;
+            sk->nie_weszli++;
+            sk->agresor = BRAK;
+        }
+        for (int b = 0; b < 2; b++) {
+            for (int i = 0; i < sk->n_w_bramce[b]; i++) {
+                sim.fany[sk->w_bramce[b][i].fan].stan = FAN_POZA;
+                sk->nie_weszli++;
+            }
+            sk->n_w_bramce[b] = 0;
+            sk->bramki[b].zajetosc = 0;
+        }
+
+        uint32_t f;
+        while ((f = lista_zdejmij(&sk->siedzacy)) != BRAK) {
+            sim.fany[f].stan = FAN_EWAKUACJA;
+            lista_dodaj(&sk->wychodzacy, f);
+        }
+        return;
+    }
+
+    uint32_t f;
+    while ((f = lista_zdejmij(&sk->wychodzacy)) != BRAK) {
+        Fan *fan = &sim.fany[f];
+        int grupa = fan_grupa(fan);
+        fan->stan = FAN_POZA;
+        sk->obecni -= grupa;
+        sk->ewakuowani += grupa;
+    }
+}
+
+/* Faza sektora: koniec przejść, potem wpuszczanie aż nic się nie zmieni */
+static void faza_sektora(int s, uint32_t t) {
+    Sektor *sk = &sim.sektory[s];
+    if (sim.ewakuacja) { ewakuuj_sektor(sk, t); return; }
+    if (s == SEKTOR_VIP) return;
+
+    for (int b = 0; b < 2; b++) {
+        while (sk->n_w_bramce[b] > 0 && sk->w_bramce[b][0].t_koniec <= t) {
+            uint32_t f = sk->w_bramce[b][0].fan;
+            memmove(&sk->w_bramce[b][0], &sk->w_bramce[b][1], (size_t)(--sk->n_w_bramce[b]) * sizeof(Przejscie));
+            int grupa = fan_grupa(&sim.fany[f]);
+            sk->bramki[b].zajetosc -= grupa;
+            sk->przez_bramki += grupa;
+            sim.fany[f].stan = FAN_W_SEKTORZE;
+            sk->obecni += grupa;
+            lista_dodaj(&sk->siedzacy, f);
+        }
+    }
+
+    while (1) {
+        // Agresor ma priorytet: nikt inny nie wchodzi, dopóki on nie przejdzie
+        if (sk->agresor != BRAK) {
+            if (!reguly_bramki_puste(sk->bramki)) break;
+            wpusc(sk, sk->agresor, 0, t);
+            sk->agresor = BRAK;
+            continue;
+        }
+
+        // Najpierw czoło, które dłużej czeka pod sektorem
+        int pierwsza = 0;
+        if (sk->czeka[0].n && sk->czeka[1].n &&
+            sim.fany[sk->czeka[1].glowa].t_kolejki < sim.fany[sk->czeka[0].glowa].t_kolejki) pierwsza = 1;
+
+        if (probuj_czolo(sk, pierwsza, t)) continue;
+        if (probuj_czolo(sk, 1 - pierwsza, t)) continue;
+        break;
+    }
+}
+
+static void *planista(void *arg) {
+    int id = (int)(intptr_t)arg;
+    uint32_t t = 0;
+    while (1) {
+        if (id == 0) sim.okno = faza_kas(t);
+        pthread_barrier_wait(&sim.bariera);
+        if (sim.koniec) break;
+        // Kopia lokalna: wątek 0 nadpisze sim.okno, zanim reszta dojdzie do kolejnej bariery
+        uint32_t w = sim.okno;
+
+        for (int s = id; s <= LICZBA_SEKTOROW; s += sim.watki) {
+            for (uint32_t i = 0; i < w; i++) faza_sektora(s, t + i);
+        }
+        pthread_barrier_wait(&sim.bariera);
+        t += w;
+    }
+    return NULL;
+}
+
+static void wypisz_wyniki(double sekundy) {
+    long long weszlo = 0, opiekunowie = 0, koledzy = 0, agresja = 0, wyrzuceni = 0;
+    long long przez_bramki = 0, nie_weszli = 0, ewakuowani = 0;
+    long long bramki_min = -1, bramki_max = 0;
+
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) {
+        Sektor *sk = &sim.sektory[s];
+        weszlo += sk->weszlo;
+        opiekunowie += sk->opiekunowie;
+        koledzy += sk->koledzy;
+        agresja += sk->agresja;
+        wyrzuceni += sk->wyrzuceni;
+        nie_weszli += sk->nie_weszli;
+        ewakuowani += sk->ewakuowani;
+        if (s == SEKTOR_VIP) continue;
+        przez_bramki += sk->przez_bramki;
+        if (bramki_min < 0 || sk->przez_bramki < bramki_min) bramki_min = sk->przez_bramki;
+        if (sk->przez_bramki > bramki_max) bramki_max = sk->przez_bramki;
+    }
+
+    double wirtualne_s = sim.tiki / 1000.0;
+    printf("\n=== SILNIK: K=%d, wątki=%d, tiki=%u (%.1f s symulacji), przybycia x%.1f ===\n",
+           sim.k, sim.watki, sim.tiki, wirtualne_s, sim.skala);
+    printf("Rekordy kibiców: %u (%zu B każdy, %.1f MB), przybyło %d, kolegów %d\n",
+           sim.n_fanow, sizeof(Fan), (double)sim.pojemnosc * sizeof(Fan) / (1024.0 * 1024.0),
+           sim.wygenerowani, sim.koledzy);
+    printf("Sprzedane bilety:");
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) printf(" S%d=%d", s, sim.sprzedane[s]);
+    printf(" VIP=%d\n", sim.sprzedane[SEKTOR_VIP]);
+    printf("Weszło: %lld (opiekunowie %lld, koledzy %lld), agresja: %lld, wyproszeni (raca): %lld\n",
+           weszlo, opiekunowie, koledzy, agresja, wyrzuceni);
+    printf("Bez biletu: %lld, nie zdążyli wejść: %lld, ewakuowani: %lld\n",
+           sim.bez_biletu, nie_weszli, ewakuowani);
+    printf("Przepustowość bramek: %lld osób, %.1f osób/s symulacji (sektor min %lld / max %lld)\n",
+           przez_bramki, wirtualne_s > 0 ? przez_bramki / wirtualne_s : 0.0, bramki_min, bramki_max);
+    printf("Czas rzeczywisty: %.3f s, %.0f tików/s, %.2fx czasu rzeczywistego\n",
+           sekundy, sekundy > 0 ? sim.tiki / sekundy : 0.0, sekundy > 0 ? wirtualne_s / sekundy : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    setbuf(stdout, NULL);
+
+    if (argc > 6) {
+        fprintf(stderr, "Użycie: %s [K [watki [czas_s [skala_przybyc [ziarno]]]]]\n", argv[0]);
+        exit(1);
+    }
+
+    sim.k = (argc > 1) ? atoi(argv[1]) : K;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    sim.watki = (argc > 2) ? atoi(argv[2]) : (int)(ncpu > 4 ? 4 : (ncpu < 1 ? 1 : ncpu));
+    sim.czas_ms = (uint32_t)((argc > 3) ? atoi(argv[3]) : (CZAS_PRZED_MECZEM + CZAS_MECZU)) * 1000u;
+    sim.skala = (argc > 4) ? atof(argv[4]) : 1.0;
+    sim.ziarno = (argc > 5) ? (unsigned int)strtoul(argv[5], NULL, 10) : (unsigned int)time(NULL);
+
+    if (sim.k < 10 || sim.watki < 1 || sim.skala <= 0) {
+        fprintf(stderr, "Błędne parametry: K >= 10, watki >= 1, skala_przybyc > 0\n");
+        exit(1);
+    }
+    if (sim.watki > LICZBA_SEKTOROW + 1) sim.watki = LICZBA_SEKTOROW + 1;
+
+    // Limity jak w kasjer.c / main.c
+    sim.limit_sektor = sim.k / 8;
+    sim.limit_vip = (int)(sim.k * 0.003);
+    if (sim.limit_vip < 1) sim.limit_vip = 1;
+    sim.max_vip = sim.limit_vip;
+    sim.k_10 = sim.k / 10;
+    sim.total = (int)(sim.k * 0.85);
+
+    // Przybyli + co najwyżej jeden kolega na każdy sprzedany bilet
+    sim.pojemnosc = (uint32_t)sim.total + (uint32_t)sim.k;
+    sim.fany = calloc(sim.pojemnosc, sizeof(Fan));
+    if (!sim.fany) die_errno("calloc(fany)");
+
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) sim.sektory[s].agresor = BRAK;
+    for (int i = 0; i < LICZBA_KAS; i++) sim.kasy[i].fan = BRAK;
+    sim.kasy[0].aktywna = 1;
+    sim.kasy[1].aktywna = 1;
+
+    int e = pthread_barrier_init(&sim.bariera, NULL, (unsigned)sim.watki);
+    if (e != 0) { errno = e; die_errno("pthread_barrier_init"); }
+
+    pthread_t *watki = calloc((size_t)sim.watki, sizeof(pthread_t));
+    if (!watki) die_errno("calloc(watki)");
+
+    long long t0 = czas_ns();
+    for (int i = 1; i < sim.watki; i++) {
+        e = pthread_create(&watki[i], NULL, planista, (void *)(intptr_t)i);
+        if (e != 0) { errno = e; die_errno("pthread_create(planista)"); }
+    }
+    planista((void *)0);
+    for (int i = 1; i < sim.watki; i++) pthread_join(watki[i], NULL);
+    double sekundy = (czas_ns() - t0) / 1e9;
+
+    wypisz_wyniki(sekundy);
+
+    pthread_barrier_destroy(&sim.bariera);
+    free(watki);
+    free(sim.fany);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+/*
+ * Uruchamianie ról, które od razu robią exec (./kibic, ./kasjer, ./pracownik, ./kierownik).
+ *  - domyślnie posix_spawn(): glibc robi clone(CLONE_VM|CLONE_VFORK), więc nie kopiuje
+ *    tablic stron rodzica – koszt nie rośnie razem z jego pamięcią,
+ *  - make SPAWN=fork: klasyczne fork() + execv(), do porównania.
+ *
+ * Czas wywołania (w rodzicu) trafia do histogramu h, jeśli go podano.
+ * Uwaga przy porównaniu: posix_spawn wraca dopiero po exec w dziecku,
+ * a fork() zaraz po skopiowaniu procesu – exec liczy się wtedy po stronie dziecka
+ * (widać go w start_kibica).
+ *
+ * Dziecko zawsze startuje z pustą maską sygnałów – main blokuje SIGCHLD dla reapera (signalfd),
+ * a ta blokada nie może przejść na ./kibic i role.
+ */
+
+#include "common.h"
+
+#include <spawn.h>
+
+extern char **environ;
+
+#ifdef SPAWN_FORK
+#define SPAWN_BACKEND "fork+exec"
+#else
+#define SPAWN_BACKEND "posix_spawn"
+#endif
+
+// Zwraca pid dziecka albo -1 (errno ustawione).
+static inline pid_t spawn_program(const char *sciezka, char *const argv[], Histogram *h) {
+    long long t0 = czas_ns();
+    pid_t pid;
+
+#ifdef SPAWN_FORK
+    /* fork(): kopia procesu, dziecko od razu podmienia obraz przez exec */
+    pid = fork();
+    if (pid == 0) {
+        sigset_t pusta;
+        sigemptyset(&pusta);
+        if (sigprocmask(SIG_SETMASK, &pusta, NULL) == -1) warn_errno("sigprocmask");
+        execv(sciezka, argv);
+        die_errno("execv");
+    }
+#else
+    /* posix_spawnattr: POSIX_SPAWN_SETSIGMASK z pustą maską */
+    posix_spawnattr_t attr;
+    sigset_t pusta;
+    sigemptyset(&pusta);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &pusta);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    /* posix_spawn(): zwraca kod błędu zamiast ustawiać errno */
+    int e = posix_spawn(&pid, sciezka, NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (e != 0) {
+        errno = e;
+        pid = -1;
+    }
+#endif
+
+    if (pid > 0 && h) hist_dodaj(h, czas_ns() - t0);
+    return pid;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef SYNCHRO_H
+#define SYNCHRO_H
+
+/*
+ * Wykluczanie wzajemne na SharedState – backend wybierany przy kompilacji:
+ *  - domyślnie (sysv): mutex = semafor System V z zestawu KEY_SEM, semop(-1) / semop(+1),
+ *    czyli dwa wywołania systemowe na sekcję krytyczną nawet bez rywalizacji,
+ *  - make SYNC=pthread (-DSYNC_PTHREAD): pthread_mutex_t w SharedState
+ *    (PTHREAD_PROCESS_SHARED + PTHREAD_MUTEX_ROBUST). Bez rywalizacji lock/unlock to jedna
+ *    operacja atomowa w przestrzeni użytkownika, do kernela (futex) idziemy tylko, gdy ktoś czeka.
+ *    Robust: gdy właściciel zginie z blokadą (np. SIGKILL), następny dostaje EOWNERDEAD
+ *    i przejmuje mutex (pthread_mutex_consistent) zamiast wisieć na zawsze.
+ *
+ * Backend dotyczy tylko mutexów: SEM_SPRZEDAZ .. SEM_SEKTOR_START + sektor (kolejność blokad
+ * w common.h; numery 0..LICZBA_MUTEXOW-1 są też indeksami w stan->mutexy[] i stan->blokady[]).
+ * Zdarzenia (SEM_EWAKUACJA, SEM_SEKTOR_BLOCK_*), licznik SEM_POSREDNIK i SEM_KIEROWNIK (SEM_UNDO)
+ * zostają semaforami System V – sem_op() niżej.
+ *
+ * Plik dołącza common.h (po definicji SharedState), nie włączamy go osobno.
+ */
+
+#include <sys/sem.h>
+#ifdef SYNC_PTHREAD
+#define SYNC_BACKEND "pthread"
+#else
+#define SYNC_BACKEND "sysv"
+#endif
+
+/*
+ * semop() z ponawianiem po EINTR. Zwraca 0 albo -1 (errno; EIDRM/EINVAL = zestaw skasowany przez ./clean).
+ * Dla kibica (kibic_zycie.c), który w ./main watki jest wątkiem main i nie może kończyć procesu.
+ */
+static inline int sem_op_r(int semid, int idx, int op) {
+    struct sembuf sb = {(unsigned short)idx, (short)op, 0};
+    // Synchronizujemy się semaforem – pilnujemy kolejności i wykluczeń między procesami
+    while (semop(semid, &sb, 1) == -1) {
+        if (errno != EINTR) return -1;
+    }
+    return 0;
+}
+
+/*
+ * sem_op_r() dla ról-procesów: zestaw semaforów skasowany (./clean) = koniec symulacji,
+ * więc proces po prostu się kończy; inny błąd kończy go z komunikatem.
+ */
+static inline void sem_op(int semid, int idx, int op) {
+    if (sem_op_r(semid, idx, op) == 0) return;
+    if (errno == EIDRM || errno == EINVAL) _exit(0);
+    // Kończymy z komunikatem o błędzie
+    die_errno("semop");
+}
+
+// ./setup: inicjalizacja mutexów w świeżo wyzerowanym SharedState (w backendzie sysv nic do zrobienia)
+static inline void synchro_init(SharedState *stan) {
+#ifdef SYNC_PTHREAD
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    for (int i = 0; i < LICZBA_MUTEXOW; i++) {
+        int e = pthread_mutex_init(&stan->mutexy[i].m, &attr);
+        if (e != 0) { errno = e; die_errno("pthread_mutex_init"); }
+    }
+    pthread_mutexattr_destroy(&attr);
+#else
+    (void)stan;
+#endif
+}
+
+/*
+ * Wejście do sekcji krytycznej chronionej mutexem idx (SEM_SPRZEDAZ, SEM_KASY, SEM_SLOTY, SEM_KOLEGI,
+ * SEM_SEKTOR_START + s). Najpierw próba bez czekania (IPC_NOWAIT / trylock): gdy się nie uda,
+ * liczymy czekanie w stan->blokady[idx] i dopiero wtedy blokujemy się na mutexie.
+ * Zwraca 0 albo -1 (errno jak w sem_op_r) – zablokuj() niżej kończy proces jak sem_op().
+ */
+static inline int zablokuj_r(SharedState *stan, int semid, int idx) {
+    __atomic_add_fetch(&stan->blokady[idx].wejscia, 1, __ATOMIC_RELAXED);
+#ifdef SYNC_PTHREAD
+    (void)semid;
+    int e = pthread_mutex_trylock(&stan->mutexy[idx].m);
+    if (e == EBUSY) {
+        __atomic_add_fetch(&stan->blokady[idx].czekania, 1, __ATOMIC_RELAXED);
+        e = pthread_mutex_lock(&stan->mutexy[idx].m);
+    }
+    if (e == EOWNERDEAD) {
+        // Poprzedni właściciel zginął w sekcji krytycznej – liczniki mogą być w połowie zmiany
+        fprintf(stderr, "[SYNCHRO] Przejmuję mutex %d po martwym procesie\n", idx);
+        e = pthread_mutex_consistent(&stan->mutexy[idx].m);
+    }
+    if (e != 0) {
+        errno = e;
+        return -1;
+    }
+    return 0;
+#else
+    struct sembuf sb = {(unsigned short)idx, -1, IPC_NOWAIT};
+    if (semop(semid, &sb, 1) == 0) return 0;
+    if (errno == EAGAIN) __atomic_add_fetch(&stan->blokady[idx].czekania, 1, __ATOMIC_RELAXED);
+    return sem_op_r(semid, idx, -1);
+#endif
+}
+
+static inline int odblokuj_r(SharedState *stan, int semid, int idx) {
+#ifdef SYNC_PTHREAD
+    (void)semid;
+    int e = pthread_mutex_unlock(&stan->mutexy[idx].m);
+    if (e != 0) {
+        errno = e;
+        return -1;
+    }
+    return 0;
+#else
+    (void)stan;
+    return sem_op_r(semid, idx, 1);
+#endif
+}
+
+// Role-procesy: błąd blokady kończy proces (skasowany zestaw semaforów – po cichu, jak sem_op)
+static inline void blokada_koniec(const char *ctx) {
+#ifndef SYNC_PTHREAD
+    if (errno == EIDRM || errno == EINVAL) _exit(0);
+#endif
+    die_errno(ctx);
+}
+
+static inline void zablokuj(SharedState *stan, int semid, int idx) {
+    if (zablokuj_r(stan, semid, idx) == -1) blokada_koniec("zablokuj");
+}
+
+static inline void odblokuj(SharedState *stan, int semid, int idx) {
+    if (odblokuj_r(stan, semid, idx) == -1) blokada_koniec("odblokuj");
+}
+
+#endif
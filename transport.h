@@ -0,0 +1,461 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "common.h"
+
+#include <fcntl.h>
+#include <mqueue.h>
+
+/*
+ * ===================================
+ * TRANSPORT KOMUNIKATÓW MIĘDZY ROLAMI
+ * ===================================
+ * Cztery operacje, z których korzystają kibic, kasjer, pośrednik, kierownik i pracownik:
+ *  - żądanie do kasy: transport_wyslij_zadanie() / transport_odbierz_zadanie() (najpierw VIP),
+ *  - bilet (odpowiedź kasy): transport_odpowiedz() / transport_odbierz_bilet(),
+ *  - sterowanie (adresat CEL_*): transport_steruj() / transport_odbierz_sterowanie().
+ *
+ * Backend wybiera ./main transport=shm|sysv|posix przy starcie (stan->transport, zanim wystartują role):
+ *  - shm (domyślny): żądania w pierścieniach ring.h, bilety w skrzynkach (futex), sterowanie
+ *    w kanałach SharedState.kanaly[] – bez wywołań systemowych, dopóki nikt nie śpi,
+ *  - sysv: msgsnd/msgrcv. Żądania w KEY_MSG_ZADANIA (mtype 1 = VIP, 2 = standard; msgrcv z typem -2
+ *    oddaje najpierw najniższy typ, czyli VIP), bilety w KEY_MSG_BILETY (mtype = id kibica + 1),
+ *    sterowanie w KEY_MSG (mtype 10 + sektor, 99, 5000),
+ *  - posix: mq_send/mq_receive. Żądania w jednej kolejce MQ_ZADANIA z priorytetem (VIP 1, standard 0 –
+ *    mq_receive oddaje najpierw najwyższy), sterowanie w kolejce na adresata (MQ_STEROWANIE_WZOR).
+ *    Bilety zostają w skrzynkach shm: mq nie wybiera komunikatu po adresacie (nie ma mtype),
+ *    a kolejka na każdego kibica przekroczyłaby queues_max.
+ *
+ * W każdym backendzie kasjer zdejmuje żądania bez blokowania i śpi na dzwonku kas (kasy_zadzwon /
+ * kasy_czekaj w common.h) – budzi go też zamknięcie kasy i koniec sprzedaży, czego nie da blokujący
+ * msgrcv/mq_receive. Długość kolejek w sysv/posix liczymy w stan->kolejka_msg (transport_dlugosc).
+ *
+ * Kolejki tworzy ./setup (transport_utworz_sysv/posix), usuwa ./clean (transport_usun).
+ */
+
+enum { TRANSPORT_SHM, TRANSPORT_SYSV, TRANSPORT_POSIX, TRANSPORT_N };
+
+static inline const char *transport_nazwa(int rodzaj) {
+    switch (rodzaj) {
+        case TRANSPORT_SYSV: return "sysv";
+        case TRANSPORT_POSIX: return "posix";
+        default: return "shm";
+    }
+}
+
+// Backend po nazwie albo -1
+static inline int transport_z_nazwy(const char *nazwa) {
+    for (int r = 0; r < TRANSPORT_N; r++) {
+        if (strcmp(nazwa, transport_nazwa(r)) == 0) return r;
+    }
+    return -1;
+}
+
+/* Kolejki POSIX (mq_overview(7)): żądania do kas i po jednej kolejce sterującej na adresata CEL_* */
+#define MQ_ZADANIA "/hala_zadania"
+#define MQ_STEROWANIE_WZOR "/hala_sterowanie_%d"
+
+/* Żądanie kibic -> kasjer (sysv: mtype = MSGTYPE_VIP / MSGTYPE_STANDARD; posix: ten sam układ, priorytet osobno) */
+typedef struct {
+    long mtype;
+    int kibic_id;
+    int grupa;
+    long long t_wstawienia_ns;
+} MsgKolejka;
+
+#define MSGTYPE_VIP 1
+#define MSGTYPE_STANDARD 2
+
+/* Bilet kasjer -> kibic w sysv: mtype = id kibica + 1 (mtype musi być > 0) */
+typedef struct {
+    long mtype;
+    int sektor;
+    long long t_wyslania_ns; // do LAT_ODPOWIEDZ
+} MsgBilet;
+
+#define MSGTYPE_RAPORT 99
+#define MSGTYPE_KIEROWNIK_CTRL 5000
+
+static inline long transport_mtype_celu(int cel) {
+    if (cel == CEL_RAPORT) return MSGTYPE_RAPORT;
+    if (cel == CEL_MASTER) return MSGTYPE_KIEROWNIK_CTRL;
+    return 10 + cel;
+}
+
+/* Uchwyt transportu jednego procesu (wątki kibiców w main i dzieci zygoty dzielą uchwyt rodzica) */
+typedef struct {
+    SharedState *stan;
+    int rodzaj;
+    int msg_sterowanie;                 // sysv
+    int msg_zadania;
+    int msg_bilety;
+    mqd_t mq_zadania;                   // posix, O_NONBLOCK
+    mqd_t mq_sterowanie[CELE_STEROWANIA]; // posix, otwierane przy pierwszym użyciu
+} Transport;
+
+/* =========================
+ * Tworzenie i usuwanie (./setup, ./clean)
+ * ========================= */
+
+// Kolejki sysv (sterowanie, żądania, bilety). wylacznie = IPC_EXCL (benchmark nie rusza działającej symulacji).
+static inline int transport_utworz_sysv(int wylacznie) {
+    const key_t klucze[] = {KEY_MSG, KEY_MSG_ZADANIA, KEY_MSG_BILETY};
+    for (int i = 0; i < 3; i++) {
+        /* msgget(): tworzy/pobiera kolejkę komunikatów*/
+        if (msgget(klucze[i], IPC_CREAT | (wylacznie ? IPC_EXCL : 0) | 0600) == -1) return -1;
+    }
+    return 0;
+}
+
+/*
+ * Jedna kolejka POSIX: próbujemy kolejno pojemności z proby[] (zakończonej 0). Powyżej
+ * /proc/sys/fs/mqueue/msg_max (domyślnie 10) wolno tylko z CAP_SYS_RESOURCE, a łączny rozmiar
+ * ogranicza RLIMIT_MSGQUEUE. Zwraca przyznaną pojemność albo -1.
+ */
+static inline long transport_mq_utworz(const char *nazwa, long rozmiar, const long *proby, int wylacznie) {
+    for (int i = 0; proby[i] > 0; i++) {
+        struct mq_attr a;
+        memset(&a, 0, sizeof(a));
+        a.mq_maxmsg = proby[i];
+        a.mq_msgsize = rozmiar;
+        /* mq_open(): tworzy kolejkę komunikatów POSIX*/
+        mqd_t mq = mq_open(nazwa, O_CREAT | O_RDWR | (wylacznie ? O_EXCL : 0), 0600, &a);
+        if (mq != (mqd_t)-1) {
+            // Kolejka już istniała (bez O_EXCL) – zostaje jej pojemność
+            if (mq_getattr(mq, &a) == -1) warn_errno("mq_getattr");
+            mq_close(mq);
+            return a.mq_maxmsg;
+        }
+        if (errno != EINVAL && errno != EMFILE && errno != ENOMEM) return -1;
+    }
+    return -1;
+}
+
+// Kolejki posix. Zwraca pojemność kolejki żądań albo -1 (backend posix niedostępny).
+static inline long transport_utworz_posix(int wylacznie) {
+    const long proby_zadan[] = {RING_POJEMNOSC, 4096, 1024, 256, 10, 0};
+    const long proby_sterowania[] = {KANAL_POJEMNOSC, 10, 0};
+    long pojemnosc = transport_mq_utworz(MQ_ZADANIA, sizeof(MsgKolejka), proby_zadan, wylacznie);
+    if (pojemnosc == -1) return -1;
+    for (int c = 0; c < CELE_STEROWANIA; c++) {
+        char nazwa[64];
+        snprintf(nazwa, sizeof(nazwa), MQ_STEROWANIE_WZOR, c);
+        if (transport_mq_utworz(nazwa, sizeof(MsgSterujacy), proby_sterowania, wylacznie) == -1) return -1;
+    }
+    return pojemnosc;
+}
+
+// Usuwa kolejki wszystkich backendów; brak kolejki to nie błąd
+static inline void transport_usun(void) {
+    const key_t klucze[] = {KEY_MSG, KEY_MSG_ZADANIA, KEY_MSG_BILETY};
+    for (int i = 0; i < 3; i++) {
+        /* msgget(): próba znalezienia istniejącej kolejki komunikatów*/
+        int msgid = msgget(klucze[i], 0600);
+        if (msgid != -1) {
+            /* msgctl(IPC_RMID): usuwa kolejkę komunikatów*/
+            if (msgctl(msgid, IPC_RMID, NULL) == -1) warn_errno("msgctl(IPC_RMID)");
+        } else if (errno != ENOENT) warn_errno("msgget");
+    }
+
+    /* mq_unlink(): usuwa nazwę kolejki POSIX (otwarte deskryptory działają do mq_close) */
+    if (mq_unlink(MQ_ZADANIA) == -1 && errno != ENOENT) warn_errno("mq_unlink(zadania)");
+    for (int c = 0; c < CELE_STEROWANIA; c++) {
+        char nazwa[64];
+        snprintf(nazwa, sizeof(nazwa), MQ_STEROWANIE_WZOR, c);
+        if (mq_unlink(nazwa) == -1 && errno != ENOENT) warn_errno("mq_unlink(sterowanie)");
+    }
+}
+
+/* =========================
+ * Podłączenie roli
+ * ========================= */
+
+// Po stan_podlacz: backend z stan->transport. Zwraca 0 albo -1 (errno z msgget/mq_open).
+static inline int transport_podlacz(Transport *t, SharedState *stan) {
+    memset(t, 0, sizeof(*t));
+    t->stan = stan;
+    t->rodzaj = stan->transport;
+    if (t->rodzaj < 0 || t->rodzaj >= TRANSPORT_N) t->rodzaj = TRANSPORT_SHM;
+    t->msg_sterowanie = t->msg_zadania = t->msg_bilety = -1;
+    t->mq_zadania = (mqd_t)-1;
+    for (int c = 0; c < CELE_STEROWANIA; c++) t->mq_sterowanie[c] = (mqd_t)-1;
+
+    if (t->rodzaj == TRANSPORT_SYSV) {
+        /* msgget(): pobiera kolejki backendu sysv*/
+        if ((t->msg_sterowanie = msgget(KEY_MSG, 0600)) == -1) return -1;
+        if ((t->msg_zadania = msgget(KEY_MSG_ZADANIA, 0600)) == -1) return -1;
+        if ((t->msg_bilety = msgget(KEY_MSG_BILETY, 0600)) == -1) return -1;
+    } else if (t->rodzaj == TRANSPORT_POSIX) {
+        /* mq_open(): kolejka żądań bez blokowania – pełna/pusta kolejka to EAGAIN, jak przy pierścieniu */
+        t->mq_zadania = mq_open(MQ_ZADANIA, O_RDWR | O_NONBLOCK);
+        if (t->mq_zadania == (mqd_t)-1) return -1;
+    }
+    return 0;
+}
+
+static inline void transport_odlacz(Transport *t) {
+    if (t->mq_zadania != (mqd_t)-1 && mq_close(t->mq_zadania) == -1) warn_errno("mq_close");
+    for (int c = 0; c < CELE_STEROWANIA; c++) {
+        if (t->mq_sterowanie[c] != (mqd_t)-1 && mq_close(t->mq_sterowanie[c]) == -1) warn_errno("mq_close");
+    }
+    t->mq_zadania = (mqd_t)-1;
+    for (int c = 0; c < CELE_STEROWANIA; c++) t->mq_sterowanie[c] = (mqd_t)-1;
+}
+
+/* =========================
+ * Żądania do kas
+ * ========================= */
+
+// Zwraca 1 po wysłaniu, 0 gdy kolejka jest pełna (wołający czeka chwilę i ponawia), -1 przy błędzie (errno)
+static inline int transport_wyslij_zadanie(Transport *t, int kibic_id, int grupa, int vip) {
+    if (t->rodzaj == TRANSPORT_SHM) {
+        return ring_wstaw(vip ? &t->stan->kolejka_vip : &t->stan->kolejka_zwykla, kibic_id, grupa);
+    }
+
+    MsgKolejka m = {vip ? MSGTYPE_VIP : MSGTYPE_STANDARD, kibic_id, grupa, czas_ns()};
+    while (1) {
+        int r;
+        if (t->rodzaj == TRANSPORT_SYSV) {
+            /* msgsnd(): żądanie do kolejki kas, bez czekania na miejsce */
+            r = msgsnd(t->msg_zadania, &m, sizeof(MsgKolejka) - sizeof(long), IPC_NOWAIT);
+        } else {
+            /* mq_send(): priorytet 1 = VIP – mq_receive zdejmie go przed standardem */
+            r = mq_send(t->mq_zadania, (const char *)&m, sizeof(m), vip ? 1 : 0);
+        }
+        if (r == 0) break;
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN) ? 0 : -1;
+    }
+    __atomic_add_fetch(&t->stan->kolejka_msg[vip ? 1 : 0], 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+static inline void transport_odpowiedz(Transport *t, int kibic_id, int sektor);
+
+/*
+ * Zdejmuje jedno żądanie bez czekania, najpierw VIP. tylko_vip (standard wyprzedany): w shm i sysv
+ * standard zostaje w kolejce (kasjer go zaraz anuluje); w posix jednej kolejki nie da się filtrować,
+ * więc zdjęty standard od razu dostaje bilet -1. Zwraca 1 albo 0 (pusto).
+ */
+static inline int transport_odbierz_zadanie(Transport *t, int tylko_vip, int *kibic_id, int *grupa, int *vip,
+                                            long long *t_wstawienia_ns) {
+    if (t->rodzaj == TRANSPORT_SHM) {
+        if (ring_zdejmij(&t->stan->kolejka_vip, kibic_id, grupa, t_wstawienia_ns)) {
+            *vip = 1;
+            return 1;
+        }
+        if (!tylko_vip && ring_zdejmij(&t->stan->kolejka_zwykla, kibic_id, grupa, t_wstawienia_ns)) {
+            *vip = 0;
+            return 1;
+        }
+        return 0;
+    }
+
+    while (1) {
+        MsgKolejka m;
+        ssize_t r;
+        if (t->rodzaj == TRANSPORT_SYSV) {
+            /* msgrcv(): typ -MSGTYPE_STANDARD = najniższy mtype <= 2, czyli VIP przed standardem */
+            r = msgrcv(t->msg_zadania, &m, sizeof(MsgKolejka) - sizeof(long),
+                       tylko_vip ? MSGTYPE_VIP : -MSGTYPE_STANDARD, IPC_NOWAIT);
+        } else {
+            /* mq_receive(): najpierw komunikat o najwyższym priorytecie (VIP) */
+            r = mq_receive(t->mq_zadania, (char *)&m, sizeof(m), NULL);
+        }
+        if (r == -1) {
+            if (errno == EINTR) continue;
+            // Pusto (ENOMSG / EAGAIN) albo kolejka skasowana (./clean) – nie ma czego obsłużyć
+            if (errno != ENOMSG && errno != EAGAIN && errno != EIDRM && errno != EINVAL) warn_errno("odbierz_zadanie");
+            return 0;
+        }
+        int jest_vip = (m.mtype == MSGTYPE_VIP);
+        __atomic_sub_fetch(&t->stan->kolejka_msg[jest_vip], 1, __ATOMIC_RELAXED);
+        if (tylko_vip && !jest_vip) {
+            transport_odpowiedz(t, m.kibic_id, -1);
+            continue;
+        }
+        *kibic_id = m.kibic_id;
+        *grupa = m.grupa;
+        *vip = jest_vip;
+        if (t_wstawienia_ns) *t_wstawienia_ns = m.t_wstawienia_ns;
+        return 1;
+    }
+}
+
+// Przybliżona liczba żądań w kolejce VIP albo standard (autoskalowanie kas, monitor) – bez blokady
+static inline int transport_dlugosc(SharedState *stan, int vip) {
+    if (stan->transport == TRANSPORT_SYSV || stan->transport == TRANSPORT_POSIX) {
+        int n = __atomic_load_n(&stan->kolejka_msg[vip ? 1 : 0], __ATOMIC_RELAXED);
+        return n > 0 ? n : 0; // kasjer mógł zdjąć żądanie, zanim kibic je doliczył
+    }
+    return ring_dlugosc(vip ? &stan->kolejka_vip : &stan->kolejka_zwykla);
+}
+
+/*
+ * Czyści kolejkę VIP albo standard: każde oczekujące żądanie dostaje bilet -1.
+ * posix: jedna kolejka na oba rodzaje – standard sam nie jest czyszczony (zdjęty po wyprzedaniu
+ * dostaje -1 w transport_odbierz_zadanie), a czyszczenie VIP opróżnia całą kolejkę.
+ */
+static inline void transport_anuluj(Transport *t, int vip) {
+    int kibic_id, grupa, jest_vip;
+    if (t->rodzaj == TRANSPORT_SHM) {
+        while (ring_zdejmij(vip ? &t->stan->kolejka_vip : &t->stan->kolejka_zwykla, &kibic_id, &grupa, NULL)) {
+            bilet_wyslij(t->stan, kibic_id, -1);
+        }
+    } else if (t->rodzaj == TRANSPORT_SYSV) {
+        MsgKolejka m;
+        while (1) {
+            /* msgrcv(): dokładnie ten typ (VIP albo standard), bez czekania */
+            if (msgrcv(t->msg_zadania, &m, sizeof(MsgKolejka) - sizeof(long), vip ? MSGTYPE_VIP : MSGTYPE_STANDARD,
+                       IPC_NOWAIT) == -1) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            __atomic_sub_fetch(&t->stan->kolejka_msg[vip ? 1 : 0], 1, __ATOMIC_RELAXED);
+            transport_odpowiedz(t, m.kibic_id, -1);
+        }
+    } else if (vip) {
+        while (transport_odbierz_zadanie(t, 0, &kibic_id, &grupa, &jest_vip, NULL)) transport_odpowiedz(t, kibic_id, -1);
+    }
+}
+
+/* =========================
+ * Bilety (odpowiedzi kas)
+ * ========================= */
+
+// Bilet (sektor albo -1 = odmowa) dla kibica: kasjer, pośrednik (kolega) i anulowanie kolejek
+static inline void transport_odpowiedz(Transport *t, int kibic_id, int sektor) {
+    if (t->rodzaj != TRANSPORT_SYSV) {
+        bilet_wyslij(t->stan, kibic_id, sektor);
+        return;
+    }
+    if (kibic_id < 0) return;
+    MsgBilet b = {(long)kibic_id + 1, sektor, czas_ns()};
+    /* msgsnd(): bilet do kolejki odpowiedzi; pełna kolejka = czekamy, aż kibice odbiorą swoje */
+    while (msgsnd(t->msg_bilety, &b, sizeof(MsgBilet) - sizeof(long), 0) == -1) {
+        if (errno == EINTR) continue;
+        if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgsnd(bilet)");
+        return;
+    }
+}
+
+/*
+ * Czeka na bilet. Zwraca sektor albo -1 (odmowa, ewakuacja).
+ * sysv: msgrcv czeka bez limitu czasu, więc przy ogłoszonej ewakuacji w ogóle nie zasypiamy.
+ * Żądanie wysłane przed ogłoszeniem kierownik zdejmie i anuluje (transport_anuluj), a zdjęte
+ * przez kasjera zawsze dostaje odpowiedź – nikt nie czeka na bilet, który nie przyjdzie.
+ */
+static inline int transport_odbierz_bilet(Transport *t, int kibic_id) {
+    if (t->rodzaj != TRANSPORT_SYSV) return bilet_odbierz(t->stan, kibic_id);
+    if (kibic_id < 0) return -1;
+
+    MsgBilet b;
+    while (1) {
+        if (__atomic_load_n(&t->stan->ewakuacja_trwa, __ATOMIC_SEQ_CST)) return -1;
+        /* msgrcv(): tylko nasz bilet (mtype = id + 1) */
+        if (msgrcv(t->msg_bilety, &b, sizeof(MsgBilet) - sizeof(long), (long)kibic_id + 1, 0) >= 0) break;
+        if (errno == EINTR) continue;
+        if (!(errno == EIDRM || errno == EINVAL)) warn_errno("msgrcv(bilet)");
+        return -1;
+    }
+    hist_dodaj(&t->stan->lat[LAT_ODPOWIEDZ], czas_ns() - b.t_wyslania_ns);
+    return b.sektor;
+}
+
+/* =========================
+ * Sterowanie (kierownik <-> pracownicy)
+ * ========================= */
+
+// posix: kolejka sterująca adresata, otwierana przy pierwszym użyciu (kibice jej nie potrzebują)
+static inline mqd_t transport_mq_sterowanie(Transport *t, int cel) {
+    if (t->mq_sterowanie[cel] == (mqd_t)-1) {
+        char nazwa[64];
+        snprintf(nazwa, sizeof(nazwa), MQ_STEROWANIE_WZOR, cel);
+        /* mq_open(): otwiera istniejącą kolejkę sterującą (blokujące wysyłanie i odbiór) */
+        t->mq_sterowanie[cel] = mq_open(nazwa, O_RDWR);
+    }
+    return t->mq_sterowanie[cel];
+}
+
+// Polecenie (typ_sygnalu, sektor) dla adresata CEL_*. Zwraca 0 albo -1 (errno; EIDRM/EINVAL = kolejka skasowana).
+static inline int transport_steruj(Transport *t, int cel, int typ_sygnalu, int sektor) {
+    MsgSterujacy m = {transport_mtype_celu(cel), typ_sygnalu, sektor};
+
+    if (t->rodzaj == TRANSPORT_SHM) {
+        KanalSterujacy *k = &t->stan->kanaly[cel];
+        // Pełny kanał (odbiorca nie nadąża): ponawiamy jak blokujący msgsnd
+        while (!kanal_wstaw(k, typ_sygnalu, sektor)) usleep(1000);
+        // seq_cst: albo widzimy, że odbiorca czeka, albo on zobaczy nowe zdarzenie
+        __atomic_add_fetch(&k->zdarzenie, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&k->czeka, __ATOMIC_SEQ_CST)) {
+            if (futex_obudz(&k->zdarzenie, 1) == -1) warn_errno("futex_obudz(kanal)");
+        }
+        return 0;
+    }
+
+    while (1) {
+        int r;
+        if (t->rodzaj == TRANSPORT_SYSV) {
+            /* msgsnd(): wysyła komunikat sterujący do kolejki*/
+            r = msgsnd(t->msg_sterowanie, &m, sizeof(int) * 2, 0);
+        } else {
+            mqd_t mq = transport_mq_sterowanie(t, cel);
+            if (mq == (mqd_t)-1) return -1;
+            /* mq_send(): wysyła komunikat sterujący do kolejki adresata */
+            r = mq_send(mq, (const char *)&m, sizeof(m), 0);
+        }
+        if (r == 0) return 0;
+        if (errno != EINTR) return -1;
+    }
+}
+
+/*
+ * Odbiera polecenie dla adresata CEL_*. czekaj = 0: bez czekania (master w pętli z select).
+ * Zwraca 1 (*m wypełnione), 0 (brak komunikatu, tylko przy czekaj = 0) albo -1 (errno).
+ */
+static inline int transport_odbierz_sterowanie(Transport *t, int cel, int czekaj, MsgSterujacy *m) {
+    m->mtype = transport_mtype_celu(cel);
+
+    if (t->rodzaj == TRANSPORT_SHM) {
+        KanalSterujacy *k = &t->stan->kanaly[cel];
+        if (kanal_zdejmij(k, &m->typ_sygnalu, &m->sektor_id)) return 1;
+        if (!czekaj) return 0;
+        __atomic_store_n(&k->czeka, 1, __ATOMIC_SEQ_CST);
+        while (1) {
+            unsigned int v = __atomic_load_n(&k->zdarzenie, __ATOMIC_SEQ_CST);
+            if (kanal_zdejmij(k, &m->typ_sygnalu, &m->sektor_id)) break;
+            // Limit 1 s tylko na wszelki wypadek – zwykle budzi nas transport_steruj()
+            if (futex_czekaj(&k->zdarzenie, v, 1000000000LL) == -1 &&
+                errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+                warn_errno("futex_czekaj(kanal)");
+            }
+        }
+        __atomic_store_n(&k->czeka, 0, __ATOMIC_SEQ_CST);
+        return 1;
+    }
+
+    while (1) {
+        ssize_t r;
+        if (t->rodzaj == TRANSPORT_SYSV) {
+            /* msgrcv(): tylko komunikaty dla tego adresata (mtype celu) */
+            r = msgrcv(t->msg_sterowanie, m, sizeof(int) * 2, m->mtype, czekaj ? 0 : IPC_NOWAIT);
+            if (r == -1 && errno == ENOMSG) return 0;
+        } else {
+            mqd_t mq = transport_mq_sterowanie(t, cel);
+            if (mq == (mqd_t)-1) return -1;
+            if (czekaj) {
+                /* mq_receive(): czeka na komunikat w kolejce adresata */
+                r = mq_receive(mq, (char *)m, sizeof(*m), NULL);
+            } else {
+                // Termin już minął: pusta kolejka od razu daje ETIMEDOUT
+                struct timespec teraz = {0, 0};
+                r = mq_timedreceive(mq, (char *)m, sizeof(*m), NULL, &teraz);
+                if (r == -1 && errno == ETIMEDOUT) return 0;
+            }
+        }
+        if (r >= 0) return 1;
+        if (errno != EINTR) return -1;
+    }
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "common.h"
+#include "pamiec.h"
+#include "transport.h"
+
+/*
+ * ======================================
+ * ZRZUT: końcowy stan przebiegu offline
+ * ======================================
+ * Czyta kopię SharedState, którą ./clean zostawia po przebiegu z ./setup pamiec=plik (PLIK_ZRZUTU),
+ * i wypisuje to, co monitor pokazywał na żywo, plus ślady do analizy po fakcie:
+ * kibice, którzy czekali na bilet do końca, niezdjęte żądania, liczniki kas i blokad, rozkłady LAT_*.
+ * Zrzut musi pochodzić z tej samej kompilacji (K i układ SharedState) – sprawdzamy rozmiar.
+ *
+ * Użycie: ./zrzut [plik]   (domyślnie PLIK_ZRZUTU)
+ */
+
+int main(int argc, char *argv[]) {
+    const char *sciezka = (argc > 1) ? argv[1] : PLIK_ZRZUTU;
+    if (argc > 2) {
+        fprintf(stderr, "Użycie: %s [plik zrzutu, domyślnie %s]\n", argv[0], PLIK_ZRZUTU);
+        exit(EXIT_FAILURE);
+    }
+
+    /* open(): zrzut tylko do odczytu */
+    int fd = open(sciezka, O_RDONLY);
+    if (fd == -1) {
+        warn_errno("open(zrzut)");
+        fprintf(stderr, "Brak zrzutu – przebieg z ./setup pamiec=plik zostawia go po ./clean\n");
+        exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    /* fstat(): rozmiar zrzutu = sizeof(SharedState) tej samej kompilacji */
+    if (fstat(fd, &st) == -1) die_errno("fstat(zrzut)");
+    if ((size_t)st.st_size != sizeof(SharedState)) {
+        fprintf(stderr, "[ZRZUT] %s ma %lld B, a SharedState tej kompilacji %zu B (inne K?)\n", sciezka,
+                (long long)st.st_size, sizeof(SharedState));
+        exit(EXIT_FAILURE);
+    }
+    /* mmap(MAP_PRIVATE): czytamy zrzut bez kopiowania, pliku nie zmieniamy */
+    const SharedState *stan = mmap(NULL, sizeof(SharedState), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (stan == MAP_FAILED) die_errno("mmap(zrzut)");
+    if (close(fd) == -1) warn_errno("close(zrzut)");
+    if (stan->rozmiar_stanu != sizeof(SharedState)) {
+        fprintf(stderr, "[ZRZUT] Nagłówek zrzutu nie pasuje (rozmiar_stanu=%u)\n", stan->rozmiar_stanu);
+        exit(EXIT_FAILURE);
+    }
+
+    char kiedy[64] = "?";
+    struct tm tm;
+    if (localtime_r(&st.st_mtime, &tm)) strftime(kiedy, sizeof(kiedy), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("[ZRZUT] %s (%s) | K=%d | nośnik: %s, %.1f MB, strony: %s | ziarno=%u | transport: %s | paczka: %d\n",
+           sciezka, kiedy, K, pamiec_nazwa(stan->pamiec), stan->rozmiar_mapy / 1048576.0,
+           strony_nazwa(stan->strony), stan->ziarno, transport_nazwa(stan->transport), stan->paczka_kasy);
+
+    static const char *const STATUSY[] = {"przed meczem", "mecz trwa", "po meczu"};
+    printf("[ZRZUT] Mecz: %s (zostało %d s) | ewakuacja: %s | sprzedaż: %s%s\n",
+           (stan->status_meczu >= 0 && stan->status_meczu <= 2) ? STATUSY[stan->status_meczu] : "?",
+           stan->czas_pozostaly, stan->ewakuacja_trwa ? "tak" : "nie",
+           stan->sprzedaz_zakonczona ? "zakończona" : "trwała", stan->standard_sold_out ? ", standard wyprzedany" : "");
+
+    int sprzedane = 0, obecni = 0;
+    printf("[ZRZUT] Sprzedane / obecni:");
+    for (int s = 0; s <= LICZBA_SEKTOROW; s++) {
+        sprzedane += stan->sprzedane_bilety[s];
+        obecni += stan->sektory[s].obecni;
+        if (s == SEKTOR_VIP) printf(" VIP");
+        else printf(" S%d", s);
+        printf(" %d/%d", stan->sprzedane_bilety[s], stan->sektory[s].obecni);
+    }
+    printf(" | razem %d/%d\n", sprzedane, obecni);
+
+    printf("[ZRZUT] Kibice: id do %d | weszło %d | opiekunów %d | kolegów %d | agresji %d | procesów (sloty) %d/%d\n",
+           stan->next_kibic_id, stan->cnt_weszlo, stan->cnt_opiekun, stan->cnt_kolega, stan->cnt_agresja,
+           stan->active_proc, MAX_PROC);
+
+    // Ślady niedokończonej obsługi: skrzynki z bilet_odbierz() bez odpowiedzi i żądania w kolejkach
+    int czekajacy = 0, bez_odbioru = 0;
+    for (int i = 0; i < SKRZYNKI; i++) {
+        if (stan->skrzynki[i].stan == SKRZYNKA_CZEKA) czekajacy++;
+    }
+    for (int s = 0; s < LICZBA_SEKTOROW; s++) {
+        const StanSektora *sek = &stan->sektory[s];
+        for (int d = 0; d < 2; d++) bez_odbioru += (int)(sek->kolejka_nastepny[d] - sek->kolejka_czolo[d]);
+    }
+    printf("[ZRZUT] Na koniec: czekało na bilet %d | w kolejkach kas (shm) VIP %d, zwykła %d | "
+           "sysv/posix %d/%d | pod bramkami %d | kolegów do utworzenia %u\n",
+           czekajacy, ring_dlugosc(&stan->kolejka_vip), ring_dlugosc(&stan->kolejka_zwykla), stan->kolejka_msg[1],
+           stan->kolejka_msg[0], bez_odbioru, stan->kolegi_ogon - stan->kolegi_glowa);
+
+    printf("[ZRZUT] Kasy: aktywne");
+    for (int i = 0; i < LICZBA_KAS; i++) printf(" %c", stan->aktywne_kasy[i] ? '1' : '.');
+    printf(" | otwarcia %d, zamknięcia %d | paczki %d, żądania %d, bilety %d | uśpienia %d (pobudki %d)\n",
+           stan->kasy_otwarcia, stan->kasy_zamkniecia, stan->kasjerzy_paczki, stan->kasjerzy_zadania,
+           stan->kasjerzy_bilety, stan->kasjerzy_uspienia, stan->kasjerzy_pobudki);
+
+    printf("[ZRZUT] Blokady (czekania/wejścia):");
+    for (int i = 0; i < LICZBA_MUTEXOW; i++) {
+        printf(" %d:%llu/%llu", i, stan->blokady[i].czekania, stan->blokady[i].wejscia);
+    }
+    printf("\n");
+
+    for (int i = 0; i < LAT_N; i++) hist_wypisz(stdout, NAZWY_LAT[i], &stan->lat[i]);
+
+    if (munmap((void *)stan, sizeof(SharedState)) == -1) warn_errno("munmap");
+    return 0;
+}